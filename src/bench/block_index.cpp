@@ -0,0 +1,136 @@
+// Copyright (c) 2024 The NeuralLead developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <blockmap.h>
+#include <chain.h>
+#include <random.h>
+#include <uint256.h>
+
+#include <algorithm>
+#include <assert.h>
+#include <vector>
+
+// A chain of a million blocks with a stale branch of one to eight blocks
+// every hundred blocks, as the entries come out of the block tree DB
+static constexpr int SYNTHETIC_HEIGHT = 1000000;
+static constexpr int SYNTHETIC_FORK_SPACING = 100;
+
+struct SyntheticEntry {
+    uint256 hash;
+    uint256 hashPrev;
+    int nHeight;
+};
+
+static const std::vector<SyntheticEntry>& SyntheticEntries()
+{
+    static const std::vector<SyntheticEntry> entries = [] {
+        FastRandomContext rng(true);
+        std::vector<SyntheticEntry> entries;
+        uint256 hashPrev;
+        for (int height = 0; height < SYNTHETIC_HEIGHT; ++height) {
+            entries.push_back({rng.rand256(), hashPrev, height});
+            hashPrev = entries.back().hash;
+            if (height % SYNTHETIC_FORK_SPACING == 0) {
+                uint256 hashFork = hashPrev;
+                const int length = 1 + rng.randrange(8);
+                for (int fork = 1; fork <= length; ++fork) {
+                    entries.push_back({rng.rand256(), hashFork, height + fork});
+                    hashFork = entries.back().hash;
+                }
+            }
+        }
+        // The DB is ordered by block hash
+        std::sort(entries.begin(), entries.end(), [](const SyntheticEntry& a, const SyntheticEntry& b) { return a.hash < b.hash; });
+        return entries;
+    }();
+    return entries;
+}
+
+// What BlockManager::LoadBlockIndex does with the entries, minus the chain work
+static void LoadSynthetic(BlockMap& block_index)
+{
+    const std::vector<SyntheticEntry>& entries = SyntheticEntries();
+    std::vector<const SyntheticEntry*> sorted;
+    sorted.reserve(entries.size());
+    for (const SyntheticEntry& entry : entries) {
+        sorted.push_back(&entry);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const SyntheticEntry* a, const SyntheticEntry* b) { return a->nHeight < b->nHeight; });
+
+    block_index.reserve(sorted.size());
+    std::vector<CBlockIndex*> nodes;
+    nodes.reserve(sorted.size());
+    for (const SyntheticEntry* entry : sorted) {
+        CBlockIndex* pindex = block_index.emplace(entry->hash).first->second;
+        pindex->nHeight = entry->nHeight;
+        nodes.push_back(pindex);
+    }
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        if (sorted[i]->hashPrev.IsNull()) continue;
+        nodes[i]->pprev = block_index.find(sorted[i]->hashPrev)->second;
+        nodes[i]->BuildSkip();
+    }
+}
+
+static void BlockIndexLoad1M(benchmark::Bench& bench)
+{
+    const size_t count = SyntheticEntries().size();
+    bench.batch(count).unit("entry").run([&] {
+        BlockMap block_index;
+        LoadSynthetic(block_index);
+        assert(block_index.size() == count);
+    });
+}
+
+// The entries that are the tip of the chain or of a stale branch
+static std::vector<const CBlockIndex*> Tips(const BlockMap& block_index)
+{
+    std::vector<const CBlockIndex*> nodes;
+    for (const auto& entry : block_index) {
+        nodes.push_back(entry.second);
+    }
+    std::vector<const CBlockIndex*> parents;
+    for (const CBlockIndex* pindex : nodes) {
+        if (pindex->pprev) parents.push_back(pindex->pprev);
+    }
+    std::sort(parents.begin(), parents.end());
+    std::vector<const CBlockIndex*> tips;
+    for (const CBlockIndex* pindex : nodes) {
+        if (!std::binary_search(parents.begin(), parents.end(), pindex)) tips.push_back(pindex);
+    }
+    return tips;
+}
+
+static void BlockIndexGetAncestor1M(benchmark::Bench& bench)
+{
+    BlockMap block_index;
+    LoadSynthetic(block_index);
+    const std::vector<const CBlockIndex*> tips = Tips(block_index);
+    FastRandomContext rng(true);
+
+    bench.run([&] {
+        const CBlockIndex* tip = tips[rng.randrange(tips.size())];
+        const int height = rng.randrange(tip->nHeight + 1);
+        const CBlockIndex* pindex = tip->GetAncestor(height);
+        assert(pindex->nHeight == height);
+    });
+}
+
+static void BlockIndexLastCommonAncestor1M(benchmark::Bench& bench)
+{
+    BlockMap block_index;
+    LoadSynthetic(block_index);
+    const std::vector<const CBlockIndex*> tips = Tips(block_index);
+    FastRandomContext rng(true);
+
+    bench.run([&] {
+        const CBlockIndex* fork = LastCommonAncestor(tips[rng.randrange(tips.size())], tips[rng.randrange(tips.size())]);
+        assert(fork != nullptr);
+    });
+}
+
+BENCHMARK(BlockIndexLoad1M);
+BENCHMARK(BlockIndexGetAncestor1M);
+BENCHMARK(BlockIndexLastCommonAncestor1M);
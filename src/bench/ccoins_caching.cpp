@@ -4,7 +4,9 @@
 
 #include <bench/bench.h>
 #include <coins.h>
+#include <crypto/common.h>
 #include <policy/policy.h>
+#include <random.h>
 #include <script/signingprovider.h>
 #include <test/util/transaction_utils.h>
 
@@ -51,4 +53,67 @@ static void CCoinsCaching(benchmark::Bench& bench)
     ECC_Stop();
 }
 
+// Ten million coins, one in four with a pay to pubkey script as staked
+// outputs have, which does not fit the inline storage of CScript
+static constexpr uint64_t SYNTHETIC_COINS = 10000000;
+
+static COutPoint SyntheticOutPoint(uint64_t i)
+{
+    uint256 hash;
+    WriteLE64(hash.begin(), i * 0x9e3779b97f4a7c15);
+    return COutPoint(hash, i % 4);
+}
+
+static void AddSyntheticCoins(CCoinsViewCache& coins)
+{
+    for (uint64_t i = 0; i < SYNTHETIC_COINS; ++i) {
+        Coin coin;
+        coin.out.nValue = 1 + i % COIN;
+        coin.out.scriptPubKey.assign((uint32_t)(i % 4 == 0 ? 35 : 25), 1);
+        coin.nHeight = 1 + i / 1000;
+        coins.AddCoin(SyntheticOutPoint(i), std::move(coin), false);
+    }
+}
+
+static void CCoinsCachingAdd10M(benchmark::Bench& bench)
+{
+    CCoinsView coinsDummy;
+    bench.epochs(1).epochIterations(1).batch(SYNTHETIC_COINS).unit("coin").run([&] {
+        CCoinsViewCache coins(&coinsDummy);
+        AddSyntheticCoins(coins);
+        assert(coins.GetCacheSize() == SYNTHETIC_COINS);
+    });
+}
+
+static void CCoinsCachingAccess10M(benchmark::Bench& bench)
+{
+    CCoinsView coinsDummy;
+    CCoinsViewCache coins(&coinsDummy);
+    AddSyntheticCoins(coins);
+    FastRandomContext rng(true);
+
+    bench.run([&] {
+        const Coin& coin = coins.AccessCoin(SyntheticOutPoint(rng.randrange(SYNTHETIC_COINS)));
+        assert(!coin.IsSpent());
+    });
+}
+
+static void CCoinsCachingFlush10M(benchmark::Bench& bench)
+{
+    CCoinsView coinsDummy;
+    CCoinsViewCache base(&coinsDummy);
+    CCoinsViewCache coins(&base);
+    AddSyntheticCoins(coins);
+    coins.SetBestBlock(uint256::ONE);
+
+    bench.epochs(1).epochIterations(1).batch(SYNTHETIC_COINS).unit("coin").run([&] {
+        bool success = coins.Flush();
+        assert(success);
+    });
+    assert(base.GetCacheSize() == SYNTHETIC_COINS);
+}
+
 BENCHMARK(CCoinsCaching);
+BENCHMARK(CCoinsCachingAdd10M);
+BENCHMARK(CCoinsCachingAccess10M);
+BENCHMARK(CCoinsCachingFlush10M);
@@ -0,0 +1,101 @@
+// Copyright (c) 2024 The NeuralLead developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <crypto/cryptoconf.h>
+#include <crypto/neuralleadnet.h>
+#include <crypto/neuralleadqhash_interface.h>
+#include <neuralleadnetio.h>
+
+#include <assert.h>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+// Count the operator new calls of a thread while an AllocationCounter is alive
+// on it, so that the QHash benchmarks below can check that hashing itself
+// never touches the heap. Other benchmarks only pay for the thread local load.
+static thread_local uint64_t* g_heap_allocations = nullptr;
+
+class AllocationCounter
+{
+public:
+    AllocationCounter() { g_heap_allocations = &m_count; }
+    ~AllocationCounter() { g_heap_allocations = nullptr; }
+    uint64_t Count() const { return m_count; }
+
+private:
+    uint64_t m_count = 0;
+};
+
+void* operator new(size_t size)
+{
+    if (g_heap_allocations) ++*g_heap_allocations;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+/** Run hash() under the bench, with the native neural network so that no
+ * external code is involved, and check it made no heap allocation. The
+ * bench fails if the native backend cannot be installed, as allocations
+ * inside the NeuralLeadQHash library are out of our hands. The backend
+ * selected at startup is restored afterwards. */
+template <typename F>
+static void CheckAllocationFree(benchmark::Bench& bench, size_t bytes, F hash)
+{
+    std::string error;
+    std::vector<NeuralLeadNet::LayerSpec> layers;
+    const NeuralNetBackend previous = GetNeuralNetBackend();
+    const bool native = ReadNeuralLeadNetLayers(NEURALLEADNET_DIR, layers, error) && SetNeuralNetBackend(NeuralNetBackend::NATIVE, layers, error);
+    assert(native);
+
+    uint64_t allocations = 0;
+    bench.batch(bytes).unit("byte").run([&] {
+        AllocationCounter counter;
+        hash();
+        allocations += counter.Count();
+    });
+
+    SetNeuralNetBackend(previous, layers, error);
+    assert(allocations == 0);
+}
+
+static void NeuralLeadQHashAllocs_64b(benchmark::Bench& bench)
+{
+    std::vector<uint8_t> in(64, 0x5a);
+    uint8_t hash[32];
+    CheckAllocationFree(bench, in.size(), [&] {
+        uint8_t* out = hash;
+        DirectComputeHash(in.data(), in.size(), out);
+        in[0] = hash[0];
+    });
+}
+
+static void NeuralLeadQHashAllocs_80b(benchmark::Bench& bench)
+{
+    std::vector<uint8_t> in(80, 0x5a);
+    uint8_t hash[NeuralLeadQHash_iface::OUTPUT_SIZE];
+    CheckAllocationFree(bench, in.size(), [&] {
+        NeuralLeadQHash_iface().Write(in.data(), in.size()).Finalize(hash);
+        in[0] = hash[0];
+    });
+}
+
+static void NeuralLeadQHashAllocs_1000b(benchmark::Bench& bench)
+{
+    std::vector<uint8_t> in(1000, 0x5a);
+    uint8_t hash[32];
+    CheckAllocationFree(bench, in.size(), [&] {
+        uint8_t* out = hash;
+        DirectComputeHash(in.data(), in.size(), out);
+        in[0] = hash[0];
+    });
+}
+
+BENCHMARK(NeuralLeadQHashAllocs_64b);
+BENCHMARK(NeuralLeadQHashAllocs_80b);
+BENCHMARK(NeuralLeadQHashAllocs_1000b);
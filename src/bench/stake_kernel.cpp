@@ -0,0 +1,105 @@
+// Copyright (c) 2024 The NeuralLead developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <chain.h>
+#include <coins.h>
+#include <kernelsearch.h>
+#include <pos.h>
+#include <random.h>
+
+#include <assert.h>
+#include <vector>
+
+// One staking round: every coin against every lookahead slot on one tip. The
+// target is unreachable so that no kernel is found and every pair is hashed.
+static constexpr size_t STAKE_COINS = 1000;
+static constexpr uint32_t STAKE_SLOTS = 3;
+static constexpr unsigned int STAKE_BITS = 0x03000001;
+
+static std::vector<StakeCandidate> MakeCandidates(FastRandomContext& rng)
+{
+    std::vector<StakeCandidate> candidates;
+    for (size_t i = 0; i < STAKE_COINS; ++i) {
+        candidates.push_back({COutPoint(rng.rand256(), i % 4), 1000, 50 * COIN});
+    }
+    return candidates;
+}
+
+// The CheckKernel() path with a filled stake cache, as CreateCoinStake uses it
+static void StakeKernelCheckKernel(benchmark::Bench& bench)
+{
+    FastRandomContext rng(true);
+    CBlockIndex index;
+    index.nHeight = 100;
+    index.nStakeModifier = rng.rand256();
+    CCoinsView viewDummy;
+    CCoinsViewCache view(&viewDummy);
+
+    StakeCacheMap cache;
+    for (const StakeCandidate& candidate : MakeCandidates(rng)) {
+        cache.emplace(candidate.prevout, CStakeCache(candidate.blockFromTime, candidate.amount));
+    }
+
+    bench.batch(STAKE_COINS * STAKE_SLOTS).unit("kernel").run([&] {
+        for (uint32_t slot = 0; slot < STAKE_SLOTS; ++slot) {
+            for (const auto& entry : cache) {
+                bool fKernel = CheckKernel(&index, STAKE_BITS, 100000 + 16 * slot, entry.first, view, cache);
+                assert(!fKernel);
+            }
+        }
+    });
+}
+
+// The same round from per-coin midstates, including computing them once per tip
+static void StakeKernelMidstate(benchmark::Bench& bench)
+{
+    FastRandomContext rng(true);
+    CBlockIndex index;
+    index.nHeight = 100;
+    std::vector<StakeCandidate> candidates = MakeCandidates(rng);
+
+    bench.batch(STAKE_COINS * STAKE_SLOTS).unit("kernel").run([&] {
+        index.nStakeModifier = rng.rand256();
+        for (StakeCandidate& candidate : candidates) {
+            candidate.midstate = GetStakeKernelMidstate(index.nStakeModifier, candidate.blockFromTime, candidate.prevout);
+        }
+        for (uint32_t slot = 0; slot < STAKE_SLOTS; ++slot) {
+            for (const StakeCandidate& candidate : candidates) {
+                uint256 hashProofOfStake, targetProofOfStake;
+                bool fKernel = CheckStakeKernelHash(candidate.midstate, STAKE_BITS, candidate.blockFromTime, index.nHeight + 1, candidate.amount,
+                                                    candidate.prevout, 100000 + 16 * slot, hashProofOfStake, targetProofOfStake);
+                assert(!fKernel);
+            }
+        }
+    });
+}
+
+// Later rounds on the same tip, when the midstates are already there
+static void StakeKernelMidstateCached(benchmark::Bench& bench)
+{
+    FastRandomContext rng(true);
+    CBlockIndex index;
+    index.nHeight = 100;
+    index.nStakeModifier = rng.rand256();
+    std::vector<StakeCandidate> candidates = MakeCandidates(rng);
+    for (StakeCandidate& candidate : candidates) {
+        candidate.midstate = GetStakeKernelMidstate(index.nStakeModifier, candidate.blockFromTime, candidate.prevout);
+    }
+
+    bench.batch(STAKE_COINS * STAKE_SLOTS).unit("kernel").run([&] {
+        for (uint32_t slot = 0; slot < STAKE_SLOTS; ++slot) {
+            for (const StakeCandidate& candidate : candidates) {
+                uint256 hashProofOfStake, targetProofOfStake;
+                bool fKernel = CheckStakeKernelHash(candidate.midstate, STAKE_BITS, candidate.blockFromTime, index.nHeight + 1, candidate.amount,
+                                                    candidate.prevout, 100000 + 16 * slot, hashProofOfStake, targetProofOfStake);
+                assert(!fKernel);
+            }
+        }
+    });
+}
+
+BENCHMARK(StakeKernelCheckKernel);
+BENCHMARK(StakeKernelMidstate);
+BENCHMARK(StakeKernelMidstateCached);
@@ -0,0 +1,224 @@
+// Copyright (c) 2024 The NeuralLead developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <chain.h>
+#include <consensus/consensus.h>
+#include <consensus/validation.h>
+#include <interfaces/chain.h>
+#include <key.h>
+#include <miner.h>
+#include <node/context.h>
+#include <pos.h>
+#include <script/sign.h>
+#include <script/signingprovider.h>
+#include <script/standard.h>
+#include <test/util/setup_common.h>
+#include <txdb.h>
+#include <validation.h>
+#include <wallet/wallet.h>
+
+#include <assert.h>
+#include <set>
+#include <vector>
+
+// A regtest chain of block indexes past EnableStackingAtBlock, each block
+// staked by one key, and a wallet holding that key with mature coins spread
+// over the chain. Only the block indexes, the stake index and the UTXO set
+// are filled, which is all the staking code reads.
+static constexpr int STAKING_CHAIN_HEIGHT = 2100;
+// No kernel is ever found with this target
+static constexpr unsigned int STAKE_BITS_HARD = 0x03000001;
+// About one kernel in a hundred pairs for a 100 coins stake
+static constexpr unsigned int STAKE_BITS_EASY = 0x1c010000;
+static constexpr CAmount STAKE_COIN_VALUE = 100 * COIN;
+
+class StakingSetup
+{
+public:
+    explicit StakingSetup(size_t nCoins) : m_chain(interfaces::MakeChain(m_node)), m_wallet(m_chain.get(), "", CreateDummyWalletDatabase())
+    {
+        m_key.MakeNewKey(true);
+        m_script = GetScriptForDestination(PKHash(m_key.GetPubKey()));
+
+        LOCK(cs_main);
+        BlockMap& block_index = m_test_setup.m_node.chainman->BlockIndex();
+        CBlockIndex* pindex = ::ChainActive().Tip();
+        while (pindex->nHeight < STAKING_CHAIN_HEIGHT) {
+            auto inserted = block_index.emplace(GetRandHash());
+            assert(inserted.second);
+            CBlockIndex* pindexNew = inserted.first->second;
+            pindexNew->pprev = pindex;
+            pindexNew->nHeight = pindex->nHeight + 1;
+            pindexNew->nTime = pindex->nTime + 2 * (STAKE_TIMESTAMP_MASK + 1);
+            pindexNew->nStakeModifier = GetRandHash();
+            pindexNew->prevoutStake = COutPoint(GetRandHash(), 1);
+            pindexNew->BuildSkip();
+            assert(pblocktree->WriteStakeIndex(pindexNew->nHeight, m_key.GetPubKey().GetID()));
+            pindex = pindexNew;
+        }
+        ::ChainActive().SetTip(pindex);
+
+        m_wallet.SetupLegacyScriptPubKeyMan();
+        LOCK(m_wallet.cs_wallet);
+        assert(m_wallet.GetLegacyScriptPubKeyMan()->AddKeyPubKey(m_key, m_key.GetPubKey()));
+        m_wallet.SetLastBlockProcessed(pindex->nHeight, pindex->GetBlockHash());
+
+        // Each coin in its own transaction, confirmed at a height it is mature at
+        CCoinsViewCache& view = ::ChainstateActive().CoinsTip();
+        const int nMatureHeight = STAKING_CHAIN_HEIGHT - COINBASE_MATURITY;
+        for (size_t i = 0; i < nCoins; ++i) {
+            const CBlockIndex* pindexFrom = ::ChainActive()[1 + i % nMatureHeight];
+            CMutableTransaction mtx;
+            mtx.vin.emplace_back(COutPoint(GetRandHash(), 0));
+            mtx.vout.emplace_back(STAKE_COIN_VALUE, m_script);
+            const CTransactionRef tx = MakeTransactionRef(std::move(mtx));
+            m_wallet.AddToWallet(tx, {CWalletTx::Status::CONFIRMED, pindexFrom->nHeight, pindexFrom->GetBlockHash(), 0});
+            view.AddCoin(COutPoint(tx->GetHash(), 0), Coin(tx->vout[0], pindexFrom->nHeight, false, false), false);
+            m_coins.emplace_back(tx->GetHash(), 0);
+        }
+    }
+
+    CWallet& Wallet() { return m_wallet; }
+    const CKey& Key() const { return m_key; }
+    const std::vector<COutPoint>& Coins() const { return m_coins; }
+
+private:
+    TestingSetup m_test_setup{CBaseChainParams::REGTEST, {"-nodebuglogfile", "-nodebug"}};
+    NodeContext m_node;
+    std::unique_ptr<interfaces::Chain> m_chain;
+    CWallet m_wallet;
+    CKey m_key;
+    CScript m_script;
+    std::vector<COutPoint> m_coins;
+};
+
+// A coinstake spending coin with a kernel at or after the tip time, and its block time
+static std::pair<CMutableTransaction, uint32_t> MakeCoinStake(const StakingSetup& setup, const COutPoint& coin) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    CBlockIndex* pindexPrev = ::ChainActive().Tip();
+    const Coin& coinPrev = ::ChainstateActive().CoinsTip().AccessCoin(coin);
+    const CBlockIndex* pindexFrom = pindexPrev->GetAncestor(coinPrev.nHeight);
+
+    uint32_t nTimeBlock = (pindexPrev->nTime + STAKE_TIMESTAMP_MASK + 1) & ~STAKE_TIMESTAMP_MASK;
+    uint256 hashProofOfStake, targetProofOfStake;
+    while (!CheckStakeKernelHash(pindexPrev, STAKE_BITS_EASY, pindexFrom->nTime, pindexPrev->nHeight + 1, coinPrev.out.nValue, coin, nTimeBlock,
+                                 hashProofOfStake, targetProofOfStake)) {
+        nTimeBlock += STAKE_TIMESTAMP_MASK + 1;
+    }
+
+    CMutableTransaction tx;
+    tx.vin.emplace_back(coin);
+    tx.vout.emplace_back(0, CScript());
+    tx.vout.emplace_back(coinPrev.out.nValue, GetScriptForRawPubKey(setup.Key().GetPubKey()));
+    FillableSigningProvider keystore;
+    keystore.AddKey(setup.Key());
+    assert(SignSignature(keystore, coinPrev.out.scriptPubKey, tx, 0, coinPrev.out.nValue, SIGHASH_ALL));
+    return {tx, nTimeBlock};
+}
+
+static void AvailableCoinsForStaking(benchmark::Bench& bench, size_t nCoins)
+{
+    StakingSetup setup(nCoins);
+    CWallet& wallet = setup.Wallet();
+    LOCK(wallet.cs_wallet);
+
+    std::vector<COutput> vCoins;
+    bench.run([&] {
+        wallet.AvailableCoinsForStaking(vCoins);
+        assert(vCoins.size() == nCoins);
+    });
+}
+
+// A staker round that finds no kernel: every coin against every slot of the lookahead window
+static void CreateCoinStake(benchmark::Bench& bench, size_t nCoins)
+{
+    StakingSetup setup(nCoins);
+    CWallet& wallet = setup.Wallet();
+    std::set<std::pair<const CWalletTx*, unsigned int>> setCoins;
+    std::vector<StakeCandidate> candidates;
+    {
+        LOCK(wallet.cs_wallet);
+        wallet.SelectCoinsForStaking(setCoins);
+    }
+    wallet.GetStakeCandidates(setCoins, WITH_LOCK(cs_main, return ::ChainActive().Tip()), candidates);
+    LOCK2(cs_main, wallet.cs_wallet);
+    assert(candidates.size() == nCoins);
+
+    const uint32_t nTimeBegin = (::ChainActive().Tip()->nTime + STAKE_TIMESTAMP_MASK + 1) & ~STAKE_TIMESTAMP_MASK;
+    bench.batch(nCoins * (MAX_STAKE_LOOKAHEAD / (STAKE_TIMESTAMP_MASK + 1))).unit("kernel").run([&] {
+        for (uint32_t nTimeBlock = nTimeBegin; nTimeBlock < nTimeBegin + MAX_STAKE_LOOKAHEAD; nTimeBlock += STAKE_TIMESTAMP_MASK + 1) {
+            CMutableTransaction tx;
+            CKey key;
+            bool fStake = wallet.CreateCoinStake(wallet, STAKE_BITS_HARD, 0, nTimeBlock, tx, key, setCoins);
+            assert(!fStake);
+        }
+    });
+}
+
+static void StakingCheckProofOfStake(benchmark::Bench& bench)
+{
+    StakingSetup setup(1);
+    LOCK(cs_main);
+    const auto coinstake = MakeCoinStake(setup, setup.Coins()[0]);
+    const CTransaction tx(coinstake.first);
+
+    bench.run([&] {
+        BlockValidationState state;
+        uint256 hashProofOfStake, targetProofOfStake;
+        bool fValid = CheckProofOfStake(::ChainActive().Tip(), state, tx, STAKE_BITS_EASY, coinstake.second, hashProofOfStake, targetProofOfStake,
+                                        ::ChainstateActive().CoinsTip());
+        assert(fValid);
+    });
+}
+
+// The P2PKH stake paid back to P2PK, the path that decodes both scripts
+static void StakingCheckBlockInputPubKey(benchmark::Bench& bench)
+{
+    StakingSetup setup(1);
+    LOCK(cs_main);
+    CBlock block;
+    block.vtx.push_back(MakeTransactionRef(CMutableTransaction()));
+    block.vtx.push_back(MakeTransactionRef(MakeCoinStake(setup, setup.Coins()[0]).first));
+    block.prevoutStake = setup.Coins()[0];
+
+    bench.run([&] {
+        bool fMatch = CheckBlockInputPubKeyMatchesOutputPubKey(block, ::ChainstateActive().CoinsTip());
+        assert(fMatch);
+    });
+}
+
+// The recipients of successive blocks, as the staker moves from tip to tip
+static void StakingGetMPoSOutputScripts(benchmark::Bench& bench)
+{
+    StakingSetup setup(1);
+    LOCK(cs_main);
+    const Consensus::Params& consensusParams = Params().GetConsensus();
+    const int nFirst = COINBASE_MATURITY + consensusParams.nMPoSRewardRecipients;
+    int nHeight = nFirst;
+
+    bench.run([&] {
+        std::vector<CScript> mposScriptList;
+        bool fScripts = GetMPoSOutputScripts(mposScriptList, nHeight, consensusParams);
+        assert(fScripts && mposScriptList.size() == size_t(consensusParams.nMPoSRewardRecipients - 1));
+        if (++nHeight > STAKING_CHAIN_HEIGHT) nHeight = nFirst;
+    });
+}
+
+static void AvailableCoinsForStaking1k(benchmark::Bench& bench) { AvailableCoinsForStaking(bench, 1000); }
+static void AvailableCoinsForStaking10k(benchmark::Bench& bench) { AvailableCoinsForStaking(bench, 10000); }
+static void AvailableCoinsForStaking100k(benchmark::Bench& bench) { AvailableCoinsForStaking(bench, 100000); }
+static void CreateCoinStake1k(benchmark::Bench& bench) { CreateCoinStake(bench, 1000); }
+static void CreateCoinStake10k(benchmark::Bench& bench) { CreateCoinStake(bench, 10000); }
+static void CreateCoinStake100k(benchmark::Bench& bench) { CreateCoinStake(bench, 100000); }
+
+BENCHMARK(AvailableCoinsForStaking1k);
+BENCHMARK(AvailableCoinsForStaking10k);
+BENCHMARK(AvailableCoinsForStaking100k);
+BENCHMARK(CreateCoinStake1k);
+BENCHMARK(CreateCoinStake10k);
+BENCHMARK(CreateCoinStake100k);
+BENCHMARK(StakingCheckProofOfStake);
+BENCHMARK(StakingCheckBlockInputPubKey);
+BENCHMARK(StakingGetMPoSOutputScripts);
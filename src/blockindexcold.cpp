@@ -0,0 +1,191 @@
+// Copyright (c) 2024 The NeuralLead developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <blockindexcold.h>
+
+#include <memusage.h>
+#include <txdb.h>
+
+CBlockIndexColdStore g_block_index_cold;
+
+static size_t ColdUsage(const CBlockIndexCold& cold)
+{
+    return memusage::DynamicUsage(cold.vchBlockSig);
+}
+
+void CBlockIndexColdStore::Set(const uint256& hash, CBlockIndexCold cold)
+{
+    LOCK(m_mutex);
+    EraseCached(hash);
+    m_pinned[hash] = std::move(cold);
+}
+
+bool CBlockIndexColdStore::SetHashProof(const uint256& hash, const uint256& hashProof)
+{
+    CBlockIndexCold cold = Get(hash);
+    if (cold.hashProof == hashProof) return false;
+    cold.hashProof = hashProof;
+    Set(hash, std::move(cold));
+    return true;
+}
+
+CBlockIndexCold CBlockIndexColdStore::Get(const uint256& hash, int height, bool cache)
+{
+    CBlockIndexCold cold;
+    if (GetInMemory(hash, cold)) return cold;
+
+    // Read outside of the lock, another thread may cache the entry meanwhile
+    if (!pblocktree || !pblocktree->ReadBlockIndexCold(hash, cold) || !cache) return cold;
+
+    LOCK(m_mutex);
+    if (!m_pinned.count(hash) && !m_recent.count(hash) && !m_lru_index.count(hash)) Keep(hash, height, cold);
+    return cold;
+}
+
+bool CBlockIndexColdStore::GetInMemory(const uint256& hash, CBlockIndexCold& cold)
+{
+    LOCK(m_mutex);
+    auto pinned = m_pinned.find(hash);
+    if (pinned != m_pinned.end()) {
+        cold = pinned->second;
+        return true;
+    }
+    auto recent = m_recent.find(hash);
+    if (recent != m_recent.end()) {
+        cold = recent->second.second;
+        return true;
+    }
+    auto it = m_lru_index.find(hash);
+    if (it != m_lru_index.end()) {
+        m_lru.splice(m_lru.begin(), m_lru, it->second);
+        cold = it->second->second;
+        return true;
+    }
+    return false;
+}
+
+void CBlockIndexColdStore::Written(const std::vector<const CBlockIndex*>& written)
+{
+    LOCK(m_mutex);
+    for (const CBlockIndex* pindex : written) {
+        auto it = m_pinned.find(pindex->GetBlockHash());
+        if (it == m_pinned.end()) continue;
+        Keep(it->first, pindex->nHeight, std::move(it->second));
+        m_pinned.erase(it);
+    }
+}
+
+void CBlockIndexColdStore::SetRecentHeight(int height)
+{
+    LOCK(m_mutex);
+    m_recent_height = height;
+    while (!m_recent_by_height.empty() && m_recent_by_height.begin()->first < height) {
+        const uint256 hash = m_recent_by_height.begin()->second;
+        m_recent_by_height.erase(m_recent_by_height.begin());
+        auto it = m_recent.find(hash);
+        Cache(hash, std::move(it->second.second));
+        m_recent.erase(it);
+    }
+}
+
+void CBlockIndexColdStore::Erase(const uint256& hash)
+{
+    LOCK(m_mutex);
+    m_pinned.erase(hash);
+    EraseCached(hash);
+}
+
+void CBlockIndexColdStore::Keep(const uint256& hash, int height, CBlockIndexCold cold)
+{
+    AssertLockHeld(m_mutex);
+    if (height < m_recent_height || m_max_recent == 0) {
+        Cache(hash, std::move(cold));
+        return;
+    }
+    m_recent.emplace(hash, std::make_pair(height, std::move(cold)));
+    m_recent_by_height.emplace(height, hash);
+    if (m_recent.size() > m_max_recent) {
+        // Over the bound the lowest entries go to the LRU
+        const uint256 lowest = m_recent_by_height.begin()->second;
+        m_recent_by_height.erase(m_recent_by_height.begin());
+        auto it = m_recent.find(lowest);
+        Cache(lowest, std::move(it->second.second));
+        m_recent.erase(it);
+    }
+}
+
+void CBlockIndexColdStore::EraseCached(const uint256& hash)
+{
+    AssertLockHeld(m_mutex);
+    auto recent = m_recent.find(hash);
+    if (recent != m_recent.end()) {
+        m_recent_by_height.erase(std::make_pair(recent->second.first, hash));
+        m_recent.erase(recent);
+    }
+    auto it = m_lru_index.find(hash);
+    if (it != m_lru_index.end()) {
+        m_lru.erase(it->second);
+        m_lru_index.erase(it);
+    }
+}
+
+void CBlockIndexColdStore::Cache(const uint256& hash, CBlockIndexCold cold)
+{
+    AssertLockHeld(m_mutex);
+    if (m_max_cached == 0) return;
+    m_lru.emplace_front(hash, std::move(cold));
+    m_lru_index[hash] = m_lru.begin();
+    while (m_lru.size() > m_max_cached) {
+        m_lru_index.erase(m_lru.back().first);
+        m_lru.pop_back();
+    }
+}
+
+void CBlockIndexColdStore::Clear()
+{
+    LOCK(m_mutex);
+    m_pinned.clear();
+    m_recent_height = std::numeric_limits<int>::max();
+    m_recent.clear();
+    m_recent_by_height.clear();
+    m_lru.clear();
+    m_lru_index.clear();
+}
+
+size_t CBlockIndexColdStore::Pinned() const
+{
+    LOCK(m_mutex);
+    return m_pinned.size();
+}
+
+size_t CBlockIndexColdStore::Recent() const
+{
+    LOCK(m_mutex);
+    return m_recent.size();
+}
+
+size_t CBlockIndexColdStore::Cached() const
+{
+    LOCK(m_mutex);
+    return m_lru.size();
+}
+
+size_t CBlockIndexColdStore::DynamicMemoryUsage() const
+{
+    LOCK(m_mutex);
+    // A list node is the value and two pointers
+    size_t usage = memusage::DynamicUsage(m_pinned) + memusage::DynamicUsage(m_recent) +
+                   memusage::DynamicUsage(m_recent_by_height) + memusage::DynamicUsage(m_lru_index) +
+                   m_lru.size() * memusage::MallocUsage(sizeof(LruList::value_type) + 2 * sizeof(void*));
+    for (const auto& entry : m_pinned) {
+        usage += ColdUsage(entry.second);
+    }
+    for (const auto& entry : m_recent) {
+        usage += ColdUsage(entry.second.second);
+    }
+    for (const auto& entry : m_lru) {
+        usage += ColdUsage(entry.second);
+    }
+    return usage;
+}
@@ -0,0 +1,87 @@
+// Copyright (c) 2024 The NeuralLead developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_BLOCKINDEXCOLD_H
+#define BITCOIN_BLOCKINDEXCOLD_H
+
+#include <chain.h>
+#include <sync.h>
+#include <uint256.h>
+#include <validation.h>
+
+#include <limits>
+#include <list>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+//! Cold block index entries kept in memory after they were read from the block tree DB
+static const size_t DEFAULT_BLOCK_INDEX_COLD_CACHE = 4096;
+//! Cold block index entries this close to the tip height are kept in memory, as getheaders serves them the most
+static const int BLOCK_INDEX_COLD_RECENT_DEPTH = 2000;
+//! Upper bound of the recent entries, fork headers can add several entries per height
+static const size_t MAX_BLOCK_INDEX_COLD_RECENT = 2 * BLOCK_INDEX_COLD_RECENT_DEPTH;
+
+/**
+ * The cold fields of the block index entries, the block signature and the
+ * proof hash, which are only needed to serve headers and RPCs once a block
+ * is connected.
+ *
+ * An entry that was added or changed since the block index was last written
+ * is pinned in memory until Written() is called for it. Written entries at or
+ * above the recent height set by SetRecentHeight() stay in memory, up to
+ * MAX_BLOCK_INDEX_COLD_RECENT of them. The others are read back from the block
+ * tree DB on demand and the last ones read are kept in an LRU of
+ * DEFAULT_BLOCK_INDEX_COLD_CACHE entries.
+ */
+class CBlockIndexColdStore
+{
+public:
+    explicit CBlockIndexColdStore(size_t max_cached = DEFAULT_BLOCK_INDEX_COLD_CACHE, size_t max_recent = MAX_BLOCK_INDEX_COLD_RECENT)
+        : m_max_cached(max_cached), m_max_recent(max_recent) {}
+
+    //! Set the cold fields of a new or changed entry, pinning them until written
+    void Set(const uint256& hash, CBlockIndexCold cold);
+    //! Returns false if the entry already had this proof hash
+    bool SetHashProof(const uint256& hash, const uint256& hashProof);
+    //! The cold fields of the entry at this height, empty if it is neither in memory nor in the DB.
+    //! An entry read from the DB is only kept in memory with cache set.
+    CBlockIndexCold Get(const uint256& hash, int height = -1, bool cache = true);
+    //! The cold fields of the entry if they are in memory, without reading the DB
+    bool GetInMemory(const uint256& hash, CBlockIndexCold& cold);
+    //! The entries were written to the block tree DB and can be dropped
+    void Written(const std::vector<const CBlockIndex*>& written);
+    //! Keep the entries at or above this height in memory once written, drop the recent ones below it
+    void SetRecentHeight(int height);
+    //! The entry was removed from the block index, drop it even if it was never written
+    void Erase(const uint256& hash);
+    void Clear();
+
+    size_t Pinned() const;
+    size_t Recent() const;
+    size_t Cached() const;
+    size_t DynamicMemoryUsage() const;
+
+private:
+    typedef std::list<std::pair<uint256, CBlockIndexCold>> LruList;
+
+    const size_t m_max_cached;
+    const size_t m_max_recent;
+    mutable Mutex m_mutex;
+    std::unordered_map<uint256, CBlockIndexCold, BlockHasher> m_pinned GUARDED_BY(m_mutex);
+    int m_recent_height GUARDED_BY(m_mutex){std::numeric_limits<int>::max()};
+    std::unordered_map<uint256, std::pair<int, CBlockIndexCold>, BlockHasher> m_recent GUARDED_BY(m_mutex);
+    std::set<std::pair<int, uint256>> m_recent_by_height GUARDED_BY(m_mutex);
+    LruList m_lru GUARDED_BY(m_mutex);
+    std::unordered_map<uint256, LruList::iterator, BlockHasher> m_lru_index GUARDED_BY(m_mutex);
+
+    void Cache(const uint256& hash, CBlockIndexCold cold) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+    //! Keep a written entry in memory if it is recent, otherwise cache it
+    void Keep(const uint256& hash, int height, CBlockIndexCold cold) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+    void EraseCached(const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+};
+
+extern CBlockIndexColdStore g_block_index_cold;
+
+#endif // BITCOIN_BLOCKINDEXCOLD_H
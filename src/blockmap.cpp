@@ -0,0 +1,104 @@
+// Copyright (c) 2024 The NeuralLead developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <blockmap.h>
+
+#include <memusage.h>
+
+BlockMap::iterator BlockMap::begin() const
+{
+    size_t slot = 0;
+    while (slot < m_slots.size() && m_slots[slot] == nullptr) ++slot;
+    return MakeIterator(slot);
+}
+
+BlockMap::iterator BlockMap::find(const uint256& hash) const
+{
+    if (m_size == 0) return end();
+    const size_t slot = FindSlot(hash);
+    return m_slots[slot] == nullptr ? end() : MakeIterator(slot);
+}
+
+size_t BlockMap::FindSlot(const uint256& hash) const
+{
+    const size_t mask = m_slots.size() - 1;
+    size_t slot = Home(hash);
+    while (m_slots[slot] != nullptr && m_slots[slot]->hash != hash) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void BlockMap::erase(iterator it)
+{
+    size_t slot = it.m_slot - m_slots.data();
+    Node* node = m_slots[slot];
+    node->index.SetNull();
+    m_free.push_back(node);
+
+    // Shift the following entries of the probe sequence back into the hole
+    const size_t mask = m_slots.size() - 1;
+    for (size_t next = (slot + 1) & mask; m_slots[next] != nullptr; next = (next + 1) & mask) {
+        if (((next - Home(m_slots[next]->hash)) & mask) >= ((next - slot) & mask)) {
+            m_slots[slot] = m_slots[next];
+            slot = next;
+        }
+    }
+    m_slots[slot] = nullptr;
+    --m_size;
+}
+
+void BlockMap::clear()
+{
+    m_slots.clear();
+    m_slots.shrink_to_fit();
+    m_size = 0;
+    m_chunks.clear();
+    m_chunks.shrink_to_fit();
+    m_allocated = 0;
+    m_free.clear();
+    m_free.shrink_to_fit();
+}
+
+void BlockMap::reserve(size_t n)
+{
+    size_t slots = std::max<size_t>(m_slots.size(), 16);
+    while (n * 4 > slots * 3) slots *= 2;
+    if (slots != m_slots.size()) Rehash(slots);
+
+    const size_t nodes = m_allocated + (n > m_size + m_free.size() ? n - m_size - m_free.size() : 0);
+    while (m_chunks.size() * BLOCK_MAP_CHUNK_NODES < nodes) {
+        m_chunks.emplace_back(new Node[BLOCK_MAP_CHUNK_NODES]);
+    }
+}
+
+void BlockMap::Rehash(size_t slots)
+{
+    std::vector<Node*> old_slots(slots, nullptr);
+    m_slots.swap(old_slots);
+    for (Node* node : old_slots) {
+        if (node != nullptr) m_slots[FindSlot(node->hash)] = node;
+    }
+}
+
+BlockMap::Node* BlockMap::Allocate()
+{
+    if (!m_free.empty()) {
+        Node* node = m_free.back();
+        m_free.pop_back();
+        return node;
+    }
+    if (m_allocated == m_chunks.size() * BLOCK_MAP_CHUNK_NODES) {
+        m_chunks.emplace_back(new Node[BLOCK_MAP_CHUNK_NODES]);
+    }
+    Node* node = &m_chunks[m_allocated / BLOCK_MAP_CHUNK_NODES][m_allocated % BLOCK_MAP_CHUNK_NODES];
+    ++m_allocated;
+    return node;
+}
+
+size_t BlockMap::DynamicMemoryUsage() const
+{
+    return memusage::DynamicUsage(m_slots) + memusage::DynamicUsage(m_free) + memusage::DynamicUsage(m_chunks) +
+           m_chunks.size() * memusage::MallocUsage(sizeof(Node) * BLOCK_MAP_CHUNK_NODES);
+}
@@ -0,0 +1,139 @@
+// Copyright (c) 2024 The NeuralLead developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_BLOCKMAP_H
+#define BITCOIN_BLOCKMAP_H
+
+#include <chain.h>
+#include <crypto/common.h> // for ReadLE64
+#include <uint256.h>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+struct BlockHasher
+{
+    // this used to call `GetCheapHash()` in uint256, which was later moved; the
+    // cheap hash function simply calls ReadLE64() however, so the end result is
+    // identical
+    size_t operator()(const uint256& hash) const { return ReadLE64(hash.begin()); }
+};
+
+//! Block index nodes allocated at once by a BlockMap
+static constexpr size_t BLOCK_MAP_CHUNK_NODES = 4096;
+
+/**
+ * The block index, mapping block hashes to their CBlockIndex.
+ *
+ * The nodes are allocated next to their block hash in chunks of
+ * BLOCK_MAP_CHUNK_NODES, so that the entries added one after the other, which
+ * are usually parents and children, share the same cache lines and pages. The
+ * map itself is an open addressing table of node pointers with linear probing
+ * on the cheap hash of the block hash.
+ *
+ * Nodes never move: a CBlockIndex and its phashBlock stay valid until the
+ * entry is erased or the map is cleared, which gives all chunks back at once.
+ * Iterators are invalidated by any insertion or erasure.
+ */
+class BlockMap
+{
+    struct Node {
+        uint256 hash;
+        CBlockIndex index;
+    };
+
+public:
+    typedef std::pair<const uint256&, CBlockIndex*> value_type;
+
+    class iterator
+    {
+    public:
+        struct pointer {
+            value_type value;
+            const value_type* operator->() const { return &value; }
+        };
+
+        iterator() = default;
+        value_type operator*() const { return {(*m_slot)->hash, &(*m_slot)->index}; }
+        pointer operator->() const { return {**this}; }
+        iterator& operator++()
+        {
+            do {
+                ++m_slot;
+            } while (m_slot != m_end && *m_slot == nullptr);
+            return *this;
+        }
+        iterator operator++(int)
+        {
+            iterator it = *this;
+            ++*this;
+            return it;
+        }
+        bool operator==(const iterator& other) const { return m_slot == other.m_slot; }
+        bool operator!=(const iterator& other) const { return m_slot != other.m_slot; }
+
+    private:
+        friend class BlockMap;
+        iterator(Node* const* slot, Node* const* end) : m_slot(slot), m_end(end) {}
+        Node* const* m_slot{nullptr};
+        Node* const* m_end{nullptr};
+    };
+    typedef iterator const_iterator;
+
+    BlockMap() = default;
+    BlockMap(const BlockMap&) = delete;
+    BlockMap& operator=(const BlockMap&) = delete;
+
+    iterator begin() const;
+    iterator end() const { return MakeIterator(m_slots.size()); }
+    iterator find(const uint256& hash) const;
+    size_t count(const uint256& hash) const { return find(hash) != end(); }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    /** Add an entry constructed from args, with its phashBlock set, unless the hash is
+     *  already in the map. Returns the entry and whether it was added. */
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(const uint256& hash, Args&&... args)
+    {
+        if ((m_size + 1) * 4 > m_slots.size() * 3) Rehash(std::max<size_t>(m_slots.size() * 2, 16));
+        const size_t slot = FindSlot(hash);
+        if (m_slots[slot] != nullptr) return {MakeIterator(slot), false};
+
+        Node* node = Allocate();
+        node->hash = hash;
+        node->index = CBlockIndex(std::forward<Args>(args)...);
+        node->index.phashBlock = &node->hash;
+        m_slots[slot] = node;
+        ++m_size;
+        return {MakeIterator(slot), true};
+    }
+
+    //! Remove an entry, its node is reused by a later insertion
+    void erase(iterator it);
+    //! Remove all entries and free every node
+    void clear();
+    //! Allocate the table and the nodes for n entries
+    void reserve(size_t n);
+
+    size_t DynamicMemoryUsage() const;
+
+private:
+    std::vector<Node*> m_slots;
+    size_t m_size{0};
+    std::vector<std::unique_ptr<Node[]>> m_chunks;
+    //! Nodes handed out from the chunks, including the freed ones
+    size_t m_allocated{0};
+    std::vector<Node*> m_free;
+
+    iterator MakeIterator(size_t slot) const { return iterator(m_slots.data() + slot, m_slots.data() + m_slots.size()); }
+    size_t Home(const uint256& hash) const { return BlockHasher()(hash) & (m_slots.size() - 1); }
+    //! The slot of hash, or the empty slot it would be inserted at
+    size_t FindSlot(const uint256& hash) const;
+    void Rehash(size_t slots);
+    Node* Allocate();
+};
+
+#endif // BITCOIN_BLOCKMAP_H
@@ -5,6 +5,8 @@
 
 #include <chain.h>
 
+#include <blockindexcold.h>
+
 /**
  * CChain implementation
  */
@@ -119,6 +121,34 @@ void CBlockIndex::BuildSkip()
         pskip = pprev->GetAncestor(GetSkipHeight(nHeight));
 }
 
+CBlockHeader CBlockIndex::GetBlockHeader() const
+{
+    CBlockHeader block = GetHotBlockHeader();
+    block.vchBlockSig = GetCold().vchBlockSig;
+    return block;
+}
+
+CBlockHeader CBlockIndex::GetHotBlockHeader() const
+{
+    CBlockHeader block;
+    block.nVersion       = nVersion;
+    if (pprev)
+        block.hashPrevBlock = pprev->GetBlockHash();
+    block.hashMerkleRoot = hashMerkleRoot;
+    block.nTime          = nTime;
+    block.nBits          = nBits;
+    block.nNonce         = nNonce;
+    block.prevoutStake   = prevoutStake;
+    return block;
+}
+
+CBlockIndexCold CBlockIndex::GetCold() const
+{
+    if (!phashBlock)
+        return CBlockIndexCold();
+    return g_block_index_cold.Get(*phashBlock, nHeight);
+}
+
 arith_uint256 GetBlockProof(const CBlockIndex& block)
 {
     arith_uint256 bnTarget;
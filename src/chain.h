@@ -129,6 +129,17 @@ enum BlockStatus: uint32_t {
     BLOCK_OPT_WITNESS       =   128, //!< block data in blk*.data was received with a witness-enforcing client
 };
 
+/**
+ * The fields of a block index entry that are not kept in memory, see
+ * CBlockIndexColdStore.
+ */
+struct CBlockIndexCold
+{
+    //! block signature - proof-of-stake protect the block by signing the block using a stake holder private key
+    std::vector<unsigned char> vchBlockSig;
+    uint256 hashProof;
+};
+
 /** The block chain is a tree shaped structure starting with the
  * genesis block at the root, with each block potentially having multiple
  * candidates to be the next block. A blockindex may have multiple pprev pointing
@@ -144,7 +155,7 @@ public:
     CBlockIndex* pprev{nullptr};
 
     //! pointer to the index of the successor of this block
-    CBlockIndex* pnext;
+    CBlockIndex* pnext{nullptr};
 
     //! pointer to the index of some further predecessor of this block
     CBlockIndex* pskip{nullptr};
@@ -183,13 +194,10 @@ public:
     uint32_t nBits{0};
     uint32_t nNonce{0};
 
-    // Proof of stake
+    // Proof of stake, the block signature and the proof hash are in GetCold()
     COutPoint prevoutStake;
-    // block signature - proof-of-stake protect the block by signing the block using a stake holder private key
-    std::vector<unsigned char> vchBlockSig;
-    uint256 nStakeModifier;
-    uint256 hashProof;
-    uint64_t nMoneySupply;
+    uint256 nStakeModifier{};
+    uint64_t nMoneySupply{0};
 
     //! (memory only) Sequential id assigned to distinguish order in which blocks are received.
     int32_t nSequenceId{0};
@@ -220,9 +228,7 @@ public:
         nBits          = 0;
         nNonce         = 0;
         prevoutStake.SetNull();
-        vchBlockSig.clear();
         nStakeModifier = uint256();
-        hashProof = uint256();
         nMoneySupply = 0;
     }
 
@@ -245,9 +251,7 @@ public:
         nBits          = block.nBits;
         nNonce         = block.nNonce;
         prevoutStake   = block.prevoutStake;
-        vchBlockSig    = block.vchBlockSig;
         nStakeModifier = uint256();
-        hashProof = uint256(); 
         nMoneySupply   = 0;
     }
 
@@ -269,20 +273,14 @@ public:
         return ret;
     }
 
-    CBlockHeader GetBlockHeader() const
-    {
-        CBlockHeader block;
-        block.nVersion       = nVersion;
-        if (pprev)
-            block.hashPrevBlock = pprev->GetBlockHash();
-        block.hashMerkleRoot = hashMerkleRoot;
-        block.nTime          = nTime;
-        block.nBits          = nBits;
-        block.nNonce         = nNonce;
-        block.vchBlockSig    = vchBlockSig;
-        block.prevoutStake   = prevoutStake;
-        return block;
-    }
+    //! The header, with the block signature from GetCold()
+    CBlockHeader GetBlockHeader() const;
+
+    //! The header without the block signature, from the in-memory fields only
+    CBlockHeader GetHotBlockHeader() const;
+
+    //! The block signature and proof hash, read from the block tree DB when not in memory
+    CBlockIndexCold GetCold() const;
 
     uint256 GetBlockHash() const
     {
@@ -385,6 +383,8 @@ class CDiskBlockIndex : public CBlockIndex
 {
 public:
     uint256 hashPrev;
+    std::vector<unsigned char> vchBlockSig;
+    uint256 hashProof;
 
     CDiskBlockIndex() {
         hashPrev = uint256();
@@ -392,6 +392,9 @@ public:
 
     explicit CDiskBlockIndex(const CBlockIndex* pindex) : CBlockIndex(*pindex) {
         hashPrev = (pprev ? pprev->GetBlockHash() : uint256());
+        CBlockIndexCold cold = pindex->GetCold();
+        vchBlockSig = std::move(cold.vchBlockSig);
+        hashProof = cold.hashProof;
     }
 
     SERIALIZE_METHODS(CDiskBlockIndex, obj)
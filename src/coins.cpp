@@ -33,10 +33,134 @@ size_t CCoinsViewBacked::EstimateSize() const { return base->EstimateSize(); }
 
 SaltedOutpointHasher::SaltedOutpointHasher() : k0(GetRand(std::numeric_limits<uint64_t>::max())), k1(GetRand(std::numeric_limits<uint64_t>::max())) {}
 
+size_t CCoinsMap::FirstFull(size_t slot) const
+{
+    while (slot < m_ctrl.size() && !(m_ctrl[slot] & SLOT_FULL)) ++slot;
+    return slot;
+}
+
+size_t CCoinsMap::FindSlot(const COutPoint& outpoint) const
+{
+    if (m_size == 0) return m_ctrl.size();
+    const size_t hash = m_hasher(outpoint);
+    const size_t mask = m_ctrl.size() - 1;
+    const uint8_t tag = Tag(hash);
+    for (size_t slot = hash & mask; m_ctrl[slot] != SLOT_EMPTY; slot = (slot + 1) & mask) {
+        if (m_ctrl[slot] == tag && m_cells[slot]->value.first == outpoint) return slot;
+    }
+    return m_ctrl.size();
+}
+
+bool CCoinsMap::FindOrPrepareSlot(const COutPoint& outpoint, size_t hash, size_t& slot)
+{
+    if ((m_size + m_deleted + 1) * 4 > m_ctrl.size() * 3) {
+        // Grow the table once it is half full, otherwise only drop the deleted slots
+        size_t slots = std::max(m_ctrl.size(), MIN_SLOTS);
+        if ((m_size + 1) * 2 > slots) slots *= 2;
+        Rehash(slots);
+    }
+
+    const size_t mask = m_ctrl.size() - 1;
+    const uint8_t tag = Tag(hash);
+    size_t deleted = m_ctrl.size();
+    for (slot = hash & mask; m_ctrl[slot] != SLOT_EMPTY; slot = (slot + 1) & mask) {
+        if (m_ctrl[slot] == tag && m_cells[slot]->value.first == outpoint) return false;
+        if (m_ctrl[slot] == SLOT_DELETED && deleted == m_ctrl.size()) deleted = slot;
+    }
+    if (deleted != m_ctrl.size()) slot = deleted;
+    return true;
+}
+
+CCoinsMap::iterator CCoinsMap::erase(const_iterator it)
+{
+    const size_t slot = it.m_ctrl - m_ctrl.data();
+    Cell* cell = m_cells[slot];
+    cell->value.~value_type();
+    cell->next_free = m_free;
+    m_free = cell;
+
+    // A slot followed by an empty one ends every probe sequence through it
+    m_cells[slot] = nullptr;
+    if (m_ctrl[(slot + 1) & (m_ctrl.size() - 1)] == SLOT_EMPTY) {
+        m_ctrl[slot] = SLOT_EMPTY;
+    } else {
+        m_ctrl[slot] = SLOT_DELETED;
+        ++m_deleted;
+    }
+    --m_size;
+    return MakeIterator(FirstFull(slot + 1));
+}
+
+void CCoinsMap::clear()
+{
+    for (size_t slot = 0; slot < m_ctrl.size(); ++slot) {
+        if (m_ctrl[slot] & SLOT_FULL) m_cells[slot]->value.~value_type();
+    }
+    m_ctrl.clear();
+    m_ctrl.shrink_to_fit();
+    m_cells.clear();
+    m_cells.shrink_to_fit();
+    m_size = 0;
+    m_deleted = 0;
+    m_chunks.clear();
+    m_chunks.shrink_to_fit();
+    m_chunks_usage = 0;
+    m_chunks_entries = 0;
+    m_chunk_next = m_chunk_end = nullptr;
+    m_free = nullptr;
+}
+
+void CCoinsMap::reserve(size_t n)
+{
+    size_t slots = std::max(m_ctrl.size(), MIN_SLOTS);
+    while (n * 4 > slots * 3) slots *= 2;
+    if (slots != m_ctrl.size()) Rehash(slots);
+}
+
+void CCoinsMap::Rehash(size_t slots)
+{
+    std::vector<uint8_t> ctrl(slots, SLOT_EMPTY);
+    std::vector<Cell*> cells(slots, nullptr);
+    const size_t mask = slots - 1;
+    for (size_t i = 0; i < m_ctrl.size(); ++i) {
+        if (!(m_ctrl[i] & SLOT_FULL)) continue;
+        size_t slot = m_hasher(m_cells[i]->value.first) & mask;
+        while (ctrl[slot] != SLOT_EMPTY) slot = (slot + 1) & mask;
+        ctrl[slot] = m_ctrl[i];
+        cells[slot] = m_cells[i];
+    }
+    m_ctrl.swap(ctrl);
+    m_cells.swap(cells);
+    m_deleted = 0;
+}
+
+CCoinsMap::Cell* CCoinsMap::Allocate()
+{
+    if (m_free != nullptr) {
+        Cell* cell = m_free;
+        m_free = cell->next_free;
+        return cell;
+    }
+    if (m_chunk_next == m_chunk_end) {
+        const size_t entries = std::min(std::max(m_chunks_entries, MIN_CHUNK_ENTRIES), COINS_MAP_CHUNK_ENTRIES);
+        m_chunks.emplace_back(new Cell[entries]);
+        m_chunks_entries += entries;
+        m_chunks_usage += memusage::MallocUsage(sizeof(Cell) * entries);
+        m_chunk_next = m_chunks.back().get();
+        m_chunk_end = m_chunk_next + entries;
+    }
+    return m_chunk_next++;
+}
+
+size_t CCoinsMap::DynamicMemoryUsage() const
+{
+    return memusage::DynamicUsage(m_ctrl) + memusage::DynamicUsage(m_cells) + memusage::DynamicUsage(m_chunks) + m_chunks_usage;
+}
+
 CCoinsViewCache::CCoinsViewCache(CCoinsView *baseIn) : CCoinsViewBacked(baseIn), cachedCoinsUsage(0) {}
 
 size_t CCoinsViewCache::DynamicMemoryUsage() const {
-    return memusage::DynamicUsage(cacheCoins) + cachedCoinsUsage;
+    return cacheCoins.DynamicMemoryUsage() + cachedCoinsUsage;
 }
 
 CCoinsMap::iterator CCoinsViewCache::FetchCoin(const COutPoint &outpoint) const {
@@ -46,7 +170,7 @@ CCoinsMap::iterator CCoinsViewCache::FetchCoin(const COutPoint &outpoint) const
     Coin tmp;
     if (!base->GetCoin(outpoint, tmp))
         return cacheCoins.end();
-    CCoinsMap::iterator ret = cacheCoins.emplace(std::piecewise_construct, std::forward_as_tuple(outpoint), std::forward_as_tuple(std::move(tmp))).first;
+    CCoinsMap::iterator ret = cacheCoins.try_emplace(outpoint, std::move(tmp)).first;
     if (ret->second.coin.IsSpent()) {
         // The parent only has an empty entry for this outpoint; we can consider our
         // version as fresh.
@@ -56,6 +180,14 @@ CCoinsMap::iterator CCoinsViewCache::FetchCoin(const COutPoint &outpoint) const
     return ret;
 }
 
+bool CCoinsViewCache::WarmCoin(const COutPoint &outpoint, Coin&& coin) {
+    assert(!coin.IsSpent());
+    auto inserted = cacheCoins.emplace(outpoint, CCoinsCacheEntry(std::move(coin)));
+    if (!inserted.second) return false;
+    cachedCoinsUsage += inserted.first->second.coin.DynamicMemoryUsage();
+    return true;
+}
+
 bool CCoinsViewCache::GetCoin(const COutPoint &outpoint, Coin &coin) const {
     CCoinsMap::const_iterator it = FetchCoin(outpoint);
     if (it != cacheCoins.end()) {
@@ -70,7 +202,7 @@ void CCoinsViewCache::AddCoin(const COutPoint &outpoint, Coin&& coin, bool possi
     if (coin.out.scriptPubKey.IsUnspendable()) return;
     CCoinsMap::iterator it;
     bool inserted;
-    std::tie(it, inserted) = cacheCoins.emplace(std::piecewise_construct, std::forward_as_tuple(outpoint), std::tuple<>());
+    std::tie(it, inserted) = cacheCoins.try_emplace(outpoint);
     bool fresh = false;
     if (!inserted) {
         cachedCoinsUsage -= it->second.coin.DynamicMemoryUsage();
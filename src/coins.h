@@ -18,7 +18,12 @@
 #include <stdint.h>
 
 #include <functional>
-#include <unordered_map>
+#include <iterator>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 /**
  * A UTXO entry.
@@ -162,7 +167,165 @@ struct CCoinsCacheEntry
     explicit CCoinsCacheEntry(Coin&& coin_) : coin(std::move(coin_)), flags(0) {}
 };
 
-typedef std::unordered_map<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher> CCoinsMap;
+//! Entries allocated at once by a CCoinsMap, once it holds that many
+static constexpr size_t COINS_MAP_CHUNK_ENTRIES = 4096;
+
+/**
+ * The coins of a cache, mapping outpoints to their CCoinsCacheEntry.
+ *
+ * The entries are allocated from chunks that double in size up to
+ * COINS_MAP_CHUNK_ENTRIES, and erased entries are reused by later insertions,
+ * so that a coin costs no allocation of its own. The Coin and its script, when
+ * it fits the inline storage of CScript, are stored in the entry.
+ *
+ * The map itself is an open addressing table with linear probing on the salted
+ * hash of the outpoint. Next to the table of entry pointers, a byte per slot
+ * holds 7 bits of the hash, so that probing only follows the pointers of
+ * likely matches. Erased slots are marked deleted until the table is rehashed.
+ *
+ * Entries never move: references to them stay valid until they are erased.
+ * Iterators stay valid across erasures, but not across insertions.
+ */
+class CCoinsMap
+{
+public:
+    typedef COutPoint key_type;
+    typedef CCoinsCacheEntry mapped_type;
+    typedef std::pair<const COutPoint, CCoinsCacheEntry> value_type;
+
+private:
+    union Cell {
+        value_type value;
+        Cell* next_free;
+        Cell() {}
+        ~Cell() {}
+    };
+
+    static constexpr size_t MIN_SLOTS = 8;
+    static constexpr size_t MIN_CHUNK_ENTRIES = 8;
+    static constexpr uint8_t SLOT_EMPTY = 0;
+    static constexpr uint8_t SLOT_DELETED = 1;
+    static constexpr uint8_t SLOT_FULL = 0x80;
+
+    template <typename V>
+    class Iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef typename std::remove_const<V>::type value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef V* pointer;
+        typedef V& reference;
+
+        Iterator() = default;
+        template <typename W, typename = typename std::enable_if<std::is_const<V>::value && !std::is_const<W>::value>::type>
+        Iterator(const Iterator<W>& other) : m_ctrl(other.m_ctrl), m_cell(other.m_cell), m_end(other.m_end) {}
+
+        V& operator*() const { return (*m_cell)->value; }
+        V* operator->() const { return &(*m_cell)->value; }
+        Iterator& operator++()
+        {
+            do {
+                ++m_ctrl;
+                ++m_cell;
+            } while (m_ctrl != m_end && !(*m_ctrl & SLOT_FULL));
+            return *this;
+        }
+        Iterator operator++(int)
+        {
+            Iterator it = *this;
+            ++*this;
+            return it;
+        }
+        bool operator==(const Iterator& other) const { return m_ctrl == other.m_ctrl; }
+        bool operator!=(const Iterator& other) const { return m_ctrl != other.m_ctrl; }
+
+    private:
+        friend class CCoinsMap;
+        template <typename W>
+        friend class Iterator;
+        Iterator(const uint8_t* ctrl, Cell* const* cell, const uint8_t* end) : m_ctrl(ctrl), m_cell(cell), m_end(end) {}
+        const uint8_t* m_ctrl{nullptr};
+        Cell* const* m_cell{nullptr};
+        const uint8_t* m_end{nullptr};
+    };
+
+public:
+    typedef Iterator<value_type> iterator;
+    typedef Iterator<const value_type> const_iterator;
+
+    CCoinsMap() = default;
+    CCoinsMap(const CCoinsMap&) = delete;
+    CCoinsMap& operator=(const CCoinsMap&) = delete;
+    ~CCoinsMap() { clear(); }
+
+    iterator begin() { return MakeIterator(FirstFull(0)); }
+    const_iterator begin() const { return MakeIterator(FirstFull(0)); }
+    iterator end() { return MakeIterator(m_ctrl.size()); }
+    const_iterator end() const { return MakeIterator(m_ctrl.size()); }
+    iterator find(const COutPoint& outpoint) { return MakeIterator(FindSlot(outpoint)); }
+    const_iterator find(const COutPoint& outpoint) const { return MakeIterator(FindSlot(outpoint)); }
+    size_t count(const COutPoint& outpoint) const { return FindSlot(outpoint) != m_ctrl.size(); }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    /** Add an entry constructed from args unless the outpoint is already in the
+     *  map. Returns the entry and whether it was added. */
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const COutPoint& outpoint, Args&&... args)
+    {
+        const size_t hash = m_hasher(outpoint);
+        size_t slot;
+        if (!FindOrPrepareSlot(outpoint, hash, slot)) return {MakeIterator(slot), false};
+
+        Cell* cell = Allocate();
+        ::new (&cell->value) value_type(std::piecewise_construct, std::forward_as_tuple(outpoint), std::forward_as_tuple(std::forward<Args>(args)...));
+        if (m_ctrl[slot] == SLOT_DELETED) --m_deleted;
+        m_ctrl[slot] = Tag(hash);
+        m_cells[slot] = cell;
+        ++m_size;
+        return {MakeIterator(slot), true};
+    }
+    std::pair<iterator, bool> emplace(const COutPoint& outpoint, CCoinsCacheEntry&& entry) { return try_emplace(outpoint, std::move(entry)); }
+    CCoinsCacheEntry& operator[](const COutPoint& outpoint) { return try_emplace(outpoint).first->second; }
+
+    //! Remove an entry, returning the iterator to the next one
+    iterator erase(const_iterator it);
+    //! Remove all entries and free all memory
+    void clear();
+    //! Size the table for n entries
+    void reserve(size_t n);
+
+    size_t DynamicMemoryUsage() const;
+
+private:
+    SaltedOutpointHasher m_hasher;
+    //! Per slot: SLOT_EMPTY, SLOT_DELETED, or SLOT_FULL with the top 7 bits of the hash
+    std::vector<uint8_t> m_ctrl;
+    std::vector<Cell*> m_cells;
+    size_t m_size{0};
+    size_t m_deleted{0};
+
+    std::vector<std::unique_ptr<Cell[]>> m_chunks;
+    size_t m_chunks_usage{0};
+    size_t m_chunks_entries{0};
+    //! The cells of the last chunk not handed out yet
+    Cell* m_chunk_next{nullptr};
+    Cell* m_chunk_end{nullptr};
+    Cell* m_free{nullptr};
+
+    iterator MakeIterator(size_t slot) { return iterator(m_ctrl.data() + slot, m_cells.data() + slot, m_ctrl.data() + m_ctrl.size()); }
+    const_iterator MakeIterator(size_t slot) const { return const_iterator(m_ctrl.data() + slot, m_cells.data() + slot, m_ctrl.data() + m_ctrl.size()); }
+    static uint8_t Tag(size_t hash) { return SLOT_FULL | uint8_t(hash >> (sizeof(size_t) * 8 - 7)); }
+    size_t FirstFull(size_t slot) const;
+    //! The slot of outpoint, or the number of slots if it is not in the map
+    size_t FindSlot(const COutPoint& outpoint) const;
+    /** Set slot to the slot of outpoint and return false if it is in the map,
+     *  otherwise make room for it and set slot to where it goes. */
+    bool FindOrPrepareSlot(const COutPoint& outpoint, size_t hash, size_t& slot);
+    void Rehash(size_t slots);
+    Cell* Allocate();
+};
 
 /** Cursor for iterating over CoinsView state */
 class CCoinsViewCursor
@@ -279,6 +442,13 @@ public:
      */
     bool HaveCoinInCache(const COutPoint &outpoint) const;
 
+    /**
+     * Add an unspent coin read from the backing CCoinsView ahead of its use,
+     * as fetching it would. Returns false, leaving the cache alone, if the
+     * outpoint is already cached.
+     */
+    bool WarmCoin(const COutPoint &outpoint, Coin&& coin);
+
     /**
      * Return a reference to Coin in the cache, or coinEmpty if not found. This is
      * more efficient than GetCoin.
@@ -0,0 +1,80 @@
+// Copyright (c) 2024 The NeuralLead developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <coinsprefetch.h>
+
+#include <primitives/block.h>
+#include <txdb.h>
+#include <util/system.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+std::vector<COutPoint> GetBlockPrevouts(const CBlock& block)
+{
+    std::vector<uint256> created;
+    created.reserve(block.vtx.size());
+    for (const CTransactionRef& tx : block.vtx) {
+        created.push_back(tx->GetHash());
+    }
+    std::sort(created.begin(), created.end());
+
+    std::vector<COutPoint> prevouts;
+    for (const CTransactionRef& tx : block.vtx) {
+        if (tx->IsCoinBase()) continue;
+        for (const CTxIn& txin : tx->vin) {
+            if (!std::binary_search(created.begin(), created.end(), txin.prevout.hash)) prevouts.push_back(txin.prevout);
+        }
+    }
+    return prevouts;
+}
+
+void PrefetchCoins(const CCoinsViewDB& db, CCoinsPrefetch& prefetch)
+{
+    prefetch.generation = db.GetWriteGeneration();
+    prefetch.coins.assign(prefetch.outpoints.size(), Coin());
+
+    std::atomic<size_t> next{0};
+    auto worker = [&] {
+        while (true) {
+            const size_t begin = next.fetch_add(COINS_PREFETCH_BATCH);
+            if (begin >= prefetch.outpoints.size()) break;
+            for (size_t i = begin; i < std::min(begin + COINS_PREFETCH_BATCH, prefetch.outpoints.size()); ++i) {
+                try {
+                    if (!db.GetCoin(prefetch.outpoints[i], prefetch.coins[i])) prefetch.coins[i].Clear();
+                } catch (const std::exception&) {
+                    prefetch.coins[i].Clear();
+                }
+            }
+        }
+    };
+
+    const size_t batches = (prefetch.outpoints.size() + COINS_PREFETCH_BATCH - 1) / COINS_PREFETCH_BATCH;
+    const int threads = std::min<size_t>(std::min(GetNumCores(), MAX_COINS_PREFETCH_THREADS), batches);
+    std::vector<std::thread> workers;
+    for (int i = 1; i < threads; ++i) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& t : workers) {
+        t.join();
+    }
+}
+
+bool CCoinsPrefetch::IsCurrent(const CCoinsViewDB& db) const
+{
+    // The generation is odd while a write is running
+    return generation % 2 == 0 && generation == db.GetWriteGeneration();
+}
+
+size_t WarmCoinsCache(CCoinsViewCache& cache, const CCoinsViewDB& db, CCoinsPrefetch& prefetch)
+{
+    if (!prefetch.IsCurrent(db)) return 0;
+    size_t warmed = 0;
+    for (size_t i = 0; i < prefetch.coins.size(); ++i) {
+        if (!prefetch.coins[i].IsSpent() && cache.WarmCoin(prefetch.outpoints[i], std::move(prefetch.coins[i]))) ++warmed;
+    }
+    return warmed;
+}
@@ -0,0 +1,64 @@
+// Copyright (c) 2024 The NeuralLead developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_COINSPREFETCH_H
+#define BITCOIN_COINSPREFETCH_H
+
+#include <coins.h>
+#include <primitives/transaction.h>
+#include <uint256.h>
+
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+class CBlock;
+class CCoinsViewDB;
+
+//! Most threads reading the coins of one block from the coins DB
+static const int MAX_COINS_PREFETCH_THREADS = 8;
+//! Coins read by a prefetch thread at a time
+static const size_t COINS_PREFETCH_BATCH = 64;
+
+/**
+ * The coins spent by a block, read from the coins DB before the block is
+ * connected so that ConnectBlock finds them in the coins cache rather than
+ * reading them one by one.
+ */
+struct CCoinsPrefetch {
+    std::vector<COutPoint> outpoints;
+    //! Spent for the outpoints that were not found
+    std::vector<Coin> coins;
+    //! Write generation of the coins DB when the reads started
+    uint64_t generation{0};
+
+    //! Whether the coins DB was not written since the reads started
+    bool IsCurrent(const CCoinsViewDB& db) const;
+};
+
+/** A block read from disk ahead of its connection, with the coins it spends */
+struct CPrefetchedBlock {
+    uint256 hash;
+    std::shared_ptr<const CBlock> block;
+    CCoinsPrefetch coins;
+};
+
+//! The outpoints spent by the block that are not created by the block itself
+std::vector<COutPoint> GetBlockPrevouts(const CBlock& block);
+
+/**
+ * Read the coins of prefetch.outpoints from db on up to MAX_COINS_PREFETCH_THREADS
+ * threads. Takes no lock, db may be read by other threads meanwhile. A coin that
+ * cannot be read is left spent, so that the read by ConnectBlock reports the error.
+ */
+void PrefetchCoins(const CCoinsViewDB& db, CCoinsPrefetch& prefetch);
+
+/**
+ * Add the prefetched coins that cache does not have yet to cache, whose backing
+ * view must read from db. Nothing is added when db was written since the reads
+ * started, as a coin spent meanwhile would come back. Returns the coins added.
+ */
+size_t WarmCoinsCache(CCoinsViewCache& cache, const CCoinsViewDB& db, CCoinsPrefetch& prefetch);
+
+#endif // BITCOIN_COINSPREFETCH_H
@@ -97,9 +97,19 @@ DLL_API_NLHASH void neuralNetwork(float inputs[32], float outputs[8]);
 // Funzione di mescolamento avanzato con integrazione Quantum++
 void compress(uint32_t state[8], const uint8_t* block, uint32_t& quantum_mix, bool useNL);
 
+// Valore di mescolamento del circuito quantistico a 2 qubit di compress() sulle variabili a..h,
+// kernel a dimensione fissa in forma chiusa, identico bit a bit alla simulazione Quantum++
+uint32_t QuantumMix(const uint32_t v[8]);
+
+// Simulazione di riferimento di QuantumMix() con Quantum++, usata solo nei test
+uint32_t QuantumMixReference(const uint32_t v[8]);
+
 // Funzione hash principale DirectComputeHash migliorata e ottimizzata
 DLL_API_NLHASH ComputeStatus DirectComputeHash(const uint8_t* data, size_t length, uint8_t*& output);
 
+// DirectComputeHash() di un blocco di 64 byte, senza allocazioni ne preparazione del padding
+void DirectComputeHash64(const uint8_t* data, uint8_t* hash_output);
+
 DLL_API_NLHASH void setMaximumCPUThreads(int maxThreads);
 DLL_API_NLHASH void setMaximumParallelNeuralNetworks(int maxParallelNueralLeadHashNeuralNetworks);
 
@@ -5,17 +5,17 @@
 #ifndef BITCOIN_CRYPTO_HMAC_SHA256_H
 #define BITCOIN_CRYPTO_HMAC_SHA256_H
 
-#include <crypto/neuralleadqhash_interface.h>
+#include <crypto/sha256.h>
 
 #include <stdint.h>
 #include <stdlib.h>
 
-/** A hasher class for HMAC-SHA-256. */
+/** A hasher class for HMAC-SHA-256. Built on CSHA256, so for local and interoperability uses only. */
 class CHMAC_SHA256
 {
 private:
-    NeuralLeadQHash_iface outer;
-    NeuralLeadQHash_iface inner;
+    CSHA256 outer;
+    CSHA256 inner;
 
 public:
     static const size_t OUTPUT_SIZE = 32;
@@ -53,19 +53,20 @@ OR OTHER DEALINGS IN THE SOFTWARE.
 
 #if defined(_WIN32) || !defined(_WIN64) || defined(__MINGW32__)
 #define Sleep(t) std::this_thread::sleep_for(std::chrono::milliseconds(t));
-
-std::shared_mutex nLock;
-#else
-mutable std::shared_mutex nLock;
 #endif
 
-#define WriteLock std::unique_lock wlock(nLock);
-#define ReadLock  std::shared_lock rlock(nLock);
+#include <atomic>
+#include <condition_variable>
+#include <memory>
 
 #define LOAD_DIRECT 1
 
-int32_t MAX_NLNN = 1;
-int32_t MAX_CPU_THREADS_NLNN = 0;
+// Limite di reti neurali parallele, ogni rete ha il proprio contesto di inferenza
+#define MAX_POOL_NLNN 256
+
+// 0 = automatico alla prima richiesta (vedi NetworkPool::Acquire)
+std::atomic<int32_t> MAX_NLNN{0};
+std::atomic<int32_t> MAX_CPU_THREADS_NLNN{0};
 
 using namespace Coscienza;
 
@@ -77,7 +78,8 @@ class HashNetControl
 public:
     AcceleratedDistributedNetwork* hellonetwork = nullptr;
     Coscienza::Generators::FullValue* gen = nullptr;
-    bool Ready = true;
+    int32_t threads = 0;
+    uint32_t index = 0;
 
     HashNetControl(bool OnGPU = false);
     ~HashNetControl();
@@ -90,7 +92,8 @@ HashNetControl::HashNetControl(bool OnGPU)
 {
     Init_nlhash(hellonetwork, OnGPU);
     gen = hellonetwork->AddFullValueSpikeGenerator(hellonetwork->GetGroup(0));
-    hellonetwork->setThreads(MAX_CPU_THREADS_NLNN);
+    threads = MAX_CPU_THREADS_NLNN;
+    hellonetwork->setThreads(threads);
 }
 
 HashNetControl::~HashNetControl()
@@ -98,109 +101,133 @@ HashNetControl::~HashNetControl()
     //delete hellonetwork;
 }
 
-std::vector<HashNetControl> NetworksControl;
-
-DLL_API_NLHASH int getCPUThreads()
-{
-    WriteLock;
-
-    int n = MAX_CPU_THREADS_NLNN;
-    return n;
-}
-
-DLL_API_NLHASH int getParallelNeuralNetworks()
-{
-    WriteLock;
-    
-    int n = MAX_NLNN;    
-    return n;
-}
-
-DLL_API_NLHASH void setMaximumCPUThreads(int maxThreads)
-{
-    if (maxThreads < 0)
-        return;
-
-    WriteLock;
-    
-    //MAX_CPU_THREADS_NLNN = maxThreads;
-    
-    for (int n = 0; n < NetworksControl.size(); n++)
-    {
-        while (NetworksControl[n].hellonetwork->getSimulationState() == State::Running)
-        {
-            continue;
-        }
-        
-        //NetworksControl[n].hellonetwork->setThreads(maxThreads);
-        std::cout << "NeuralLeadHash Neural Network with index " << std::to_string(n) << " set to " << NetworksControl[n].hellonetwork->getThreads() << " Threads" << std::endl;
-    }
-}
-
-DLL_API_NLHASH void setMaximumParallelNeuralNetworks(int maxParallelNueralLeadHashNeuralNetworks)
-{
-    if (maxParallelNueralLeadHashNeuralNetworks < 1)
-        return;
-
-    WriteLock;
-
-    //MAX_NLNN = maxParallelNueralLeadHashNeuralNetworks;
-}
-
 bool _onGPU = false;
-HashNetControl& getNetworkControl()
-{
-    WriteLock;
 
-    //research:
+// Pool di contesti di inferenza: lista libera lock-free (stack di Treiber con contatore ABA),
+// nessun lock globale e nessuna attesa attiva nel percorso caldo.
+// Il mutex serve solo per creare una nuova rete o per attendere quando tutte sono occupate.
+class NetworkPool
+{
+public:
+    HashNetControl* Acquire()
     {
-        while (true)
+        uint32_t index;
+        if (!Pop(index))
         {
-            for (int n = 0; n < NetworksControl.size(); n++)
+            std::unique_lock<std::mutex> lock(mutex);
+            ++waiters;
+            while (!Pop(index))
             {
-                //if (NetworksControl[n].hellonetwork->getSimulationState() != State::Running)
-                if (NetworksControl[n].Ready)
+                if (created < Limit())
                 {
-                    NetworksControl[n].Ready = false;
-                    return NetworksControl[n];
+                    index = created;
+                    nets[index].reset(new HashNetControl(_onGPU));
+                    nets[index]->index = index;
+                    ++created;
+                    break;
                 }
+                available.wait(lock);
             }
+            --waiters;
+        }
 
-            if (NetworksControl.size() < MAX_NLNN)
-            {
-                //Sleep(1);
-                break;
-            }
+        // Applica setMaximumCPUThreads() alle reti gia create, quando sono libere
+        HashNetControl* ctrl = nets[index].get();
+        if (ctrl->threads != MAX_CPU_THREADS_NLNN)
+        {
+            ctrl->threads = MAX_CPU_THREADS_NLNN;
+            ctrl->hellonetwork->setThreads(ctrl->threads);
         }
+        return ctrl;
     }
 
-
-    /*if (NetworksControl.size() >= MAX_NLNN) // Second check
+    void Release(HashNetControl* ctrl)
     {
-        goto research;
-    }*/
-    
-    if (MAX_CPU_THREADS_NLNN == 0 && NetworksControl.size() == 0)
+        Push(ctrl->index);
+
+        if (waiters > 0)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            available.notify_one();
+        }
+    }
+
+private:
+    std::unique_ptr<HashNetControl> nets[MAX_POOL_NLNN];
+    std::atomic<uint32_t> next[MAX_POOL_NLNN];
+    // Parte bassa: indice + 1 della testa (0 = vuota), parte alta: contatore ABA
+    std::atomic<uint64_t> head{0};
+    std::atomic<int> waiters{0};
+    uint32_t created = 0;
+    std::mutex mutex;
+    std::condition_variable available;
+
+    static uint32_t Limit()
     {
-        if (_onGPU)
+        if (MAX_NLNN == 0)
         {
-            MAX_NLNN = 20;
-            MAX_CPU_THREADS_NLNN = 0;
+            // Impostazione automatica: una rete con tutti i thread su CPU, 20 reti su GPU
+            int32_t expected = 0;
+            MAX_NLNN.compare_exchange_strong(expected, _onGPU ? 20 : 1);
+            if (!_onGPU && MAX_CPU_THREADS_NLNN == 0)
+                MAX_CPU_THREADS_NLNN = std::max(1, omp_get_max_threads() / MAX_NLNN);
         }
-        else
+        return std::min<uint32_t>(MAX_NLNN, MAX_POOL_NLNN);
+    }
+
+    bool Pop(uint32_t& index)
+    {
+        uint64_t old_head = head.load();
+        while ((uint32_t)old_head != 0)
         {
-            MAX_NLNN = 1;
-            MAX_CPU_THREADS_NLNN = //AcceleratedDistributedNetwork::getMaximumThreads() / MAX_NLNN;
-                omp_get_max_threads() / MAX_NLNN;
-            if (MAX_CPU_THREADS_NLNN < 1)
-                MAX_CPU_THREADS_NLNN = 1;
+            index = (uint32_t)old_head - 1;
+            const uint64_t new_head = ((old_head >> 32) + 1) << 32 | next[index].load(std::memory_order_relaxed);
+            if (head.compare_exchange_weak(old_head, new_head))
+                return true;
         }
+        return false;
+    }
+
+    void Push(uint32_t index)
+    {
+        uint64_t old_head = head.load(std::memory_order_relaxed);
+        uint64_t new_head;
+        do
+        {
+            next[index].store((uint32_t)old_head, std::memory_order_relaxed);
+            new_head = ((old_head >> 32) + 1) << 32 | (index + 1);
+        } while (!head.compare_exchange_weak(old_head, new_head));
     }
+};
+
+NetworkPool NetworksControl;
+
+DLL_API_NLHASH int getCPUThreads()
+{
+    return MAX_CPU_THREADS_NLNN;
+}
+
+DLL_API_NLHASH int getParallelNeuralNetworks()
+{
+    return MAX_NLNN;
+}
 
-    HashNetControl& nctrl = NetworksControl.emplace_back(_onGPU);
-    nctrl.Ready = false;
+DLL_API_NLHASH void setMaximumCPUThreads(int maxThreads)
+{
+    if (maxThreads < 0)
+        return;
 
-    return nctrl;
+    // Le reti esistenti lo applicano alla prossima acquisizione
+    MAX_CPU_THREADS_NLNN = maxThreads;
+}
+
+DLL_API_NLHASH void setMaximumParallelNeuralNetworks(int maxParallelNueralLeadHashNeuralNetworks)
+{
+    if (maxParallelNueralLeadHashNeuralNetworks < 1)
+        return;
+
+    // Le reti gia create restano nel pool anche se il limite si riduce
+    MAX_NLNN = std::min(maxParallelNueralLeadHashNeuralNetworks, MAX_POOL_NLNN);
 }
 
 // Funzione per determinare se il sistema è little-endian o big-endian
@@ -252,24 +279,16 @@ void InputsIntToNeuralLead(uint32_t inputs[8], float inputNL[32])
 
 void neuralNetwork(float inputs[32], float outputs[8])
 {
-    //std::vector<float> _inputs(32); // 4 * 8
-    //memcpy(_inputs.data(), inputs, sizeof(float) * 32); // 4 * 8
-
-    auto& netCtrl = getNetworkControl();
-
-    //netCtrl.gen->SetValues(_inputs);
-    netCtrl.hellonetwork->SetFullValueInputs(0, inputs, 32); // 4 * 8
+    HashNetControl* netCtrl = NetworksControl.Acquire();
 
-    netCtrl.hellonetwork->Run();
+    netCtrl->hellonetwork->SetFullValueInputs(0, inputs, 32); // 4 * 8
 
-    //auto& neuralleadhashOutput1 = netCtrl.hellonetwork->GetOutput(0);
-    //auto& neuralleadhashOutput2 = netCtrl.hellonetwork->GetOutput(1);
-    //auto& neuralleadhashOutput3 = netCtrl.hellonetwork->GetOutput(2);
+    netCtrl->hellonetwork->Run();
 
-    auto& neuralleadhashOutput = netCtrl.hellonetwork->GetOutput(2);
+    auto& neuralleadhashOutput = netCtrl->hellonetwork->GetOutput(2);
     memcpy(outputs, neuralleadhashOutput.data(), NL_OUTPUTS * sizeof(float));
 
-    netCtrl.Ready = true;
+    NetworksControl.Release(netCtrl);
 }
 
 int Init_nlhash(AcceleratedDistributedNetwork*& hellonetwork, bool OnGPU)
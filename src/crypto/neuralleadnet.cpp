@@ -0,0 +1,331 @@
+// Copyright (c) 2024 The NeuralLead developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <crypto/neuralleadnet.h>
+
+#include <crypto/cryptoconf.h>
+
+#include <algorithm>
+#include <assert.h>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+const int NeuralLeadNet::INPUTS;
+const int NeuralLeadNet::OUTPUTS;
+const int NeuralLeadNet::LANES;
+
+float NeuralLeadNet::Activate(Activation act, float x)
+{
+    switch (act) {
+    case Activation::SIGMOID:
+        return 1.0f / (1.0f + std::exp(-x));
+    case Activation::EVEN_XOR_NOT:
+        // Even parity of the integer part of the input: 1 when its lowest bit is clear.
+        // Floats of magnitude 2^24 and above are all even integers.
+        if (!(std::fabs(x) < 16777216.0f)) return 1.0f;
+        return (static_cast<int32_t>(x) & 1) == 0 ? 1.0f : 0.0f;
+    }
+    return x;
+}
+
+bool NeuralLeadNet::LoadLayer(const LayerSpec& spec, uint32_t prev_size, std::string& error)
+{
+    // Run() holds a group in a buffer of 128 floats
+    if (spec.synapses.empty() || spec.synapses.size() > 128) {
+        error = "unexpected group size";
+        return false;
+    }
+    for (const std::vector<Synapse>& syns : spec.synapses) {
+        for (const Synapse& syn : syns) {
+            if (syn.idx >= prev_size) {
+                error = "synapse does not come from the previous group";
+                return false;
+            }
+        }
+    }
+
+    Layer layer;
+    layer.act = spec.act;
+    layer.size = spec.synapses.size();
+    layer.synapses = spec.synapses;
+
+    // Pack LANES neurons per block; shorter neurons are padded with zero weights at the end,
+    // which leaves their sums unchanged.
+    for (uint32_t base = 0; base < layer.size; base += LANES) {
+        size_t fanin = 0;
+        for (uint32_t l = 0; l < LANES && base + l < layer.size; ++l) {
+            fanin = std::max(fanin, layer.synapses[base + l].size());
+        }
+        layer.block_begin.push_back(layer.steps.size());
+        for (size_t s = 0; s < fanin; ++s) {
+            Step step;
+            for (uint32_t l = 0; l < LANES; ++l) {
+                const bool used = base + l < layer.size && s < layer.synapses[base + l].size();
+                step.w[l] = used ? layer.synapses[base + l][s].w : 0.0f;
+                step.idx[l] = used ? layer.synapses[base + l][s].idx : 0;
+            }
+            layer.steps.push_back(step);
+        }
+    }
+    layer.block_begin.push_back(layer.steps.size());
+
+    max_size = std::max(max_size, (layer.size + LANES - 1) / LANES * LANES);
+    layers.push_back(std::move(layer));
+    return true;
+}
+
+bool NeuralLeadNet::Load(const std::vector<LayerSpec>& specs, std::string& error)
+{
+    layers.clear();
+    max_size = 0;
+
+    if (specs.size() != 2) {
+        error = "expected the s1 and to groups";
+        return false;
+    }
+    if (!LoadLayer(specs[0], INPUTS, error) || !LoadLayer(specs[1], layers.back().size, error)) {
+        layers.clear();
+        return false;
+    }
+    if (layers.back().size != OUTPUTS) {
+        error = "unexpected output group size";
+        layers.clear();
+        return false;
+    }
+    return true;
+}
+
+void NeuralLeadNet::Run(const float inputs[INPUTS], float outputs[OUTPUTS]) const
+{
+    // Two ping-pong buffers large enough for any layer, padded to whole blocks
+    float buf[2][128];
+    assert(max_size <= 128);
+    const float* in = inputs;
+    float* out = buf[0];
+
+    for (size_t li = 0; li < layers.size(); ++li) {
+        const Layer& layer = layers[li];
+        for (size_t b = 0; b + 1 < layer.block_begin.size(); ++b) {
+            const Step* step = layer.steps.data() + layer.block_begin[b];
+            const Step* const step_end = layer.steps.data() + layer.block_begin[b + 1];
+#if defined(__SSE2__)
+            // One accumulator per group of 4 lanes
+            __m128 acc[LANES / 4];
+            for (int a = 0; a < LANES / 4; ++a) acc[a] = _mm_setzero_ps();
+            for (; step != step_end; ++step) {
+                for (int a = 0; a < LANES / 4; ++a) {
+                    const uint32_t* idx = step->idx + a * 4;
+                    const __m128 x = _mm_set_ps(in[idx[3]], in[idx[2]], in[idx[1]], in[idx[0]]);
+                    acc[a] = _mm_add_ps(acc[a], _mm_mul_ps(_mm_load_ps(step->w + a * 4), x));
+                }
+            }
+            for (int a = 0; a < LANES / 4; ++a) _mm_storeu_ps(out + b * LANES + a * 4, acc[a]);
+#else
+            float acc[LANES] = {};
+            for (; step != step_end; ++step) {
+                for (int l = 0; l < LANES; ++l) acc[l] += step->w[l] * in[step->idx[l]];
+            }
+            memcpy(out + b * LANES, acc, sizeof(acc));
+#endif
+        }
+        for (uint32_t n = 0; n < layer.size; ++n) out[n] = Activate(layer.act, out[n]);
+        in = out;
+        out = buf[(li + 1) & 1];
+    }
+    memcpy(outputs, in, OUTPUTS * sizeof(float));
+}
+
+void NeuralLeadNet::RunStrict(const float inputs[INPUTS], float outputs[OUTPUTS]) const
+{
+    float buf[2][128];
+    assert(max_size <= 128);
+    const float* in = inputs;
+    float* out = buf[0];
+
+    for (size_t li = 0; li < layers.size(); ++li) {
+        const Layer& layer = layers[li];
+        for (uint32_t n = 0; n < layer.size; ++n) {
+            float acc = 0.0f;
+            for (const Synapse& syn : layer.synapses[n]) {
+                const float product = syn.w * in[syn.idx];
+                acc = acc + product;
+            }
+            out[n] = Activate(layer.act, acc);
+        }
+        in = out;
+        out = buf[(li + 1) & 1];
+    }
+    memcpy(outputs, in, OUTPUTS * sizeof(float));
+}
+
+void NeuralLeadNet::ActivationProbes(std::vector<std::vector<float>>& probes) const
+{
+    // Every value of each input, the others held at zero
+    for (int k = 0; k < INPUTS; ++k) {
+        for (int v = 1; v <= 256; ++v) {
+            probes.emplace_back(INPUTS, 0.0f);
+            probes.back()[k] = (float)v;
+        }
+    }
+    if (layers.empty() || layers[0].act != Activation::EVEN_XOR_NOT) return;
+
+    // Every neuron driven through its strongest input onto the integer and
+    // half-integer boundaries of the activation, up to the largest sum that
+    // inputs in [1, 256] can reach
+    const Layer& layer = layers[0];
+    for (const std::vector<Synapse>& syns : layer.synapses) {
+        float w[INPUTS] = {};
+        double bound = 0;
+        for (const Synapse& syn : syns) {
+            w[syn.idx] += syn.w;
+            bound += std::fabs(syn.w) * 256.0;
+        }
+        const int k = std::max_element(w, w + INPUTS, [](float a, float b) { return std::fabs(a) < std::fabs(b); }) - w;
+        if (w[k] == 0.0f) continue;
+
+        std::vector<float> targets;
+        const auto add = [&](float t) {
+            if (std::fabs(t) > bound) return;
+            targets.push_back(t);
+            targets.push_back(std::nextafter(t, -INFINITY));
+            targets.push_back(std::nextafter(t, INFINITY));
+        };
+        for (int m = -64; m <= 64; ++m) {
+            add((float)m);
+            add(m + 0.5f);
+        }
+        for (double t = 128; t <= bound; t *= 2) {
+            for (float sign : {1.0f, -1.0f}) {
+                add(sign * (float)t);
+                add(sign * (float)(t + 0.5));
+                add(sign * (float)(t + 1));
+            }
+        }
+        for (float sign : {1.0f, -1.0f}) {
+            for (float t : {8388607.5f, 16777215.0f, 16777216.0f, 16777218.0f}) {
+                add(sign * t);
+            }
+        }
+        for (float t : targets) {
+            probes.emplace_back(INPUTS, 0.0f);
+            probes.back()[k] = t / w[k];
+        }
+    }
+}
+
+namespace {
+
+std::unique_ptr<NeuralLeadNet> g_net;
+std::atomic<int> g_backend{(int)NeuralNetBackend::RUNTIME};
+
+bool MatchesRuntime(const NeuralLeadNet& net, bool strict, const float* probe)
+{
+    float inputs[32], expected[8], got[8];
+    memcpy(inputs, probe, NeuralLeadNet::INPUTS * sizeof(float));
+    neuralNetwork(inputs, expected);
+    if (strict) {
+        net.RunStrict(inputs, got);
+    } else {
+        net.Run(inputs, got);
+    }
+    return memcmp(expected, got, NeuralLeadNet::OUTPUTS * sizeof(float)) == 0;
+}
+
+/** Inputs the native backends must reproduce before being enabled: random
+ * state bytes, plus probes covering the domain of the first layer's
+ * activation, whose definition lives in the runtime. */
+bool MatchesRuntime(const NeuralLeadNet& net, bool strict)
+{
+    // Inputs are state bytes + 1, as produced by InputsIntToNeuralLead()
+    uint32_t x = 0x6a09e667;
+    for (int i = 0; i < 256; ++i) {
+        float inputs[32];
+        for (int k = 0; k < 32; ++k) {
+            x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+            inputs[k] = i == 0 ? 1.0f : i == 1 ? 256.0f : (float)(x & 0xff) + 1.0f;
+        }
+        if (!MatchesRuntime(net, strict, inputs)) return false;
+    }
+
+    std::vector<std::vector<float>> probes;
+    net.ActivationProbes(probes);
+    for (const std::vector<float>& probe : probes) {
+        if (!MatchesRuntime(net, strict, probe.data())) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool NeuralNetBackendFromName(const std::string& name, NeuralNetBackend& backend)
+{
+    if (name == "native") {
+        backend = NeuralNetBackend::NATIVE;
+    } else if (name == "native-strict") {
+        backend = NeuralNetBackend::NATIVE_STRICT;
+    } else if (name == "runtime") {
+        backend = NeuralNetBackend::RUNTIME;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool SetNeuralNetBackend(NeuralNetBackend backend, const std::vector<NeuralLeadNet::LayerSpec>& layers, std::string& error)
+{
+    if (backend == NeuralNetBackend::RUNTIME) {
+        g_backend = (int)backend;
+        return true;
+    }
+
+    std::unique_ptr<NeuralLeadNet> net(new NeuralLeadNet());
+    if (!net->Load(layers, error)) {
+        g_backend = (int)NeuralNetBackend::RUNTIME;
+        return false;
+    }
+    if (!MatchesRuntime(*net, backend == NeuralNetBackend::NATIVE_STRICT)) {
+        error = "native evaluator does not reproduce the neural network runtime";
+        g_backend = (int)NeuralNetBackend::RUNTIME;
+        return false;
+    }
+    g_net = std::move(net);
+    g_backend = (int)backend;
+    return true;
+}
+
+void EvaluateNeuralNetwork(float inputs[32], float outputs[8])
+{
+    switch ((NeuralNetBackend)g_backend.load(std::memory_order_acquire)) {
+    case NeuralNetBackend::NATIVE:
+        g_net->Run(inputs, outputs);
+        return;
+    case NeuralNetBackend::NATIVE_STRICT:
+        g_net->RunStrict(inputs, outputs);
+        return;
+    case NeuralNetBackend::RUNTIME:
+        break;
+    }
+    neuralNetwork(inputs, outputs);
+}
+
+NeuralNetBackend GetNeuralNetBackend()
+{
+    return (NeuralNetBackend)g_backend.load();
+}
+
+std::string NeuralNetBackendName()
+{
+    switch ((NeuralNetBackend)g_backend.load()) {
+    case NeuralNetBackend::NATIVE: return "native";
+    case NeuralNetBackend::NATIVE_STRICT: return "native-strict";
+    case NeuralNetBackend::RUNTIME: break;
+    }
+    return "runtime";
+}
@@ -0,0 +1,106 @@
+// Copyright (c) 2024 The NeuralLead developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_CRYPTO_NEURALLEADNET_H
+#define BITCOIN_CRYPTO_NEURALLEADNET_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/** Native forward pass of the neuralleadhash network (InputTo -> s1 -> to).
+ *
+ * The weights are read once from the *.coscienza.brain files, outside of the
+ * crypto library (see ReadNeuralLeadNetLayers()), and packed in
+ * blocks of LANES neurons, so that a block is evaluated with one vector
+ * accumulator per synapse step. Every neuron still sums its synapses one at
+ * a time in file order, which keeps Run() bit-identical to RunStrict().
+ */
+class NeuralLeadNet
+{
+public:
+    static const int INPUTS = 32;
+    static const int OUTPUTS = 5;
+    static const int LANES = 4;
+
+    enum class Activation { SIGMOID, EVEN_XOR_NOT };
+
+    struct Synapse {
+        uint32_t idx;
+        float w;
+    };
+
+    /** A group of the network as read from its brain file: per neuron, its
+     * synapses from the previous group in file order. */
+    struct LayerSpec {
+        Activation act;
+        std::vector<std::vector<Synapse>> synapses;
+    };
+
+    /** Load the s1 and to groups, fed by the INPUTS neurons of InputTo. */
+    bool Load(const std::vector<LayerSpec>& specs, std::string& error);
+    bool IsLoaded() const { return !layers.empty(); }
+
+    /** Vectorized evaluation. */
+    void Run(const float inputs[INPUTS], float outputs[OUTPUTS]) const;
+    /** Scalar evaluation, one neuron and one synapse at a time in file order. */
+    void RunStrict(const float inputs[INPUTS], float outputs[OUTPUTS]) const;
+    /** Append inputs that drive the first layer across the domain of its
+     * activation, so that SetNeuralNetBackend() can compare it with the
+     * runtime's own definition rather than on random inputs only. */
+    void ActivationProbes(std::vector<std::vector<float>>& probes) const;
+
+private:
+    struct alignas(32) Step {
+        float w[LANES];
+        uint32_t idx[LANES];
+    };
+
+    struct Layer {
+        Activation act;
+        uint32_t size;
+        /** Packed blocks, steps[block_begin[b] .. block_begin[b+1]). */
+        std::vector<Step> steps;
+        std::vector<uint32_t> block_begin;
+        /** Per neuron synapses in file order, for RunStrict(). */
+        std::vector<std::vector<Synapse>> synapses;
+    };
+
+    std::vector<Layer> layers;
+    uint32_t max_size = 0;
+
+    static float Activate(Activation act, float x);
+    bool LoadLayer(const LayerSpec& spec, uint32_t prev_size, std::string& error);
+};
+
+/** Neural network implementations selectable for the QHash neural stage. */
+enum class NeuralNetBackend {
+    RUNTIME,       //!< neuralNetwork() of the NeuralLeadQHash library
+    NATIVE,        //!< NeuralLeadNet::Run()
+    NATIVE_STRICT, //!< NeuralLeadNet::RunStrict()
+};
+
+/** Default for -qhashnn. The native backends are opt-in until they are checked
+ * against the runtime on chain data, a divergence would fork the node off. */
+static const char* const DEFAULT_NEURALNET_BACKEND = "runtime";
+
+/** Parse a backend name as accepted by -qhashnn. */
+bool NeuralNetBackendFromName(const std::string& name, NeuralNetBackend& backend);
+
+/** Select the implementation used by compress(). The native backends load
+ * the network from layers and are only enabled if they reproduce neuralNetwork()
+ * on random inputs and on ActivationProbes(); on failure the runtime stays in use and false is
+ * returned. Must be called before any hashing threads are started. */
+bool SetNeuralNetBackend(NeuralNetBackend backend, const std::vector<NeuralLeadNet::LayerSpec>& layers, std::string& error);
+
+/** The selected backend. */
+NeuralNetBackend GetNeuralNetBackend();
+
+/** Evaluate the network through the selected backend. */
+void EvaluateNeuralNetwork(float inputs[32], float outputs[8]);
+
+/** Name of the selected backend, for logging. */
+std::string NeuralNetBackendName();
+
+#endif // BITCOIN_CRYPTO_NEURALLEADNET_H
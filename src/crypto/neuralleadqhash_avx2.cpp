@@ -0,0 +1,120 @@
+// Copyright (c) 2017-2019 The Bitcoin Core developers
+// Copyright (c) 2024 SimonJRiddix & NeuralLead
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// 8-way AVX2 version of the NeuralLeadQHash message expansion and integer rounds.
+// Must stay bit-identical to compressRounds() in neuralleadqhash_interface.cpp.
+
+#ifdef ENABLE_AVX2
+
+#include <stdint.h>
+#include <immintrin.h>
+
+#include <crypto/common.h>
+#include <crypto/cryptoconf.h>
+
+namespace nlqhash_avx2 {
+namespace {
+
+__m256i inline K(uint32_t x) { return _mm256_set1_epi32(x); }
+
+__m256i inline Add(__m256i x, __m256i y) { return _mm256_add_epi32(x, y); }
+__m256i inline Add(__m256i x, __m256i y, __m256i z) { return Add(Add(x, y), z); }
+__m256i inline Add(__m256i x, __m256i y, __m256i z, __m256i w) { return Add(Add(x, y), Add(z, w)); }
+__m256i inline Add(__m256i x, __m256i y, __m256i z, __m256i w, __m256i v) { return Add(Add(x, y, z), Add(w, v)); }
+__m256i inline Xor(__m256i x, __m256i y) { return _mm256_xor_si256(x, y); }
+__m256i inline Xor(__m256i x, __m256i y, __m256i z) { return Xor(Xor(x, y), z); }
+__m256i inline Or(__m256i x, __m256i y) { return _mm256_or_si256(x, y); }
+__m256i inline And(__m256i x, __m256i y) { return _mm256_and_si256(x, y); }
+__m256i inline ShR(__m256i x, int n) { return _mm256_srli_epi32(x, n); }
+__m256i inline ShL(__m256i x, int n) { return _mm256_slli_epi32(x, n); }
+__m256i inline RotR(__m256i x, int n) { return Or(ShR(x, n), ShL(x, 32 - n)); }
+__m256i inline RotL(__m256i x, int n) { return Or(ShL(x, n), ShR(x, 32 - n)); }
+
+__m256i inline Ch(__m256i x, __m256i y, __m256i z) { return Xor(z, And(x, Xor(y, z))); }
+__m256i inline Maj(__m256i x, __m256i y, __m256i z) { return Or(And(x, y), And(z, Or(x, y))); }
+__m256i inline Sigma0(__m256i x) { return Xor(RotR(x, 2), RotR(x, 13), RotR(x, 22)); }
+__m256i inline Sigma1(__m256i x) { return Xor(RotR(x, 6), RotR(x, 11), RotR(x, 25)); }
+__m256i inline sigma0(__m256i x) { return Xor(RotR(x, 7), RotR(x, 18), ShR(x, 3)); }
+__m256i inline sigma1(__m256i x) { return Xor(RotR(x, 17), RotR(x, 19), ShR(x, 10)); }
+
+/** Lane-wise improvedMix(). */
+void inline Mix(__m256i& a, __m256i& b, __m256i& c, __m256i& d)
+{
+    a = Xor(RotL(a, 13), b);
+    b = Add(RotR(b, 7), c);
+    c = Xor(RotL(c, 17), d);
+    d = Add(RotR(d, 11), a);
+}
+
+__m256i inline Read8(const unsigned char* const* blocks, int offset)
+{
+    return _mm256_set_epi32(ReadBE32(blocks[7] + offset), ReadBE32(blocks[6] + offset), ReadBE32(blocks[5] + offset), ReadBE32(blocks[4] + offset),
+                            ReadBE32(blocks[3] + offset), ReadBE32(blocks[2] + offset), ReadBE32(blocks[1] + offset), ReadBE32(blocks[0] + offset));
+}
+
+__m256i inline Load8(const uint32_t* lanes, int stride, int offset)
+{
+    return _mm256_set_epi32(lanes[7 * stride + offset], lanes[6 * stride + offset], lanes[5 * stride + offset], lanes[4 * stride + offset],
+                            lanes[3 * stride + offset], lanes[2 * stride + offset], lanes[stride + offset], lanes[offset]);
+}
+
+void inline Store8(uint32_t* lanes, int stride, int offset, __m256i x)
+{
+    alignas(32) uint32_t tmp[8];
+    _mm256_store_si256((__m256i*)tmp, x);
+    for (int l = 0; l < 8; ++l) {
+        lanes[l * stride + offset] = tmp[l];
+    }
+}
+
+}
+
+void Rounds_8way(uint32_t* v, uint32_t* w63, const uint32_t* state, const unsigned char* const* blocks, const uint32_t* quantum_mix)
+{
+    __m256i w[64];
+
+    // Message expansion
+    for (int i = 0; i < 16; ++i) {
+        w[i] = Read8(blocks, i * 4);
+    }
+    for (int i = 16; i < 64; ++i) {
+        w[i] = Add(w[i - 16], sigma0(w[i - 15]), w[i - 7], sigma1(w[i - 2]));
+    }
+
+    const __m256i qm = Load8(quantum_mix, 1, 0);
+
+    __m256i a = Load8(state, 8, 0), b = Load8(state, 8, 1), c = Load8(state, 8, 2), d = Load8(state, 8, 3);
+    __m256i e = Load8(state, 8, 4), f = Load8(state, 8, 5), g = Load8(state, 8, 6), h = Load8(state, 8, 7);
+
+    for (int round = 0; round < 4; ++round) {
+        const __m256i S1 = Sigma1(e);
+        const __m256i ch = Ch(e, f, g);
+        const __m256i temp2 = Add(Sigma0(a), Maj(a, b, c));
+
+        for (int pii = 0; pii < 16; pii++) {
+            const int ri = pii * round;
+            const __m256i temp1 = Xor(Add(h, S1, ch, K(roundKeys[ri]), w[ri]), qm);
+            h = g;
+            g = f;
+            f = e;
+            e = Add(d, temp1);
+            d = c;
+            c = b;
+            b = a;
+            a = Add(temp1, temp2);
+        }
+
+        Mix(a, b, c, d);
+        Mix(e, f, g, h);
+    }
+
+    Store8(v, 8, 0, a); Store8(v, 8, 1, b); Store8(v, 8, 2, c); Store8(v, 8, 3, d);
+    Store8(v, 8, 4, e); Store8(v, 8, 5, f); Store8(v, 8, 6, g); Store8(v, 8, 7, h);
+    Store8(w63, 1, 0, w[63]);
+}
+
+}
+
+#endif
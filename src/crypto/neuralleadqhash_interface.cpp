@@ -106,11 +106,35 @@ bool dir_exists(const char* folder)
 #include <util/strencodings.h>
 
 #include <crypto/cryptoconf.h>
+#include <crypto/neuralleadnet.h>
 #include <crypto/sha512.h>
 #include <iostream>
 #include <fstream>
 #include <vector>
 
+#if defined(ENABLE_SSE41) && !defined(BUILD_BITCOIN_INTERNAL)
+namespace nlqhash_sse41
+{
+void Rounds_4way(uint32_t* v, uint32_t* w63, const uint32_t* state, const unsigned char* const* blocks, const uint32_t* quantum_mix);
+}
+#endif
+
+#if defined(ENABLE_AVX2) && !defined(BUILD_BITCOIN_INTERNAL)
+namespace nlqhash_avx2
+{
+void Rounds_8way(uint32_t* v, uint32_t* w63, const uint32_t* state, const unsigned char* const* blocks, const uint32_t* quantum_mix);
+}
+#endif
+
+#if !defined(_WIN32) && !defined(_WIN64) && !defined(__MINGW32__)
+// Lane-parallel double transforms, defined with the Quantum & Neural Network functions below.
+namespace nlqhash_lanes
+{
+void TransformD64_4way(unsigned char* out, const unsigned char* in);
+void TransformD64_8way(unsigned char* out, const unsigned char* in);
+}
+#endif
+
 namespace
 {
     namespace sha256
@@ -127,58 +151,56 @@ namespace
             s[7] = 0x510e527ful;
         }
 
+        /** Mix the chaining state into a 64-byte transform input (aiai step of Transform). */
+        void inline AddState(uint8_t* aiai, const uint32_t* s)
+        {
+            uint8_t hhh[4];
+            for(int u = 0, a = 0; a < 64; u++, a+=4)
+            {
+                WriteBE32(hhh, s[u%8]);
+
+                aiai[a]   += hhh[0];
+                aiai[a+1] += hhh[1];
+                aiai[a+2] += hhh[2];
+                aiai[a+3] += hhh[3];
+            }
+        }
+
+        /** Feed a DirectComputeHash result back into the chaining state. */
+        void inline AddHash(uint32_t* s, const uint8_t* oioi)
+        {
+            s[0] += ReadBE32(oioi);
+            s[1] += ReadBE32(oioi + 4);
+            s[2] += ReadBE32(oioi + 8);
+            s[3] += ReadBE32(oioi + 12);
+            s[4] += ReadBE32(oioi + 16);
+            s[5] += ReadBE32(oioi + 20);
+            s[6] += ReadBE32(oioi + 24);
+            s[7] += ReadBE32(oioi + 28);
+        }
+
         void Transform(uint32_t* s, const unsigned char* chunk, size_t blocks)
         {
-            uint8_t* aiai = (uint8_t*) malloc(64);
-            if(aiai==nullptr)
-                std::runtime_error("memory error");
+            // Only the first chunk is read, further blocks keep mixing the state into the same input
+            uint8_t aiai[64];
+            uint8_t oioi[32];
             memcpy(aiai, chunk, 64);
 
-            uint8_t* oioi = (uint8_t*) malloc(32);
-            if(oioi==nullptr)
-                std::runtime_error("memory error");
-            
-            uint8_t* hhh = (uint8_t*) malloc(4);
-            if(hhh==nullptr)
-                std::runtime_error("memory error");
-
             while (blocks--)
             {
-                for(int u = 0, a = 0; a < 64; u++, a+=4)
-                {
-                    WriteBE32(hhh, s[u%8]);
-                    
-                    aiai[a]   += hhh[0];
-                    aiai[a+1] += hhh[1];
-                    aiai[a+2] += hhh[2];
-                    aiai[a+3] += hhh[3];
-                }
-                
-                DirectComputeHash(aiai, 64, oioi);
-
-                s[0] += ReadBE32(oioi);
-                s[1] += ReadBE32(oioi + 4);
-                s[2] += ReadBE32(oioi + 8);
-                s[3] += ReadBE32(oioi + 12);
-                s[4] += ReadBE32(oioi + 16);
-                s[5] += ReadBE32(oioi + 20);
-                s[6] += ReadBE32(oioi + 24);
-                s[7] += ReadBE32(oioi + 28);
-                chunk += 64;
+                AddState(aiai, s);
+#if defined(_WIN32) || defined(_WIN64) || defined(__MINGW32__)
+                uint8_t* hash_output = oioi;
+                DirectComputeHash(aiai, 64, hash_output);
+#else
+                DirectComputeHash64(aiai, oioi);
+#endif
+                AddHash(s, oioi);
             }
-
-            free(aiai);
-            free(oioi);
-            free(hhh);
         }
 
-        void TransformD64(unsigned char* out, const unsigned char* in)
+        void inline WriteD64(unsigned char* out, const uint32_t* s)
         {
-            uint32_t s[8];
-            Initialize(s);
-            Transform(s, in, 2);
-
-            // Output
             WriteBE32(out + 0,  s[0] + 0x6a09e667ul);
             WriteBE32(out + 4,  s[1] + 0xbb67ae85ul);
             WriteBE32(out + 8,  s[2] + 0x3c6ef372ul);
@@ -189,6 +211,16 @@ namespace
             WriteBE32(out + 28, s[7] + 0x5be0cd19ul);
         }
 
+        void TransformD64(unsigned char* out, const unsigned char* in)
+        {
+            uint32_t s[8];
+            Initialize(s);
+            Transform(s, in, 2);
+
+            // Output
+            WriteD64(out, s);
+        }
+
     } // namespace sha256
 
 typedef void (*TransformType)(uint32_t*, const unsigned char*, size_t);
@@ -196,6 +228,8 @@ typedef void (*TransformD64Type)(unsigned char*, const unsigned char*);
 
 TransformType Transform = sha256::Transform;
 TransformD64Type TransformD64 = sha256::TransformD64;
+TransformD64Type TransformD64_4way = nullptr;
+TransformD64Type TransformD64_8way = nullptr;
 
 bool SelfTest()
 {
@@ -269,14 +303,66 @@ bool SelfTest()
 
     return true;
 }
+
+#if defined(USE_ASM) && defined(HAVE_GETCPUID)
+/** Check whether the OS has enabled AVX registers. */
+bool AVXEnabled()
+{
+    uint32_t a, d;
+    __asm__("xgetbv" : "=a"(a), "=d"(d) : "c"(0));
+    return (a & 6) == 6;
+}
+#endif
 } // namespace
 
 
 std::string SHA256AutoDetect()
 {
     assert(SelfTest());
-    
-    return "NeuralLeadHash";
+
+    std::string ret = "NeuralLeadHash";
+#if defined(USE_ASM) && defined(HAVE_GETCPUID) && !defined(_WIN32) && !defined(_WIN64) && !defined(__MINGW32__)
+    bool have_sse4 = false;
+    bool have_xsave = false;
+    bool have_avx = false;
+    bool have_avx2 = false;
+    bool enabled_avx = false;
+
+    (void)have_sse4;
+    (void)have_xsave;
+    (void)have_avx;
+    (void)have_avx2;
+    (void)enabled_avx;
+
+    uint32_t eax, ebx, ecx, edx;
+    GetCPUID(1, 0, eax, ebx, ecx, edx);
+    have_sse4 = (ecx >> 19) & 1;
+    have_xsave = (ecx >> 27) & 1;
+    have_avx = (ecx >> 28) & 1;
+    if (have_xsave && have_avx) {
+        enabled_avx = AVXEnabled();
+    }
+    if (have_sse4) {
+        GetCPUID(7, 0, eax, ebx, ecx, edx);
+        have_avx2 = (ebx >> 5) & 1;
+    }
+
+#if defined(ENABLE_SSE41) && !defined(BUILD_BITCOIN_INTERNAL)
+    if (have_sse4) {
+        TransformD64_4way = nlqhash_lanes::TransformD64_4way;
+        ret += ",sse41(4way)";
+    }
+#endif
+
+#if defined(ENABLE_AVX2) && !defined(BUILD_BITCOIN_INTERNAL)
+    if (have_avx2 && have_avx && enabled_avx) {
+        TransformD64_8way = nlqhash_lanes::TransformD64_8way;
+        ret += ",avx2(8way)";
+    }
+#endif
+#endif
+
+    return ret;
 }
 
 NeuralLeadQHash_iface::NeuralLeadQHash_iface(bool UseGPU) : bytes(0)
@@ -337,6 +423,22 @@ NeuralLeadQHash_iface& NeuralLeadQHash_iface::Reset()
 
 void SHA256D64(unsigned char* out, const unsigned char* in, size_t blocks)
 {
+    if (TransformD64_8way) {
+        while (blocks >= 8) {
+            TransformD64_8way(out, in);
+            out += 256;
+            in += 512;
+            blocks -= 8;
+        }
+    }
+    if (TransformD64_4way) {
+        while (blocks >= 4) {
+            TransformD64_4way(out, in);
+            out += 128;
+            in += 256;
+            blocks -= 4;
+        }
+    }
     while (blocks) {
         sha256::TransformD64(out, in);
         out += 32;
@@ -415,14 +517,10 @@ void mixBetweenBlocks(uint32_t state[8])
     improvedMix(state[4], state[5], state[6], state[7]);
 }
 
-// Improved compression function
-void compress(uint32_t state[8], const uint8_t* block, uint32_t& quantum_mix, bool useNL)
+// Message expansion and integer rounds of compress(), producing the working variables a..h in v
+// and the last schedule word used by the quantum step. Mirrored lane-wise by the SSE4.1/AVX2 kernels.
+void inline compressRounds(const uint32_t state[8], const uint8_t* block, uint32_t quantum_mix, uint32_t v[8], uint32_t& w63)
 {
-    thread_local const Gates& insta = Gates::get_thread_local_instance();
-
-    thread_local auto& prng = RandomDevices::get_thread_local_instance();
-    prng.get_prng().seed(accumulated_seed);
-
     uint32_t w[64];
 
     // Message expansion
@@ -471,28 +569,135 @@ void compress(uint32_t state[8], const uint8_t* block, uint32_t& quantum_mix, bo
         improvedMix(e, f, g, h);
     }
 
-    if (useNL)  // NeuralLead Update
+    v[0] = a; v[1] = b; v[2] = c; v[3] = d;
+    v[4] = e; v[5] = f; v[6] = g; v[7] = h;
+    w63 = w[63];
+}
+
+// NeuralLead update of compress(), only run for neural-gated blocks
+void inline compressNeural(uint32_t state[8], uint32_t v[8])
+{
+    state[0] += v[0]; state[1] += v[1]; state[2] += v[2]; state[3] += v[3];
+    state[4] += v[4]; state[5] += v[5]; state[6] += v[6]; state[7] += v[7];
+
+    float nn_inputs[32];
+    float nn_outputs[8];
+
+    InputsIntToNeuralLead(state, nn_inputs);
+
+    EvaluateNeuralNetwork(nn_inputs, nn_outputs);
+
+    // Mescolamento intermedio dello stato con rete neurallead prima della compressione quantistica
+    for (int i = 1; i < 10; ++i)
     {
-        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
-        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+        state[i % 8] ^= static_cast<uint32_t>(nn_outputs[i % NL_OUTPUTS] * 1000.0f) ^ roundKeys[i] ^ state[(i - 1) % 8];
+    }
 
-        float nn_inputs[32];
-        float nn_outputs[8];
+    memcpy(v, state, 8 * sizeof(uint32_t));
+}
+
+uint32_t QuantumMixReference(const uint32_t v[8])
+{
+    thread_local const Gates& insta = Gates::get_thread_local_instance();
+
+    thread_local auto& prng = RandomDevices::get_thread_local_instance();
+    prng.get_prng().seed(accumulated_seed);
 
-        InputsIntToNeuralLead(state, nn_inputs);
+    uint32_t a = v[0], b = v[1], c = v[2], d = v[3];
+    uint32_t e = v[4], f = v[5], g = v[6], h = v[7];
 
-        neuralNetwork(nn_inputs, nn_outputs);
+    ket qubits = 00_ket;  // Stato iniziale |00>
 
-        // Mescolamento intermedio dello stato con rete neurallead prima della compressione quantistica
-        for (int i = 1; i < 10; ++i)
-        {
-            state[i % 8] ^= static_cast<uint32_t>(nn_outputs[i % NL_OUTPUTS] * 1000.0f) ^ roundKeys[i] ^ state[(i - 1) % 8];
-        }
+    // Quantum operations
+
+    qubits = kron(insta.H, insta.H) * qubits;
 
-        a = state[0], b = state[1], c = state[2], d = state[3];
-        e = state[4], f = state[5], g = state[6], h = state[7];
+    // Apply controlled rotations
+    qubits = apply(qubits, insta.RZ(normalize_uint32_t(a ^ e)), { 0 });
+    qubits = apply(qubits, insta.RX(normalize_uint32_t(b ^ f)), { 1 });
+    qubits = apply(qubits, insta.RY(normalize_uint32_t(c ^ g)), { 0 });
+    qubits = apply(qubits, insta.RZ(normalize_uint32_t(d ^ h)), { 1 });
+
+    // Apply CNOT gates
+    qubits = apply(qubits, insta.CNOT, { 0, 1 });
+
+    // Measure all qubits
+    auto [m, probs, states] = measure(qubits, insta.Id(1 << NUM_QUBITS));
+
+    uint32_t quantum_mix = denormalize_uint32_t(probs[0]);
+
+    auto dx = denormalize_uint32_t(states[0].x().real());
+    auto dx_i = denormalize_uint32_t(states[0].x().imag());
+    quantum_mix ^= dx;
+    quantum_mix ^= dx_i;
+
+    auto dy = denormalize_uint32_t(states[0].y().real());
+    auto dy_i = denormalize_uint32_t(states[0].y().imag());
+    quantum_mix ^= dy;
+    quantum_mix ^= dy_i;
+
+    return quantum_mix;
+}
+
+uint32_t QuantumMix(const uint32_t v[8])
+{
+    // Every floating point operation below is the one qpp performs on the non-zero amplitudes, in the
+    // same order, so the result is bit-identical to QuantumMixReference(). Products with the zero
+    // entries of the gates are exact and left out.
+
+    // H⊗H|00>: four equal real amplitudes (1/sqrt(2))^2
+    const double r = 1 / std::sqrt(2.);
+    const double q = r * r;
+
+    const double t1 = normalize_uint32_t(v[0] ^ v[4]);
+    const double t2 = normalize_uint32_t(v[1] ^ v[5]);
+    const double t3 = normalize_uint32_t(v[2] ^ v[6]);
+    const double t4 = normalize_uint32_t(v[3] ^ v[7]);
+
+    const double c1 = std::cos(t1 / 2), s1 = std::sin(t1 / 2);
+    const double c2 = std::cos(t2 / 2), s2 = std::sin(t2 / 2);
+    const double c3 = std::cos(t3 / 2), s3 = std::sin(t3 / 2);
+    const double c4 = std::cos(t4 / 2), s4 = std::sin(t4 / 2);
+
+    // RZ on qubit 0: |00>,|01> = A - iB, |10>,|11> = A + iB
+    const double A = c1 * q;
+    const double B = s1 * q;
+
+    // RX on qubit 1: |00>,|01> = P + iQ, |10>,|11> = R + iS
+    const double P = c2 * A - s2 * B;
+    const double Q = -(c2 * B + s2 * A);
+    const double R = c2 * A + s2 * B;
+    const double S = c2 * B - s2 * A;
+
+    // RY on qubit 0: |00>,|01> = Tr + iTi (|10>,|11> do not reach the measured outcome)
+    const double Tr = c3 * P - s3 * R;
+    const double Ti = c3 * Q - s3 * S;
+
+    // RZ on qubit 1, |00> amplitude only; the CNOT does not move it
+    const double x = c4 * Tr + s4 * Ti;
+    const double y = c4 * Ti - s4 * Tr;
+
+    // Projection on |00>: probability and normalized post-measurement amplitude. The |01> amplitude
+    // of that state is always zero and does not change the mix.
+    const double prob = std::pow(std::sqrt(x * x + y * y), 2);
+
+    uint32_t quantum_mix = denormalize_uint32_t(prob);
+    if (prob > 0)
+    {
+        const double norm = std::sqrt(prob);
+        quantum_mix ^= denormalize_uint32_t(x / norm);
+        quantum_mix ^= denormalize_uint32_t(y / norm);
     }
 
+    return quantum_mix;
+}
+
+// Quantum round and final state update of compress()
+void inline compressQuantum(uint32_t state[8], const uint32_t v[8], uint32_t w63, uint32_t& quantum_mix)
+{
+    uint32_t a = v[0], b = v[1], c = v[2], d = v[3];
+    uint32_t e = v[4], f = v[5], g = v[6], h = v[7];
+
     {
         // Quantum algo
 
@@ -504,37 +709,9 @@ void compress(uint32_t state[8], const uint8_t* block, uint32_t& quantum_mix, bo
         uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
         uint32_t temp2 = S0 + maj;
 
-        ket qubits = 00_ket;  // Stato iniziale |00>
-
-        // Quantum operations
-
-        qubits = kron(insta.H, insta.H) * qubits;
-
-        // Apply controlled rotations
-        qubits = apply(qubits, insta.RZ(normalize_uint32_t(a ^ e)), { 0 });
-        qubits = apply(qubits, insta.RX(normalize_uint32_t(b ^ f)), { 1 });
-        qubits = apply(qubits, insta.RY(normalize_uint32_t(c ^ g)), { 0 });
-        qubits = apply(qubits, insta.RZ(normalize_uint32_t(d ^ h)), { 1 });
-
-        // Apply CNOT gates
-        qubits = apply(qubits, insta.CNOT, { 0, 1 });
-
-        // Measure all qubits
-        auto [m, probs, states] = measure(qubits, insta.Id(1 << NUM_QUBITS));
-
-        quantum_mix ^= denormalize_uint32_t(probs[0]);
-
-        auto dx = denormalize_uint32_t(states[0].x().real());
-        auto dx_i = denormalize_uint32_t(states[0].x().imag());
-        quantum_mix ^= dx;
-        quantum_mix ^= dx_i;
-
-        auto dy = denormalize_uint32_t(states[0].y().real());
-        auto dy_i = denormalize_uint32_t(states[0].y().imag());
-        quantum_mix ^= dy;
-        quantum_mix ^= dy_i;
+        quantum_mix ^= QuantumMix(v);
 
-        uint32_t temp1 = (h + S1 + ch + roundKeys[63] + w[63]) ^ quantum_mix;
+        uint32_t temp1 = (h + S1 + ch + roundKeys[63] + w63) ^ quantum_mix;
         h = g;
         g = f;
         f = e;
@@ -554,6 +731,22 @@ void compress(uint32_t state[8], const uint8_t* block, uint32_t& quantum_mix, bo
     state[4] += e; state[5] += f; state[6] += g; state[7] += h;
 }
 
+// Improved compression function
+void compress(uint32_t state[8], const uint8_t* block, uint32_t& quantum_mix, bool useNL)
+{
+    uint32_t v[8];
+    uint32_t w63;
+
+    compressRounds(state, block, quantum_mix, v, w63);
+
+    if (useNL)  // NeuralLead Update
+    {
+        compressNeural(state, v);
+    }
+
+    compressQuantum(state, v, w63, quantum_mix);
+}
+
 // Main hash function
 DLL_API_NLHASH ComputeStatus DirectComputeHash(const uint8_t* data, size_t length, uint8_t*& hash_output)
 {
@@ -563,25 +756,28 @@ DLL_API_NLHASH ComputeStatus DirectComputeHash(const uint8_t* data, size_t lengt
         0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
     };
 
-    // Pre-processing
+    // Pre-processing: whole blocks are compressed straight from data, only the tail is padded
     size_t padded_length = ((length + 9 + 63) / 64) * 64;
-    std::vector<uint8_t> padded_data(padded_length, 0);
-    memcpy(padded_data.data(), data, length);
-    //padded_data[length -1] &= 0x80;
+    size_t direct_length = length & ~size_t{63};
+    size_t tail_length = padded_length - direct_length;
+    uint8_t tail[128] = {0};
+    if (length > direct_length)
+        memcpy(tail, data + direct_length, length - direct_length);
 
     uint64_t bit_len = length * 8;
     for (int i = 0; i < 8; ++i)
     {
-        padded_data[padded_length - 1 - i] = static_cast<uint8_t>((bit_len >> (i * 8)) & 0xFF);
+        tail[tail_length - 1 - i] = static_cast<uint8_t>((bit_len >> (i * 8)) & 0xFF);
     }
 
     uint32_t quantum_mix = 0;
 
     // Process each block
     for (size_t i = 0; i < padded_length; i += 64)
-    {        
-        bool useNL = ((padded_data[i] + length) % 5 == 0);
-        compress(state, &padded_data[i], quantum_mix, useNL);
+    {
+        const uint8_t* block = i < direct_length ? data + i : tail + (i - direct_length);
+        bool useNL = ((block[0] + length) % 5 == 0);
+        compress(state, block, quantum_mix, useNL);
         mixBetweenBlocks(state);  // Additional mixing between blocks
     }
 
@@ -598,6 +794,140 @@ DLL_API_NLHASH ComputeStatus DirectComputeHash(const uint8_t* data, size_t lengt
     return ComputeStatus::HASH_SUCCESS;
 }
 
+// Lane-parallel hashing of independent 64-byte blobs
+
+typedef void (*RoundsNwayType)(uint32_t*, uint32_t*, const uint32_t*, const unsigned char* const*, const uint32_t*);
+
+// Second padded block of a 64-byte message: no end marker, big-endian bit length 512
+static const uint8_t PADDING_64[64] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x02, 0
+};
+
+// DirectComputeHash(data, 64, hash_output) without the generic padding setup
+void DirectComputeHash64(const uint8_t* data, uint8_t* hash_output)
+{
+    uint32_t state[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+    uint32_t quantum_mix = 0;
+
+    compress(state, data, quantum_mix, (data[0] + 64) % 5 == 0);
+    mixBetweenBlocks(state);
+
+    // Padding block, never neural-gated ((0 + 64) % 5 != 0)
+    compress(state, PADDING_64, quantum_mix, false);
+    mixBetweenBlocks(state);
+
+    for (int i = 0; i < 8; ++i)
+        WriteBE32(hash_output + i * 4, state[i]);
+}
+
+// DirectComputeHash(data[l], 64, hash_output[l]) for LANES lanes at once. The integer rounds of every
+// lane run in one vector kernel call, then the neural-gated lanes and the quantum steps are processed
+// as a group before moving to the next block.
+template <size_t LANES>
+void DirectComputeHash64_Lanes(RoundsNwayType rounds, const uint8_t* const* data, uint8_t* const* hash_output)
+{
+    uint32_t state[LANES * 8];
+    uint32_t quantum_mix[LANES];
+    uint32_t v[LANES * 8];
+    uint32_t w63[LANES];
+    const unsigned char* blocks[LANES];
+
+    for (size_t l = 0; l < LANES; ++l)
+    {
+        state[l * 8 + 0] = 0x6a09e667; state[l * 8 + 1] = 0xbb67ae85;
+        state[l * 8 + 2] = 0x3c6ef372; state[l * 8 + 3] = 0xa54ff53a;
+        state[l * 8 + 4] = 0x510e527f; state[l * 8 + 5] = 0x9b05688c;
+        state[l * 8 + 6] = 0x1f83d9ab; state[l * 8 + 7] = 0x5be0cd19;
+        quantum_mix[l] = 0;
+    }
+
+    // First block: the message itself
+    rounds(v, w63, state, data, quantum_mix);
+    for (size_t l = 0; l < LANES; ++l)
+    {
+        if ((data[l][0] + 64) % 5 == 0)
+            compressNeural(&state[l * 8], &v[l * 8]);
+    }
+    for (size_t l = 0; l < LANES; ++l)
+    {
+        compressQuantum(&state[l * 8], &v[l * 8], w63[l], quantum_mix[l]);
+        mixBetweenBlocks(&state[l * 8]);
+    }
+
+    // Second block: padding only, never neural-gated ((0 + 64) % 5 != 0)
+    for (size_t l = 0; l < LANES; ++l)
+        blocks[l] = PADDING_64;
+    rounds(v, w63, state, blocks, quantum_mix);
+    for (size_t l = 0; l < LANES; ++l)
+    {
+        compressQuantum(&state[l * 8], &v[l * 8], w63[l], quantum_mix[l]);
+        mixBetweenBlocks(&state[l * 8]);
+    }
+
+    for (size_t l = 0; l < LANES; ++l)
+    {
+        for (int i = 0; i < 8; ++i)
+            WriteBE32(hash_output[l] + i * 4, state[l * 8 + i]);
+    }
+}
+
+// Lane-parallel equivalent of sha256::TransformD64. All inputs are consumed before any output is
+// written, so out may alias in as ComputeMerkleRoot does.
+template <size_t LANES>
+void TransformD64_Lanes(RoundsNwayType rounds, unsigned char* out, const unsigned char* in)
+{
+    uint32_t s[LANES * 8];
+    uint8_t aiai[LANES][64];
+    uint8_t oioi[LANES][32];
+    const uint8_t* data[LANES];
+    uint8_t* hash_output[LANES];
+
+    for (size_t l = 0; l < LANES; ++l)
+    {
+        sha256::Initialize(&s[l * 8]);
+        memcpy(aiai[l], in + 64 * l, 64);
+        data[l] = aiai[l];
+        hash_output[l] = oioi[l];
+    }
+
+    for (int blocks = 0; blocks < 2; ++blocks)
+    {
+        for (size_t l = 0; l < LANES; ++l)
+            sha256::AddState(aiai[l], &s[l * 8]);
+
+        DirectComputeHash64_Lanes<LANES>(rounds, data, hash_output);
+
+        for (size_t l = 0; l < LANES; ++l)
+            sha256::AddHash(&s[l * 8], oioi[l]);
+    }
+
+    for (size_t l = 0; l < LANES; ++l)
+        sha256::WriteD64(out + 32 * l, &s[l * 8]);
+}
+
+namespace nlqhash_lanes
+{
+#if defined(ENABLE_SSE41) && !defined(BUILD_BITCOIN_INTERNAL)
+void TransformD64_4way(unsigned char* out, const unsigned char* in)
+{
+    TransformD64_Lanes<4>(nlqhash_sse41::Rounds_4way, out, in);
+}
+#endif
+
+#if defined(ENABLE_AVX2) && !defined(BUILD_BITCOIN_INTERNAL)
+void TransformD64_8way(unsigned char* out, const unsigned char* in)
+{
+    TransformD64_Lanes<8>(nlqhash_avx2::Rounds_8way, out, in);
+}
+#endif
+} // namespace nlqhash_lanes
+
 // NeuralLead section
 // Disabled, already compiled with NeuralLead Maker, call from static/dynamic library it externally to improve speed and accurancy
 // thanks to optimizations
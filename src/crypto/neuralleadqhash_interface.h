@@ -2,8 +2,8 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
-#ifndef BITCOIN_CRYPTO_SHA256_H
-#define BITCOIN_CRYPTO_SHA256_H
+#ifndef BITCOIN_CRYPTO_NEURALLEADQHASH_INTERFACE_H
+#define BITCOIN_CRYPTO_NEURALLEADQHASH_INTERFACE_H
 
 #include <stdint.h>
 #include <stdlib.h>
@@ -20,10 +20,6 @@ private:
 
     bool _UseGPU = false;
 
-    uint8_t* aiai = nullptr;
-    uint8_t* oioi = nullptr;
-    uint8_t* hhh = nullptr;
-
 public:
     static const size_t OUTPUT_SIZE = 32;
 
@@ -45,4 +41,4 @@ std::string SHA256AutoDetect();
  */
 void SHA256D64(unsigned char* output, const unsigned char* input, size_t blocks);
 
-#endif // BITCOIN_CRYPTO_SHA256_H
+#endif // BITCOIN_CRYPTO_NEURALLEADQHASH_INTERFACE_H
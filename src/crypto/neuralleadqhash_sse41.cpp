@@ -0,0 +1,119 @@
+// Copyright (c) 2017-2019 The Bitcoin Core developers
+// Copyright (c) 2024 SimonJRiddix & NeuralLead
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// 4-way SSE4.1 version of the NeuralLeadQHash message expansion and integer rounds.
+// Must stay bit-identical to compressRounds() in neuralleadqhash_interface.cpp.
+
+#ifdef ENABLE_SSE41
+
+#include <stdint.h>
+#include <immintrin.h>
+
+#include <crypto/common.h>
+#include <crypto/cryptoconf.h>
+
+namespace nlqhash_sse41 {
+namespace {
+
+__m128i inline K(uint32_t x) { return _mm_set1_epi32(x); }
+
+__m128i inline Add(__m128i x, __m128i y) { return _mm_add_epi32(x, y); }
+__m128i inline Add(__m128i x, __m128i y, __m128i z) { return Add(Add(x, y), z); }
+__m128i inline Add(__m128i x, __m128i y, __m128i z, __m128i w) { return Add(Add(x, y), Add(z, w)); }
+__m128i inline Add(__m128i x, __m128i y, __m128i z, __m128i w, __m128i v) { return Add(Add(x, y, z), Add(w, v)); }
+__m128i inline Xor(__m128i x, __m128i y) { return _mm_xor_si128(x, y); }
+__m128i inline Xor(__m128i x, __m128i y, __m128i z) { return Xor(Xor(x, y), z); }
+__m128i inline Or(__m128i x, __m128i y) { return _mm_or_si128(x, y); }
+__m128i inline And(__m128i x, __m128i y) { return _mm_and_si128(x, y); }
+__m128i inline ShR(__m128i x, int n) { return _mm_srli_epi32(x, n); }
+__m128i inline ShL(__m128i x, int n) { return _mm_slli_epi32(x, n); }
+__m128i inline RotR(__m128i x, int n) { return Or(ShR(x, n), ShL(x, 32 - n)); }
+__m128i inline RotL(__m128i x, int n) { return Or(ShL(x, n), ShR(x, 32 - n)); }
+
+__m128i inline Ch(__m128i x, __m128i y, __m128i z) { return Xor(z, And(x, Xor(y, z))); }
+__m128i inline Maj(__m128i x, __m128i y, __m128i z) { return Or(And(x, y), And(z, Or(x, y))); }
+__m128i inline Sigma0(__m128i x) { return Xor(RotR(x, 2), RotR(x, 13), RotR(x, 22)); }
+__m128i inline Sigma1(__m128i x) { return Xor(RotR(x, 6), RotR(x, 11), RotR(x, 25)); }
+__m128i inline sigma0(__m128i x) { return Xor(RotR(x, 7), RotR(x, 18), ShR(x, 3)); }
+__m128i inline sigma1(__m128i x) { return Xor(RotR(x, 17), RotR(x, 19), ShR(x, 10)); }
+
+/** Lane-wise improvedMix(). */
+void inline Mix(__m128i& a, __m128i& b, __m128i& c, __m128i& d)
+{
+    a = Xor(RotL(a, 13), b);
+    b = Add(RotR(b, 7), c);
+    c = Xor(RotL(c, 17), d);
+    d = Add(RotR(d, 11), a);
+}
+
+__m128i inline Read4(const unsigned char* const* blocks, int offset)
+{
+    return _mm_set_epi32(ReadBE32(blocks[3] + offset), ReadBE32(blocks[2] + offset), ReadBE32(blocks[1] + offset), ReadBE32(blocks[0] + offset));
+}
+
+__m128i inline Load4(const uint32_t* lanes, int stride, int offset)
+{
+    return _mm_set_epi32(lanes[3 * stride + offset], lanes[2 * stride + offset], lanes[stride + offset], lanes[offset]);
+}
+
+void inline Store4(uint32_t* lanes, int stride, int offset, __m128i x)
+{
+    alignas(16) uint32_t tmp[4];
+    _mm_store_si128((__m128i*)tmp, x);
+    lanes[offset] = tmp[0];
+    lanes[stride + offset] = tmp[1];
+    lanes[2 * stride + offset] = tmp[2];
+    lanes[3 * stride + offset] = tmp[3];
+}
+
+}
+
+void Rounds_4way(uint32_t* v, uint32_t* w63, const uint32_t* state, const unsigned char* const* blocks, const uint32_t* quantum_mix)
+{
+    __m128i w[64];
+
+    // Message expansion
+    for (int i = 0; i < 16; ++i) {
+        w[i] = Read4(blocks, i * 4);
+    }
+    for (int i = 16; i < 64; ++i) {
+        w[i] = Add(w[i - 16], sigma0(w[i - 15]), w[i - 7], sigma1(w[i - 2]));
+    }
+
+    const __m128i qm = Load4(quantum_mix, 1, 0);
+
+    __m128i a = Load4(state, 8, 0), b = Load4(state, 8, 1), c = Load4(state, 8, 2), d = Load4(state, 8, 3);
+    __m128i e = Load4(state, 8, 4), f = Load4(state, 8, 5), g = Load4(state, 8, 6), h = Load4(state, 8, 7);
+
+    for (int round = 0; round < 4; ++round) {
+        const __m128i S1 = Sigma1(e);
+        const __m128i ch = Ch(e, f, g);
+        const __m128i temp2 = Add(Sigma0(a), Maj(a, b, c));
+
+        for (int pii = 0; pii < 16; pii++) {
+            const int ri = pii * round;
+            const __m128i temp1 = Xor(Add(h, S1, ch, K(roundKeys[ri]), w[ri]), qm);
+            h = g;
+            g = f;
+            f = e;
+            e = Add(d, temp1);
+            d = c;
+            c = b;
+            b = a;
+            a = Add(temp1, temp2);
+        }
+
+        Mix(a, b, c, d);
+        Mix(e, f, g, h);
+    }
+
+    Store4(v, 8, 0, a); Store4(v, 8, 1, b); Store4(v, 8, 2, c); Store4(v, 8, 3, d);
+    Store4(v, 8, 4, e); Store4(v, 8, 5, f); Store4(v, 8, 6, g); Store4(v, 8, 7, h);
+    Store4(w63, 1, 0, w[63]);
+}
+
+}
+
+#endif
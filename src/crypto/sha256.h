@@ -0,0 +1,40 @@
+// Copyright (c) 2014-2018 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_CRYPTO_SHA256_H
+#define BITCOIN_CRYPTO_SHA256_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string>
+
+/** A hasher class for the standard SHA-256.
+ *
+ * Only for data that never leaves this node or that must interoperate with
+ * standard SHA-256 (salted cache keys, RNG event mixing, HMAC for RPC and Tor
+ * authentication). Consensus and P2P hashing use NeuralLeadQHash_iface; the
+ * lint-local-hash.sh linter keeps this header out of those paths.
+ */
+class CSHA256
+{
+private:
+    uint32_t s[8];
+    unsigned char buf[64];
+    uint64_t bytes;
+
+public:
+    static const size_t OUTPUT_SIZE = 32;
+
+    CSHA256();
+    CSHA256& Write(const unsigned char* data, size_t len);
+    void Finalize(unsigned char hash[OUTPUT_SIZE]);
+    CSHA256& Reset();
+};
+
+/** Autodetect the best available CSHA256 implementation.
+ *  Returns the name of the implementation.
+ */
+std::string LocalSHA256AutoDetect();
+
+#endif // BITCOIN_CRYPTO_SHA256_H
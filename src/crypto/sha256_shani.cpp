@@ -0,0 +1,81 @@
+// Copyright (c) 2018-2019 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// SHA-256 transform for CSHA256 using the Intel SHA extensions. Based on the
+// instruction flow described in Intel's "SHA Extensions" white paper.
+
+#ifdef ENABLE_SHANI
+
+#include <stdint.h>
+#include <immintrin.h>
+
+namespace {
+
+alignas(16) const uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+/** Four rounds on the (ABEF, CDGH) state with message words w, already loaded. */
+void inline __attribute__((always_inline)) QuadRound(__m128i& abef, __m128i& cdgh, __m128i w, int quad)
+{
+    __m128i msg = _mm_add_epi32(w, _mm_load_si128((const __m128i*)(K + 4 * quad)));
+    cdgh = _mm_sha256rnds2_epu32(cdgh, abef, msg);
+    msg = _mm_shuffle_epi32(msg, 0x0e);
+    abef = _mm_sha256rnds2_epu32(abef, cdgh, msg);
+}
+
+} // namespace
+
+namespace sha256_shani {
+void Transform(uint32_t* s, const unsigned char* chunk, size_t blocks)
+{
+    const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    // Load the state as ABEF / CDGH, the layout expected by sha256rnds2
+    __m128i t = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)s), 0xb1);
+    __m128i cdgh = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)(s + 4)), 0x1b);
+    __m128i abef = _mm_alignr_epi8(t, cdgh, 8);
+    cdgh = _mm_blend_epi16(cdgh, t, 0xf0);
+
+    while (blocks--) {
+        const __m128i abef_save = abef;
+        const __m128i cdgh_save = cdgh;
+        __m128i w[4];
+
+        for (int quad = 0; quad < 16; ++quad) {
+            if (quad < 4) {
+                w[quad] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(chunk + 16 * quad)), mask);
+            }
+            QuadRound(abef, cdgh, w[quad % 4], quad);
+            // Finish the message words of the next quad, then start those of quad + 3
+            if (quad >= 3 && quad <= 14) {
+                __m128i& next = w[(quad + 1) % 4];
+                next = _mm_sha256msg2_epu32(_mm_add_epi32(next, _mm_alignr_epi8(w[quad % 4], w[(quad + 3) % 4], 4)), w[quad % 4]);
+            }
+            if (quad >= 1 && quad <= 12) {
+                w[(quad + 3) % 4] = _mm_sha256msg1_epu32(w[(quad + 3) % 4], w[quad % 4]);
+            }
+        }
+
+        abef = _mm_add_epi32(abef, abef_save);
+        cdgh = _mm_add_epi32(cdgh, cdgh_save);
+        chunk += 64;
+    }
+
+    // Back to ABCD / EFGH
+    t = _mm_shuffle_epi32(abef, 0x1b);
+    cdgh = _mm_shuffle_epi32(cdgh, 0xb1);
+    _mm_storeu_si128((__m128i*)s, _mm_blend_epi16(t, cdgh, 0xf0));
+    _mm_storeu_si128((__m128i*)(s + 4), _mm_alignr_epi8(cdgh, t, 8));
+}
+} // namespace sha256_shani
+
+#endif
@@ -17,6 +17,8 @@
 #include <chainparams.h>
 #include <compat/sanity.h>
 #include <consensus/validation.h>
+#include <crypto/neuralleadnet.h>
+#include <crypto/sha256.h>
 #include <fs.h>
 #include <hash.h>
 #include <httprpc.h>
@@ -31,6 +33,7 @@
 #include <net_permissions.h>
 #include <net_processing.h>
 #include <netbase.h>
+#include <neuralleadnetio.h>
 #include <node/context.h>
 #include <node/ui_interface.h>
 #include <policy/feerate.h>
@@ -50,6 +53,7 @@
 #include <timedata.h>
 #include <torcontrol.h>
 #include <txdb.h>
+#include <txhashsidecar.h>
 #include <txmempool.h>
 #include <util/asmap.h>
 #include <util/check.h>
@@ -290,6 +294,7 @@ void Shutdown(NodeContext& node)
         }
         pblocktree.reset();
     }
+    g_txhash_sidecar.reset();
     for (const auto& client : node.chain_clients) {
         client->stop();
     }
@@ -427,6 +432,7 @@ void SetupServerArgs(NodeContext& node)
     argsman.AddArg("-prune=<n>", strprintf("Reduce storage requirements by enabling pruning (deleting) of old blocks. This allows the pruneblockchain RPC to be called to delete specific blocks, and enables automatic pruning of old blocks if a target size in MiB is provided. This mode is incompatible with -txindex and -rescan. "
             "Warning: Reverting this setting requires re-downloading the entire blockchain. "
             "(default: 0 = disable pruning blocks, 1 = allow manual pruning via RPC, >=%u = automatically prune block files to stay under the specified target size in MiB)", MIN_DISK_SPACE_FOR_BLOCK_FILES / 1024 / 1024), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-qhashnn=<backend>", strprintf("Neural network evaluator used by the NeuralLeadQHash neural stage: native, native-strict (scalar, synapses summed one by one in file order) or runtime (NeuralLeadQHash library). Native backends are experimental and fall back to the runtime if they do not reproduce it at startup (default: %s)", DEFAULT_NEURALNET_BACKEND), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::OPTIONS);
     argsman.AddArg("-reindex", "Rebuild chain state and block index from the blk*.dat files on disk", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-reindex-chainstate", "Rebuild chain state from the currently indexed blocks. When in pruning mode or if blocks on disk might be corrupted, use full -reindex instead.", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-settings=<file>", strprintf("Specify path to dynamic settings data file. Can be disabled with -nosettings. File is written at runtime and not meant to be edited by users (use %s instead for custom settings). Relative paths will be prefixed by datadir location. (default: %s)", BITCOIN_CONF_FILENAME, BITCOIN_SETTINGS_FILENAME), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
@@ -439,6 +445,8 @@ void SetupServerArgs(NodeContext& node)
     hidden_args.emplace_back("-sysperms");
 #endif
     argsman.AddArg("-txindex", strprintf("Maintain a full transaction index, used by the getrawtransaction rpc call (default: %u)", DEFAULT_TXINDEX), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-txhashsidecar", strprintf("Keep the txids and wtxids of stored blocks in txh?????.dat files next to the block files, so that reading blocks back does not rehash their transactions (default: %u)", DEFAULT_TXHASH_SIDECAR), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-verifyblockindex=<mode>", strprintf("How to check the header hashes of the block index against the hashes they are stored under: none (trust the stored hash), background (rehash all headers in parallel after startup) or startup (rehash each header while loading) (default: %s)", DEFAULT_VERIFY_BLOCK_INDEX), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-blockfilterindex=<type>",
                  strprintf("Maintain an index of compact filters by block (default: %s, values: %s).", DEFAULT_BLOCKFILTERINDEX, ListBlockFilterTypes()) +
                  " If <type> is not supplied or if <type> = 1, indexes for all known types are enabled.",
@@ -453,6 +461,7 @@ void SetupServerArgs(NodeContext& node)
     argsman.AddArg("-dns", strprintf("Allow DNS lookups for -addnode, -seednode and -connect (default: %u)", DEFAULT_NAME_LOOKUP), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     argsman.AddArg("-dnsseed", "Query for peer addresses via DNS lookup, if low on addresses (default: 1 unless -connect used)", ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     argsman.AddArg("-externalip=<ip>", "Specify your own public address", ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
+    argsman.AddArg("-fastchecksum", strprintf("Use CRC32C instead of QHash message checksums with peers that support it (default: %u)", DEFAULT_FAST_CHECKSUM), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     argsman.AddArg("-forcednsseed", strprintf("Always query for peer addresses via DNS lookup (default: %u)", DEFAULT_FORCEDNSSEED), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     argsman.AddArg("-listen", "Accept connections from outside (default: 1 if no -proxy or -connect)", ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     argsman.AddArg("-listenonion", strprintf("Automatically create Tor onion service (default: %d)", DEFAULT_LISTEN_ONION), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
@@ -500,22 +509,26 @@ void SetupServerArgs(NodeContext& node)
     argsman.AddArg("-zmqpubrawblock=<address>", "Enable publish raw block in <address>", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     argsman.AddArg("-zmqpubrawtx=<address>", "Enable publish raw transaction in <address>", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     argsman.AddArg("-zmqpubsequence=<address>", "Enable publish hash block and tx sequence in <address>", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
+    argsman.AddArg("-zmqpubstakerstats=<address>", "Enable publish staker round statistics in <address>", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     argsman.AddArg("-zmqpubhashblockhwm=<n>", strprintf("Set publish hash block outbound message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     argsman.AddArg("-zmqpubhashtxhwm=<n>", strprintf("Set publish hash transaction outbound message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     argsman.AddArg("-zmqpubrawblockhwm=<n>", strprintf("Set publish raw block outbound message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     argsman.AddArg("-zmqpubrawtxhwm=<n>", strprintf("Set publish raw transaction outbound message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     argsman.AddArg("-zmqpubsequencehwm=<n>", strprintf("Set publish hash sequence message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
+    argsman.AddArg("-zmqpubstakerstatshwm=<n>", strprintf("Set publish staker round statistics outbound message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
 #else
     hidden_args.emplace_back("-zmqpubhashblock=<address>");
     hidden_args.emplace_back("-zmqpubhashtx=<address>");
     hidden_args.emplace_back("-zmqpubrawblock=<address>");
     hidden_args.emplace_back("-zmqpubrawtx=<address>");
     hidden_args.emplace_back("-zmqpubsequence=<n>");
+    hidden_args.emplace_back("-zmqpubstakerstats=<address>");
     hidden_args.emplace_back("-zmqpubhashblockhwm=<n>");
     hidden_args.emplace_back("-zmqpubhashtxhwm=<n>");
     hidden_args.emplace_back("-zmqpubrawblockhwm=<n>");
     hidden_args.emplace_back("-zmqpubrawtxhwm=<n>");
     hidden_args.emplace_back("-zmqpubsequencehwm=<n>");
+    hidden_args.emplace_back("-zmqpubstakerstatshwm=<n>");
 #endif
 
     argsman.AddArg("-checkblocks=<n>", strprintf("How many blocks to check at startup (default: %u, 0 = all)", DEFAULT_CHECKBLOCKS), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
@@ -1087,6 +1100,16 @@ bool AppInitParameterInteraction(const ArgsManager& args)
     }
 
     fCheckBlockIndex = args.GetBoolArg("-checkblockindex", chainparams.DefaultConsistencyChecks());
+    const std::string verify_block_index = args.GetArg("-verifyblockindex", DEFAULT_VERIFY_BLOCK_INDEX);
+    if (verify_block_index == "none") {
+        g_verify_block_index = BlockIndexVerifyMode::NONE;
+    } else if (verify_block_index == "background") {
+        g_verify_block_index = BlockIndexVerifyMode::BACKGROUND;
+    } else if (verify_block_index == "startup") {
+        g_verify_block_index = BlockIndexVerifyMode::STARTUP;
+    } else {
+        return InitError(strprintf(_("Unknown -verifyblockindex value specified: %s"), verify_block_index));
+    }
     fCheckpointsEnabled = args.GetBoolArg("-checkpoints", DEFAULT_CHECKPOINTS_ENABLED);
 
     hashAssumeValid = uint256S(args.GetArg("-assumevalid", chainparams.GetConsensus().defaultAssumeValid.GetHex()));
@@ -1238,6 +1261,20 @@ bool AppInitSanityChecks()
     // Initialize elliptic curve code
     std::string sha256_algo = SHA256AutoDetect();
     LogPrintf("Using the algo '%s' implementation\n", sha256_algo);
+    LogPrintf("Using the '%s' SHA256 implementation for local hashing\n", LocalSHA256AutoDetect());
+
+    NeuralNetBackend nn_backend;
+    const std::string nn_name = gArgs.GetArg("-qhashnn", DEFAULT_NEURALNET_BACKEND);
+    if (!NeuralNetBackendFromName(nn_name, nn_backend)) {
+        return InitError(strprintf(_("Unknown -qhashnn value specified: %s"), nn_name));
+    }
+    std::string nn_error;
+    std::vector<NeuralLeadNet::LayerSpec> nn_layers;
+    if ((nn_backend != NeuralNetBackend::RUNTIME && !ReadNeuralLeadNetLayers(NEURALLEADNET_DIR, nn_layers, nn_error)) ||
+        !SetNeuralNetBackend(nn_backend, nn_layers, nn_error)) {
+        LogPrintf("Neural network backend '%s' unavailable (%s), falling back to the runtime\n", nn_name, nn_error);
+    }
+    LogPrintf("Using the '%s' neural network backend\n", NeuralNetBackendName());
     RandomInit();
     ECC_Start();
     globalVerifyHandle.reset(new ECCVerifyHandle());
@@ -1348,6 +1385,7 @@ bool AppInitMain(const util::Ref& context, NodeContext& node, interfaces::BlockA
         g_parallel_script_checks = true;
         for (int i = 0; i < script_threads; ++i) {
             threadGroup.create_thread([i]() { return ThreadScriptCheck(i); });
+            threadGroup.create_thread([i]() { return ThreadHeaderSigCheck(i); });
         }
     }
 
@@ -1600,8 +1638,18 @@ bool AppInitMain(const util::Ref& context, NodeContext& node, interfaces::BlockA
 
         uiInterface.InitMessage(_("Loading block index...").translated);
 
+        if (args.GetBoolArg("-txhashsidecar", DEFAULT_TXHASH_SIDECAR)) {
+            g_txhash_sidecar = MakeUnique<TxHashSidecar>(GetBlocksDir());
+        }
+
         do {
             const int64_t load_block_index_start_time = GetTimeMillis();
+            int64_t phase_start_time = load_block_index_start_time;
+            auto log_phase = [&phase_start_time](const char* phase) {
+                const int64_t now = GetTimeMillis();
+                LogPrintf("Startup phase %s: %dms\n", phase, now - phase_start_time);
+                phase_start_time = now;
+            };
             try {
                 LOCK(cs_main);
                 chainman.InitializeChainstate(*Assert(node.mempool));
@@ -1633,6 +1681,7 @@ bool AppInitMain(const util::Ref& context, NodeContext& node, interfaces::BlockA
                     strLoadError = _("Error loading block database");
                     break;
                 }
+                log_phase("load block index");
 
                 // If the loaded chain has a wrong genesis, bail out immediately
                 // (we're likely using a testnet datadir, or the other way around).
@@ -1656,6 +1705,7 @@ bool AppInitMain(const util::Ref& context, NodeContext& node, interfaces::BlockA
                     strLoadError = _("Error initializing block database");
                     break;
                 }
+                log_phase("load genesis block");
 
                 // At this point we're either in reindex or we've loaded a useful
                 // block tree into BlockIndex()!
@@ -1707,6 +1757,7 @@ bool AppInitMain(const util::Ref& context, NodeContext& node, interfaces::BlockA
                 if (failed_chainstate_init) {
                     break; // out of the chainstate activation do-while
                 }
+                log_phase("load chainstate");
             } catch (const std::exception& e) {
                 LogPrintf("%s\n", e.what());
                 strLoadError = _("Error opening block database");
@@ -1735,6 +1786,7 @@ bool AppInitMain(const util::Ref& context, NodeContext& node, interfaces::BlockA
             if (failed_rewind) {
                 break; // out of the chainstate activation do-while
             }
+            log_phase("rewind block index");
 
             bool failed_verification = false;
 
@@ -1780,6 +1832,7 @@ bool AppInitMain(const util::Ref& context, NodeContext& node, interfaces::BlockA
             }
 
             if (!failed_verification) {
+                log_phase("verify blocks");
                 fLoaded = true;
                 LogPrintf(" block index %15dms\n", GetTimeMillis() - load_block_index_start_time);
             }
@@ -1813,6 +1866,11 @@ bool AppInitMain(const util::Ref& context, NodeContext& node, interfaces::BlockA
         return false;
     }
 
+    if (g_verify_block_index == BlockIndexVerifyMode::BACKGROUND && !fReindex) {
+        const int verify_threads = std::max(GetNumCores() - 1, 1);
+        threadGroup.create_thread([verify_threads] { TraceThread("blkidxcheck", [verify_threads] { VerifyBlockIndexHashes(verify_threads); }); });
+    }
+
     fs::path est_path = GetDataDir() / FEE_ESTIMATES_FILENAME;
     CAutoFile est_filein(fsbridge::fopen(est_path, "rb"), SER_DISK, CLIENT_VERSION);
     // Allowed to fail as this file IS missing on first startup.
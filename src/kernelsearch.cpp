@@ -0,0 +1,204 @@
+// Copyright (c) 2024 The NeuralLead developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <kernelsearch.h>
+
+#include <chain.h>
+#include <pos.h>
+#include <tinyformat.h>
+#include <util/system.h>
+#include <util/threadnames.h>
+
+#include <algorithm>
+
+CKernelSearch::CKernelSearch(int threads) : m_queues(std::max(threads, 1))
+{
+    for (size_t id = 1; id < m_queues.size(); ++id) {
+        m_threads.emplace_back([this, id] { ThreadLoop(id); });
+    }
+}
+
+CKernelSearch::~CKernelSearch()
+{
+    {
+        LOCK(m_mutex);
+        m_stop = true;
+    }
+    m_work_cv.notify_all();
+    for (std::thread& t : m_threads) {
+        t.join();
+    }
+}
+
+void CKernelSearch::ThreadLoop(size_t id)
+{
+    util::ThreadRename(strprintf("stakesearch.%i", id));
+    SetThreadPriority(THREAD_PRIORITY_LOWEST);
+
+    uint64_t generation = 0;
+    while (true) {
+        {
+            WAIT_LOCK(m_mutex, lock);
+            while (!m_stop && m_generation == generation) {
+                m_work_cv.wait(lock);
+            }
+            if (m_stop) return;
+            generation = m_generation;
+        }
+        Work(id, nullptr);
+        {
+            LOCK(m_mutex);
+            if (--m_running == 0) m_done_cv.notify_one();
+        }
+    }
+}
+
+bool CKernelSearch::NextChunk(size_t id, uint64_t& chunk)
+{
+    // Own queue first, lowest chunk first, then steal the highest chunk of another queue
+    for (size_t i = 0; i < m_queues.size(); ++i) {
+        Queue& queue = m_queues[(id + i) % m_queues.size()];
+        LOCK(queue.mutex);
+        while (!queue.chunks.empty()) {
+            if (i == 0) {
+                chunk = queue.chunks.front();
+                queue.chunks.pop_front();
+            } else {
+                chunk = queue.chunks.back();
+                queue.chunks.pop_back();
+            }
+            if (chunk * CHUNK_SIZE < m_best.load(std::memory_order_relaxed)) return true;
+        }
+    }
+    return false;
+}
+
+void CKernelSearch::Work(size_t id, const std::function<bool()>* interrupt)
+{
+    std::vector<StakeCandidate>& coins = *m_coins;
+    const std::vector<uint32_t>& slots = *m_slots;
+    const uint256& modifier = m_pindex_prev->nStakeModifier;
+    const int height = m_pindex_prev->nHeight + 1;
+
+    uint64_t chunk;
+    while (!m_cancel.load(std::memory_order_relaxed) && NextChunk(id, chunk)) {
+        if (interrupt && (*interrupt)()) {
+            m_cancel = true;
+            break;
+        }
+        const uint64_t end = std::min(m_total, (chunk + 1) * CHUNK_SIZE);
+        if (m_phase == Phase::MIDSTATES) {
+            // Each coin belongs to a single chunk
+            for (uint64_t index = chunk * CHUNK_SIZE; index < end; ++index) {
+                StakeCandidate& candidate = coins[index];
+                if (candidate.hasMidstate && candidate.midstateModifier == modifier) continue;
+                candidate.midstate = GetStakeKernelMidstate(modifier, candidate.blockFromTime, candidate.prevout);
+                candidate.midstateModifier = modifier;
+                candidate.hasMidstate = true;
+            }
+            continue;
+        }
+        uint64_t hashes = 0;
+        for (uint64_t pair = chunk * CHUNK_SIZE; pair < end && pair < m_best.load(std::memory_order_relaxed); ++pair) {
+            const uint32_t nTimeBlock = slots[pair / coins.size()];
+            const StakeCandidate& candidate = coins[pair % coins.size()];
+            if (nTimeBlock < candidate.blockFromTime) continue;
+
+            uint256 hashProofOfStake, targetProofOfStake;
+            ++hashes;
+            if (CheckStakeKernelHash(candidate.midstate, m_bits, candidate.blockFromTime, height, candidate.amount, candidate.prevout,
+                                     nTimeBlock, hashProofOfStake, targetProofOfStake)) {
+                uint64_t best = m_best.load();
+                while (pair < best && !m_best.compare_exchange_weak(best, pair)) {}
+                break;
+            }
+        }
+        m_hashes += hashes;
+
+        // The thread handling the last pairs of a slot records when its scan ended
+        for (uint64_t pair = chunk * CHUNK_SIZE; pair < end;) {
+            const size_t slot = pair / coins.size();
+            const uint64_t slot_end = std::min<uint64_t>(end, (slot + 1) * coins.size());
+            if (m_slot_left[slot].fetch_sub(slot_end - pair) == slot_end - pair) {
+                m_stats.slot_times[slot] = GetTimeMicros() - m_start;
+            }
+            pair = slot_end;
+        }
+    }
+}
+
+void CKernelSearch::Run(Phase phase, uint64_t total, const std::function<bool()>* interrupt)
+{
+    m_phase = phase;
+    m_total = total;
+    m_best = total;
+
+    const uint64_t chunks = (total + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    for (uint64_t chunk = 0; chunk < chunks; ++chunk) {
+        Queue& queue = m_queues[chunk % m_queues.size()];
+        LOCK(queue.mutex);
+        queue.chunks.push_back(chunk);
+    }
+
+    {
+        LOCK(m_mutex);
+        m_running = m_threads.size();
+        ++m_generation;
+    }
+    m_work_cv.notify_all();
+
+    Work(0, interrupt);
+
+    {
+        WAIT_LOCK(m_mutex, lock);
+        while (m_running > 0) {
+            m_done_cv.wait(lock);
+        }
+    }
+
+    // Chunks left behind by a cancelled search
+    for (Queue& queue : m_queues) {
+        LOCK(queue.mutex);
+        queue.chunks.clear();
+    }
+}
+
+bool CKernelSearch::Find(CBlockIndex* pindexPrev, unsigned int nBits, std::vector<StakeCandidate>& coins, const std::vector<uint32_t>& slots,
+                         const std::function<bool()>& interrupt, size_t& slot, size_t& coin)
+{
+    m_stats = Stats();
+    if (coins.empty() || slots.empty()) return false;
+
+    m_pindex_prev = pindexPrev;
+    m_bits = nBits;
+    m_coins = &coins;
+    m_slots = &slots;
+    m_cancel = false;
+
+    m_start = GetTimeMicros();
+    m_hashes = 0;
+    m_stats.slot_times.assign(slots.size(), -1);
+    m_slot_left.reset(new std::atomic<uint64_t>[slots.size()]);
+    for (size_t i = 0; i < slots.size(); ++i) {
+        m_slot_left[i] = coins.size();
+    }
+
+    // The midstates only go stale when the tip moves, skip the pass in between
+    const bool stale = std::any_of(coins.begin(), coins.end(), [&](const StakeCandidate& candidate) {
+        return !candidate.hasMidstate || candidate.midstateModifier != pindexPrev->nStakeModifier;
+    });
+    if (stale) {
+        Run(Phase::MIDSTATES, coins.size(), nullptr);
+    }
+
+    Run(Phase::KERNELS, coins.size() * slots.size(), &interrupt);
+    m_stats.hashes = m_hashes;
+    m_stats.time = GetTimeMicros() - m_start;
+
+    const uint64_t best = m_best;
+    if (m_cancel || best >= m_total) return false;
+    slot = best / coins.size();
+    coin = best % coins.size();
+    return true;
+}
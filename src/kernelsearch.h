@@ -0,0 +1,140 @@
+// Copyright (c) 2024 The NeuralLead developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_KERNELSEARCH_H
+#define BITCOIN_KERNELSEARCH_H
+
+#include <amount.h>
+#include <hash.h>
+#include <primitives/transaction.h>
+#include <sync.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+class CBlockIndex;
+
+//! Default for -stakerthreads, 0 = one per core
+static const int DEFAULT_STAKER_THREADS = 0;
+//! Maximum number of kernel search threads
+static const int MAX_STAKER_THREADS = 64;
+
+/** A stakeable coin and the data its kernel hash commits to. */
+struct StakeCandidate
+{
+    COutPoint prevout;
+    uint32_t blockFromTime;
+    CAmount amount;
+
+    //! Kernel hash state up to prevout.hash, see GetStakeKernelMidstate()
+    CHash256 midstate{};
+    //! Stake modifier the midstate belongs to, the midstate is stale on any other tip
+    uint256 midstateModifier{};
+    bool hasMidstate{false};
+
+    // The member initializers above make this a non-aggregate in C++11
+    StakeCandidate(const COutPoint& prevoutIn, uint32_t blockFromTimeIn, CAmount amountIn)
+        : prevout(prevoutIn), blockFromTime(blockFromTimeIn), amount(amountIn) {}
+};
+
+/**
+ * Searches the (coin, slot) grid for a stake kernel on a fixed pool of threads.
+ *
+ * Pairs are numbered slot-major and handed out in chunks, dealt round-robin to
+ * one queue per thread, so all threads work on the earliest slots first. A
+ * thread whose queue runs dry steals from the back of the others. Every hit
+ * lowers a shared bound and work past it is dropped, so the search stops as
+ * soon as no earlier pair can win, and it returns the pair a serial scan
+ * would: the first candidate, in order, that meets the target in the earliest
+ * slot.
+ *
+ * Only the block time changes between slots, so the search first brings the
+ * per-coin kernel midstates up to date with the tip (in parallel, on the same
+ * threads) and then only finishes the hash for each pair.
+ *
+ * The calling thread takes part in the search and is the only one that polls
+ * the interrupt callback, once per chunk.
+ */
+class CKernelSearch
+{
+public:
+    //! Number of (coin, slot) pairs handed out at a time
+    static constexpr uint64_t CHUNK_SIZE = 64;
+
+    explicit CKernelSearch(int threads);
+    ~CKernelSearch();
+
+    CKernelSearch(const CKernelSearch&) = delete;
+    CKernelSearch& operator=(const CKernelSearch&) = delete;
+
+    /**
+     * Find the first (slot, coin) pair whose kernel hash meets nBits on top
+     * of pindexPrev. Returns false if there is none or if interrupt() returned
+     * true before the search completed. Refreshes the midstates of coins.
+     */
+    bool Find(CBlockIndex* pindexPrev, unsigned int nBits, std::vector<StakeCandidate>& coins, const std::vector<uint32_t>& slots,
+              const std::function<bool()>& interrupt, size_t& slot, size_t& coin);
+
+    size_t Threads() const { return m_queues.size(); }
+
+    struct Stats {
+        //! Kernel hashes computed
+        uint64_t hashes{0};
+        //! Duration of the search and, for each slot, time from its start to
+        //! the end of the slot's scan, in microseconds. -1 for the slots that
+        //! were not scanned to the end.
+        int64_t time{0};
+        std::vector<int64_t> slot_times;
+    };
+
+    //! Statistics of the last Find()
+    const Stats& LastStats() const { return m_stats; }
+
+private:
+    struct Queue {
+        Mutex mutex;
+        std::deque<uint64_t> chunks GUARDED_BY(mutex);
+    };
+
+    std::vector<Queue> m_queues;
+    std::vector<std::thread> m_threads;
+
+    Mutex m_mutex;
+    std::condition_variable m_work_cv;
+    std::condition_variable m_done_cv;
+    uint64_t m_generation GUARDED_BY(m_mutex){0};
+    size_t m_running GUARDED_BY(m_mutex){0};
+    bool m_stop GUARDED_BY(m_mutex){false};
+
+    enum class Phase { MIDSTATES, KERNELS };
+
+    //! The current search, only written while no worker is running
+    Phase m_phase{Phase::KERNELS};
+    CBlockIndex* m_pindex_prev{nullptr};
+    unsigned int m_bits{0};
+    std::vector<StakeCandidate>* m_coins{nullptr};
+    const std::vector<uint32_t>* m_slots{nullptr};
+    uint64_t m_total{0};
+
+    std::atomic<uint64_t> m_best{0};
+    std::atomic<bool> m_cancel{false};
+
+    Stats m_stats;
+    int64_t m_start{0};
+    std::atomic<uint64_t> m_hashes{0};
+    //! Pairs of each slot not handled yet
+    std::unique_ptr<std::atomic<uint64_t>[]> m_slot_left;
+
+    void ThreadLoop(size_t id);
+    bool NextChunk(size_t id, uint64_t& chunk);
+    void Run(Phase phase, uint64_t total, const std::function<bool()>* interrupt);
+    void Work(size_t id, const std::function<bool()>* interrupt);
+};
+
+#endif // BITCOIN_KERNELSEARCH_H
@@ -13,12 +13,14 @@
 #include <consensus/merkle.h>
 #include <consensus/tx_verify.h>
 #include <consensus/validation.h>
+#include <kernelsearch.h>
 #include <net.h>
 #include <policy/feerate.h>
 #include <policy/policy.h>
 #include <pow.h>
 #include <pos.h>
 #include <primitives/transaction.h>
+#include <stakerstats.h>
 #include <timedata.h>
 #include <util/moneystr.h>
 #include <util/system.h>
@@ -43,6 +45,36 @@
 
 unsigned int nMinerSleep = STAKER_POLLING_PERIOD;
 
+CStakeLatency g_stake_latency;
+
+void CStakeLatency::Staked(const uint256& hash, int64_t time_found)
+{
+    LOCK(m_mutex);
+    m_pending_hash = hash;
+    m_pending_time = time_found;
+    m_pending = true;
+}
+
+void CStakeLatency::Announced(const uint256& hash)
+{
+    if (!m_pending) return;
+    LOCK(m_mutex);
+    if (!m_pending || hash != m_pending_hash) return;
+    const int64_t latency = GetTimeMicros() - m_pending_time;
+    m_pending = false;
+    m_stats.count++;
+    m_stats.last = latency;
+    m_stats.total += latency;
+    m_stats.max = std::max(m_stats.max, latency);
+    LogPrint(BCLog::COINSTAKE, "Staked block %s reached the first peer %.3fms after its kernel was found\n", hash.ToString(), latency * 0.001);
+}
+
+CStakeLatency::Stats CStakeLatency::GetStats() const
+{
+    LOCK(m_mutex);
+    return m_stats;
+}
+
 int64_t UpdateTime(CBlockHeader* pblock, const Consensus::Params& consensusParams, const CBlockIndex* pindexPrev)
 {
     int64_t nOldTime = pblock->nTime;
@@ -560,7 +592,9 @@ void IncrementExtraNonce(CBlock* pblock, const CBlockIndex* pindexPrev, unsigned
 // Looking for suitable coins for creating new block.
 //
 
-bool CheckStake(const std::shared_ptr<const CBlock> pblock, CWallet& wallet, ChainstateManager* chainman)
+// pHashProofOfStake, when given, is the kernel hash SignBlock() checked, the
+// stake is then not checked again here nor by ProcessNewBlock()
+bool CheckStake(const std::shared_ptr<const CBlock> pblock, CWallet& wallet, ChainstateManager* chainman, const uint256* pHashProofOfStake = nullptr)
 {
     uint256 proofHash, hashTarget;
     uint256 hashBlock = pblock->GetHash();
@@ -568,10 +602,14 @@ bool CheckStake(const std::shared_ptr<const CBlock> pblock, CWallet& wallet, Cha
     if(!pblock->IsProofOfStake())
         return error("CheckStake() : %s is not a proof-of-stake block", hashBlock.GetHex());
 
-    // verify hash target and signature of coinstake tx
-    BlockValidationState state;
-    if (!CheckProofOfStake(::BlockIndex()[pblock->hashPrevBlock], state, *pblock->vtx[1], pblock->nBits, pblock->nTime, proofHash, hashTarget, ::ChainstateActive().CoinsTip()))
-        return error("CheckStake() : proof-of-stake checking failed");
+    if (pHashProofOfStake) {
+        proofHash = *pHashProofOfStake;
+    } else {
+        // verify hash target and signature of coinstake tx
+        BlockValidationState state;
+        if (!CheckProofOfStake(LookupBlockIndex(pblock->hashPrevBlock), state, *pblock->vtx[1], pblock->nBits, pblock->nTime, proofHash, hashTarget, ::ChainstateActive().CoinsTip()))
+            return error("CheckStake() : proof-of-stake checking failed");
+    }
 
     //// debug print
     LogPrint(BCLog::COINSTAKE, "CheckStake() : new proof-of-stake block found  \n  hash: %s \nproofhash: %s  \ntarget: %s\n", hashBlock.GetHex(), proofHash.GetHex(), hashTarget.GetHex());
@@ -592,7 +630,7 @@ bool CheckStake(const std::shared_ptr<const CBlock> pblock, CWallet& wallet, Cha
 
     // Process this block the same as if we had received it from another node
     bool fNewBlock = false;
-    if (!chainman->ProcessNewBlock(Params(), pblock, true, &fNewBlock))
+    if (!chainman->ProcessNewBlock(Params(), pblock, true, &fNewBlock, pHashProofOfStake))
         return error("CheckStake() : ProcessBlock, block not accepted");
 
     return true;
@@ -617,8 +655,24 @@ void ThreadStakeMiner(CWallet *pwallet, CConnman* connman, ChainstateManager* ch
     }
 
     std::set<std::pair<const CWalletTx*,unsigned int> > setCoins;
+    std::vector<StakeCandidate> stakeCandidates;
     uint256 chainTipForCoins;
 
+    int nStakerThreads = gArgs.GetArg("-stakerthreads", DEFAULT_STAKER_THREADS);
+    if (nStakerThreads <= 0)
+        nStakerThreads += GetNumCores();
+    nStakerThreads = std::max(1, std::min(nStakerThreads, MAX_STAKER_THREADS));
+    CKernelSearch kernelSearch(nStakerThreads);
+    LogPrintf("Searching stake kernels with %d threads\n", nStakerThreads);
+
+    // In pipelined mode the kernel search runs on a block that already has its
+    // transactions, rebuilt between rounds when the tip or the mempool changes,
+    // so a kernel is signed once and published at once
+    const bool fPipeline = gArgs.GetBoolArg("-stakepipeline", DEFAULT_STAKE_PIPELINE);
+    std::unique_ptr<CBlockTemplate> pblocktemplatefull;
+    int64_t nTotalFeesFull = 0;
+    unsigned int nTransactionsUpdatedLast = 0;
+
     while (pwallet->IsLocked() || !pwallet->m_enabled_staking)
     {
         UninterruptibleSleep(std::chrono::milliseconds{10000}); // wait until wallet is unlocked
@@ -671,13 +725,26 @@ void ThreadStakeMiner(CWallet *pwallet, CConnman* connman, ChainstateManager* ch
         //
         // Select the suitable coins
         //
+        // The lock times of a round are those of the parts of it holding
+        // cs_main or cs_wallet: coin selection holds both
+        StakerRound round;
         if (chainTipForCoins != ::ChainActive().Tip()->GetBlockHash()) {
             int64_t start_time = GetTimeMillis();
+            const int64_t nSelectStart = GetTimeMicros();
             LogPrint(BCLog::COINSTAKE, "Chain tip changed since previous coin selection, selecting new coins for staking...\n");
-            LOCK(pwallet->cs_wallet);
-            setCoins.clear();
-            chainTipForCoins = ::ChainActive().Tip()->GetBlockHash();
-            pwallet->SelectCoinsForStaking(setCoins);
+            CBlockIndex* pindexCoins;
+            {
+                // Same order as GetStakeCandidates() and the wallet RPCs
+                LOCK2(cs_main, pwallet->cs_wallet);
+                setCoins.clear();
+                pindexCoins = ::ChainActive().Tip();
+                chainTipForCoins = pindexCoins->GetBlockHash();
+                pwallet->SelectCoinsForStaking(setCoins);
+            }
+            // Takes the locks itself, the stake cache writes are done without cs_main
+            const size_t nCacheHits = pwallet->GetStakeCandidates(setCoins, pindexCoins, stakeCandidates);
+            g_staker_stats.AddStakeCacheLookups(nCacheHits, setCoins.size() - nCacheHits);
+            round.cs_main_time = round.cs_wallet_time = GetTimeMicros() - nSelectStart;
             LogPrint(BCLog::COINSTAKE, "Selecting coins for staking completed in %15dms\n", GetTimeMillis() - start_time);
         } else {
             LogPrint(BCLog::COINSTAKE, "Chain tip unchanged since previous coin selection, using previously selected coins...\n");
@@ -699,30 +766,91 @@ void ThreadStakeMiner(CWallet *pwallet, CConnman* connman, ChainstateManager* ch
         else if (setCoins.size() > 0)
         {
             int64_t nTotalFees = 0;
-            // First just create an empty block. No need to process transactions until we know we can create a block
-            std::unique_ptr<CBlockTemplate> pblocktemplate(BlockAssembler(*mempool, Params()).CreateNewBlock(CScript(), true, &nTotalFees, 0, false));
+            std::unique_ptr<CBlockTemplate> pblocktemplate;
+            const int64_t nTemplateStart = GetTimeMicros();
+            if (fPipeline) {
+                if (!pblocktemplatefull || pblocktemplatefull->block.hashPrevBlock != ::ChainActive().Tip()->GetBlockHash() ||
+                    mempool->GetTransactionsUpdated() != nTransactionsUpdatedLast) {
+                    nTransactionsUpdatedLast = mempool->GetTransactionsUpdated();
+                    pblocktemplatefull = BlockAssembler(*mempool, Params()).CreateNewBlock(CScript(), true, &nTotalFeesFull, 0, true);
+                }
+                if (pblocktemplatefull) {
+                    pblocktemplate.reset(new CBlockTemplate(*pblocktemplatefull));
+                    nTotalFees = nTotalFeesFull;
+                }
+            } else {
+                // First just create an empty block. No need to process transactions until we know we can create a block
+                pblocktemplate = BlockAssembler(*mempool, Params()).CreateNewBlock(CScript(), true, &nTotalFees, 0, false);
+            }
             if (!pblocktemplate.get()) {
                 LogPrintf("ThreadStakeMiner(): Failed to create block template; thread exiting...\n");
                 return;
             }
+            round.cs_main_time += GetTimeMicros() - nTemplateStart;
 
             CBlockIndex* pindexPrev = ::ChainActive().Tip();
 
             uint32_t beginningTime=GetAdjustedTime();
             beginningTime &= ~STAKE_TIMESTAMP_MASK;
-            
+
+            std::vector<uint32_t> slots;
             for (uint32_t i = beginningTime; i < (beginningTime + MAX_STAKE_LOOKAHEAD); i += (STAKE_TIMESTAMP_MASK + 1)) {
-                
-                // The information is needed for status bar to determine if the staker is trying to create block and when it will be created approximately,
-                if (pwallet->m_last_coin_stake_search_time == 0) pwallet->m_last_coin_stake_search_time = GetAdjustedTime(); // startup timestamp
-                
-                // nLastCoinStakeSearchInterval > 0 mean that the staker is running
-                pwallet->m_last_coin_stake_search_interval = i - pwallet->m_last_coin_stake_search_time;
+                slots.push_back(i);
+            }
+
+            // The information is needed for status bar to determine if the staker is trying to create block and when it will be created approximately,
+            if (pwallet->m_last_coin_stake_search_time == 0) pwallet->m_last_coin_stake_search_time = GetAdjustedTime(); // startup timestamp
+
+            // nLastCoinStakeSearchInterval > 0 mean that the staker is running
+            pwallet->m_last_coin_stake_search_interval = slots.back() - pwallet->m_last_coin_stake_search_time;
+
+            // Search all the lookahead slots at once, stop as soon as the tip moves
+            const std::function<bool()> tipChanged = [pindexPrev] {
+                return ::ChainActive().Tip() != pindexPrev || boost::this_thread::interruption_requested();
+            };
+            round.time = GetAdjustedTime();
+            round.candidates = stakeCandidates.size();
+            round.slots = slots.size();
+            const int64_t nSearchStart = GetTimeMicros();
+            size_t slot, kernel;
+            // A search over the remaining slots, added to the round. A slot is
+            // missed when its scan ends after the slot is over
+            const auto findKernel = [&] {
+                const int64_t nFindStart = GetTimeMicros();
+                const bool fFound = kernelSearch.Find(pindexPrev, pblocktemplate->block.nBits, stakeCandidates, slots, tipChanged, slot, kernel);
+                const CKernelSearch::Stats& stats = kernelSearch.LastStats();
+                const int64_t nAdjustedStart = nFindStart + GetTimeOffset() * 1000000;
+                round.hashes += stats.hashes;
+                round.search_time += stats.time;
+                round.kernel_found |= fFound;
+                for (size_t j = 0; j < stats.slot_times.size(); ++j) {
+                    if (stats.slot_times[j] < 0) continue;
+                    round.slots_scanned++;
+                    if (nAdjustedStart + stats.slot_times[j] > int64_t(slots[j] + STAKE_TIMESTAMP_MASK + 1) * 1000000) {
+                        round.slots_missed++;
+                    }
+                    round.slot_times.push_back(nFindStart - nSearchStart + stats.slot_times[j]);
+                }
+                return fFound;
+            };
+            while (!slots.empty() && findKernel()) {
+                const int64_t nKernelTime = GetTimeMicros();
+                const uint32_t i = slots[slot];
+                const COutPoint prevoutKernel = stakeCandidates[kernel].prevout;
+                slots.erase(slots.begin(), slots.begin() + slot + 1);
 
                 // Try to sign a block (this also checks for a PoS stake)
                 pblocktemplate->block.nTime = i;
                 std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>(pblocktemplate->block);
-                if (SignBlock(pblock, *pwallet, nTotalFees, i, setCoins)) {
+                if (fPipeline) {
+                    // As CreateNewBlock() would for this time, on testnet it can change the target
+                    pblock->nBits = GetNextWorkRequired(pindexPrev, pblock.get(), Params().GetConsensus(), true);
+                }
+                uint256 hashProofOfStake;
+                const int64_t nSignStart = GetTimeMicros();
+                const bool fSigned = SignBlock(pblock, *pwallet, nTotalFees, i, setCoins, &prevoutKernel, &hashProofOfStake);
+                round.cs_wallet_time += GetTimeMicros() - nSignStart;
+                if (fSigned) {
                     LogPrint(BCLog::COINSTAKE, "STAKING THREAD signing block...\n");
                     // increase priority so we can build the full PoS block ASAP to ensure the timestamp doesn't expire
                     SetThreadPriority(THREAD_PRIORITY_ABOVE_NORMAL);
@@ -732,21 +860,33 @@ void ThreadStakeMiner(CWallet *pwallet, CConnman* connman, ChainstateManager* ch
                         LogPrintf("ThreadStakeMiner(): Valid future PoS block was orphaned before becoming valid\n");
                         break;
                     }
-                    // Create a block that's properly populated with transactions
-                    std::unique_ptr<CBlockTemplate> pblocktemplatefilled(
-                            BlockAssembler(*mempool, Params()).CreateNewBlock(pblock->vtx[1]->vout[1].scriptPubKey, true, &nTotalFees, i, true));
-                    if (!pblocktemplatefilled.get()) {
-                        LogPrintf("ThreadStakeMiner(): Failed to create block template; thread exiting...\n");
-                        return;
+                    std::shared_ptr<CBlock> pblockfilled = pblock;
+                    if (!fPipeline) {
+                        // Create a block that's properly populated with transactions
+                        const int64_t nFillStart = GetTimeMicros();
+                        std::unique_ptr<CBlockTemplate> pblocktemplatefilled(
+                                BlockAssembler(*mempool, Params()).CreateNewBlock(pblock->vtx[1]->vout[1].scriptPubKey, true, &nTotalFees, i, true));
+                        round.cs_main_time += GetTimeMicros() - nFillStart;
+                        if (!pblocktemplatefilled.get()) {
+                            LogPrintf("ThreadStakeMiner(): Failed to create block template; thread exiting...\n");
+                            return;
+                        }
+                        if (::ChainActive().Tip()->GetBlockHash() != pblock->hashPrevBlock) {
+                            //another block was received while building ours, scrap progress
+                            LogPrintf("ThreadStakeMiner(): Valid future PoS block was orphaned before becoming valid\n");
+                            break;
+                        }
+                        pblockfilled = std::make_shared<CBlock>(pblocktemplatefilled->block);
                     }
-                    if (::ChainActive().Tip()->GetBlockHash() != pblock->hashPrevBlock) {
-                        //another block was received while building ours, scrap progress
-                        LogPrintf("ThreadStakeMiner(): Valid future PoS block was orphaned before becoming valid\n");
-                        break;
+                    // Sign the full block and use the timestamp from earlier for a valid stake, the
+                    // pipelined block is signed already
+                    bool fSignedFull = true;
+                    if (!fPipeline) {
+                        const int64_t nSignFullStart = GetTimeMicros();
+                        fSignedFull = SignBlock(pblockfilled, *pwallet, nTotalFees, i, setCoins, &prevoutKernel, &hashProofOfStake);
+                        round.cs_wallet_time += GetTimeMicros() - nSignFullStart;
                     }
-                    // Sign the full block and use the timestamp from earlier for a valid stake
-                    std::shared_ptr<CBlock> pblockfilled = std::make_shared<CBlock>(pblocktemplatefilled->block);
-                    if (SignBlock(pblockfilled, *pwallet, nTotalFees, i, setCoins)) {
+                    if (fSignedFull) {
                         // Should always reach here unless we spent too much time processing transactions and the timestamp is now invalid
                         // CheckStake also does CheckBlock and AcceptBlock to propogate it to the network
                         bool validBlock = false;
@@ -778,7 +918,8 @@ void ThreadStakeMiner(CWallet *pwallet, CConnman* connman, ChainstateManager* ch
                             validBlock=true;
                         }
                         if (validBlock) {
-                            CheckStake(pblockfilled, *pwallet, chainman);
+                            g_stake_latency.Staked(pblockfilled->GetHash(), nKernelTime);
+                            CheckStake(pblockfilled, *pwallet, chainman, &hashProofOfStake);
                             // Update the search time when new valid block is created, needed for status bar icon
                             pwallet->m_last_coin_stake_search_time = pblockfilled->GetBlockTime();
                             pwallet->received_newStakingSignal = false;
@@ -789,6 +930,8 @@ void ThreadStakeMiner(CWallet *pwallet, CConnman* connman, ChainstateManager* ch
                     SetThreadPriority(THREAD_PRIORITY_LOWEST);
                 }
             }
+            g_staker_stats.AddRound(round);
+            boost::this_thread::interruption_point();
         }
         UninterruptibleSleep(std::chrono::milliseconds{nMinerSleep});
     }
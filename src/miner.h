@@ -8,9 +8,12 @@
 
 #include <optional.h>
 #include <primitives/block.h>
+#include <sync.h>
 #include <txmempool.h>
+#include <uint256.h>
 #include <validation.h>
 
+#include <atomic>
 #include <memory>
 #include <stdint.h>
 
@@ -37,6 +40,9 @@ static const bool DEFAULT_STEPBYSTEP_STAKING = false;
 
 static const bool DEFAULT_STAKE_CACHE = true;
 
+//! Default for -stakepipeline
+static const bool DEFAULT_STAKE_PIPELINE = true;
+
 //How many seconds to look ahead and prepare a block for staking
 //Look ahead up to 3 "timeslots" in the future, 48 seconds
 //Reduce this to reduce computational waste for stakers, increase this to increase the amount of time available to construct full blocks
@@ -231,6 +237,39 @@ int64_t UpdateTime(CBlockHeader* pblock, const Consensus::Params& consensusParam
 /** Update an old GenerateCoinbaseCommitment from CreateNewBlock after the block txs have changed */
 void RegenerateCommitments(CBlock& block);
 
+/**
+ * Time from finding a stake kernel to handing the staked block to the first
+ * peer, by compact block, headers or inv. Reported by getstakinginfo.
+ */
+class CStakeLatency
+{
+public:
+    struct Stats {
+        //! Staked blocks announced
+        uint64_t count{0};
+        //! Latencies in microseconds
+        int64_t last{0};
+        int64_t total{0};
+        int64_t max{0};
+    };
+
+    //! The staker built hash on a kernel it found at time_found (in microseconds)
+    void Staked(const uint256& hash, int64_t time_found);
+    //! hash was announced to a peer
+    void Announced(const uint256& hash);
+    Stats GetStats() const;
+
+private:
+    mutable Mutex m_mutex;
+    //! Lets Announced() skip the lock when no staked block waits for its first peer
+    std::atomic<bool> m_pending{false};
+    uint256 m_pending_hash GUARDED_BY(m_mutex);
+    int64_t m_pending_time GUARDED_BY(m_mutex){0};
+    Stats m_stats GUARDED_BY(m_mutex);
+};
+
+extern CStakeLatency g_stake_latency;
+
 #ifdef ENABLE_WALLET
 /** Generate a new block, without valid proof-of-work */
 void StakeBPSs(bool fStake, CWallet *pwallet, CConnman* connman, ChainstateManager* chainman, CTxMemPool* mempool, boost::thread_group*& stakeThread);
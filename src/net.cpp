@@ -12,6 +12,7 @@
 #include <banman.h>
 #include <clientversion.h>
 #include <consensus/consensus.h>
+#include <crypto/common.h>
 #include <crypto/neuralleadqhash_interface.h>
 #include <net_permissions.h>
 #include <netbase.h>
@@ -45,6 +46,8 @@ static_assert(MINIUPNPC_API_VERSION >= 10, "miniUPnPc API version >= 10 assumed"
 #include <cstdint>
 #include <unordered_map>
 
+#include <crc32c/crc32c.h>
+
 #include <math.h>
 
 /** Maximum number of block-relay-only anchor connections */
@@ -600,6 +603,9 @@ void CNode::copyStats(CNodeStats &stats, const std::vector<bool> &m_asmap)
     }
     X(m_legacyWhitelisted);
     X(m_permissionFlags);
+    stats.m_fast_checksum_send = m_serializer->FastChecksumEnabled();
+    stats.m_fast_checksum_recv = m_deserializer->AcceptsFastChecksum();
+    stats.m_checksum_time = m_serializer->GetChecksumTime() + m_deserializer->GetChecksumTime();
     if (m_tx_relay != nullptr) {
         LOCK(m_tx_relay->cs_feeFilter);
         stats.minFeeFilter = m_tx_relay->minFeeFilter;
@@ -724,6 +730,7 @@ int V1TransportDeserializer::readHeader(const char *pch, unsigned int nBytes)
 
     // switch state to reading message data
     in_data = true;
+    fast_checksum = m_accept_fast_checksum;
 
     return nCopy;
 }
@@ -738,7 +745,13 @@ int V1TransportDeserializer::readData(const char *pch, unsigned int nBytes)
         vRecv.resize(std::min(hdr.nMessageSize, nDataPos + nCopy + 256 * 1024));
     }
 
-    hasher.Write({(const unsigned char*)pch, nCopy});
+    const int64_t checksum_start = GetTimeMicros();
+    if (fast_checksum) {
+        data_crc = crc32c::Extend(data_crc, (const uint8_t*)pch, nCopy);
+    } else {
+        hasher.Write({(const unsigned char*)pch, nCopy});
+    }
+    m_checksum_time_us += GetTimeMicros() - checksum_start;
     memcpy(&vRecv[nDataPos], pch, nCopy);
     nDataPos += nCopy;
 
@@ -753,8 +766,30 @@ const uint256& V1TransportDeserializer::GetMessageHash() const
     return data_hash;
 }
 
+bool V1TransportDeserializer::VerifyChecksum(unsigned char computed[CMessageHeader::CHECKSUM_SIZE])
+{
+    if (fast_checksum) {
+        WriteLE32(computed, data_crc);
+        if (memcmp(computed, hdr.pchChecksum, CMessageHeader::CHECKSUM_SIZE) == 0) return true;
+        // Messages the peer sent before it received our fastchecksum still
+        // carry the QHash checksum, which is only worth computing when enforced
+        if (!mostSecure) return false;
+    }
+
+    const int64_t checksum_start = GetTimeMicros();
+    if (fast_checksum) hasher.Write({(const unsigned char*)vRecv.data(), vRecv.size()});
+    const uint256& hash = GetMessageHash();
+    m_checksum_time_us += GetTimeMicros() - checksum_start;
+    memcpy(computed, hash.begin(), CMessageHeader::CHECKSUM_SIZE);
+    return memcmp(computed, hdr.pchChecksum, CMessageHeader::CHECKSUM_SIZE) == 0;
+}
+
 Optional<CNetMessage> V1TransportDeserializer::GetMessage(const std::chrono::microseconds time, uint32_t& out_err_raw_size)
 {
+    // verify the checksum while vRecv still holds the payload
+    unsigned char checksum[CMessageHeader::CHECKSUM_SIZE];
+    const bool checksum_ok = VerifyChecksum(checksum);
+
     // decompose a single CNetMessage from the TransportDeserializer
     Optional<CNetMessage> msg(std::move(vRecv));
 
@@ -764,17 +799,15 @@ Optional<CNetMessage> V1TransportDeserializer::GetMessage(const std::chrono::mic
     msg->m_message_size = hdr.nMessageSize;
     msg->m_raw_message_size = hdr.nMessageSize + CMessageHeader::HEADER_SIZE;
 
-    uint256 hash = GetMessageHash();
-
     // We just received a message off the wire, harvest entropy from the time (and the message checksum)
-    RandAddEvent(ReadLE32(hash.begin()));
+    RandAddEvent(ReadLE32(checksum));
 
     // Check checksum and header command string
     // SJR
-    if (mostSecure && memcmp(hash.begin(), hdr.pchChecksum, CMessageHeader::CHECKSUM_SIZE) != 0) {
+    if (mostSecure && !checksum_ok) {
         LogPrint(BCLog::NET, "CHECKSUM ERROR (%s, %u bytes), expected %s was %s, peer=%d\n",
                  SanitizeString(msg->m_command), msg->m_message_size,
-                 HexStr(Span<uint8_t>(hash.begin(), hash.begin() + CMessageHeader::CHECKSUM_SIZE)),
+                 HexStr(checksum),
                  HexStr(hdr.pchChecksum),
                  m_node_id);
         out_err_raw_size = msg->m_raw_message_size;
@@ -794,12 +827,19 @@ Optional<CNetMessage> V1TransportDeserializer::GetMessage(const std::chrono::mic
 }
 
 void V1TransportSerializer::prepareForTransport(CSerializedNetMsg& msg, std::vector<unsigned char>& header) {
-    // create dbl-sha256 checksum
-    uint256 hash = Hash(msg.data);
-
     // create header
     CMessageHeader hdr(Params().MessageStart(), msg.m_type.c_str(), msg.data.size());
-    memcpy(hdr.pchChecksum, hash.begin(), CMessageHeader::CHECKSUM_SIZE);
+
+    const int64_t checksum_start = GetTimeMicros();
+    if (m_fast_checksum) {
+        // create CRC32C checksum, for peers that announced fastchecksum
+        WriteLE32(hdr.pchChecksum, crc32c::Crc32c(msg.data.data(), msg.data.size()));
+    } else {
+        // create dbl-sha256 checksum
+        uint256 hash = Hash(msg.data);
+        memcpy(hdr.pchChecksum, hash.begin(), CMessageHeader::CHECKSUM_SIZE);
+    }
+    m_checksum_time_us += GetTimeMicros() - checksum_start;
 
     // serialize header
     header.reserve(CMessageHeader::HEADER_SIZE);
@@ -2985,8 +3025,8 @@ CNode::CNode(NodeId idIn, ServiceFlags nLocalServicesIn, int nMyStartingHeightIn
         LogPrint(BCLog::NET, "Added connection peer=%d\n", id);
     }
 
-    m_deserializer = MakeUnique<V1TransportDeserializer>(V1TransportDeserializer(Params(), GetId(), SER_NETWORK, INIT_PROTO_VERSION));
-    m_serializer = MakeUnique<V1TransportSerializer>(V1TransportSerializer());
+    m_deserializer = MakeUnique<V1TransportDeserializer>(Params(), GetId(), SER_NETWORK, INIT_PROTO_VERSION);
+    m_serializer = MakeUnique<V1TransportSerializer>();
 }
 
 CNode::~CNode()
@@ -88,6 +88,8 @@ static const int64_t DEFAULT_PEER_CONNECT_TIMEOUT = 60;
 static const bool DEFAULT_FORCEDNSSEED = false;
 static const size_t DEFAULT_MAXRECEIVEBUFFER = 5 * 1000;
 static const size_t DEFAULT_MAXSENDBUFFER    = 1 * 1000;
+/** Default for -fastchecksum, negotiating CRC32C message checksums with peers */
+static const bool DEFAULT_FAST_CHECKSUM = true;
 
 typedef int64_t NodeId;
 
@@ -723,6 +725,12 @@ public:
     std::string m_network;
     uint32_t m_mapped_as;
     std::string m_conn_type_string;
+    // Whether the messages we send to this peer carry a CRC32C checksum
+    bool m_fast_checksum_send;
+    // Whether we accept CRC32C checksums from this peer
+    bool m_fast_checksum_recv;
+    // Time spent computing message checksums, both directions
+    std::chrono::microseconds m_checksum_time;
 };
 
 
@@ -761,6 +769,11 @@ public:
     virtual int Read(const char *data, unsigned int bytes) = 0;
     // decomposes a message from the context
     virtual Optional<CNetMessage> GetMessage(std::chrono::microseconds time, uint32_t& out_err) = 0;
+    // accept the fast checksum from now on, before announcing it to the peer
+    virtual void AcceptFastChecksum() = 0;
+    virtual bool AcceptsFastChecksum() const = 0;
+    // time spent computing checksums of received messages
+    virtual std::chrono::microseconds GetChecksumTime() const = 0;
     virtual ~TransportDeserializer() {}
 };
 
@@ -771,6 +784,11 @@ private:
     const NodeId m_node_id; // Only for logging
     mutable CHash256 hasher;
     mutable uint256 data_hash;
+    // CRC32C of the data received so far, for messages started after AcceptFastChecksum()
+    uint32_t data_crc;
+    bool fast_checksum;             // whether data_crc (true) or hasher (false) is fed
+    std::atomic<bool> m_accept_fast_checksum{false};
+    std::atomic<int64_t> m_checksum_time_us{0};
     bool in_data;                   // parsing header (false) or data (true)
     CDataStream hdrbuf;             // partially received header
     CMessageHeader hdr;             // complete header
@@ -779,6 +797,8 @@ private:
     unsigned int nDataPos;
 
     const uint256& GetMessageHash() const;
+    /** Check the checksum of the complete message, setting computed to the one expected. */
+    bool VerifyChecksum(unsigned char computed[CMessageHeader::CHECKSUM_SIZE]);
     int readHeader(const char *pch, unsigned int nBytes);
     int readData(const char *pch, unsigned int nBytes);
 
@@ -791,6 +811,8 @@ private:
         nDataPos = 0;
         data_hash.SetNull();
         hasher.Reset();
+        data_crc = 0;
+        fast_checksum = false;
     }
 
 public:
@@ -820,6 +842,9 @@ public:
         return ret;
     }
     Optional<CNetMessage> GetMessage(std::chrono::microseconds time, uint32_t& out_err_raw_size) override;
+    void AcceptFastChecksum() override { m_accept_fast_checksum = true; }
+    bool AcceptsFastChecksum() const override { return m_accept_fast_checksum; }
+    std::chrono::microseconds GetChecksumTime() const override { return std::chrono::microseconds{m_checksum_time_us.load()}; }
 };
 
 /** The TransportSerializer prepares messages for the network transport
@@ -828,12 +853,24 @@ class TransportSerializer {
 public:
     // prepare message for transport (header construction, error-correction computation, payload encryption, etc.)
     virtual void prepareForTransport(CSerializedNetMsg& msg, std::vector<unsigned char>& header) = 0;
+    // use the fast checksum for the messages prepared from now on
+    virtual void EnableFastChecksum() = 0;
+    virtual bool FastChecksumEnabled() const = 0;
+    // time spent computing checksums of sent messages
+    virtual std::chrono::microseconds GetChecksumTime() const = 0;
     virtual ~TransportSerializer() {}
 };
 
 class V1TransportSerializer  : public TransportSerializer {
+private:
+    std::atomic<bool> m_fast_checksum{false};
+    std::atomic<int64_t> m_checksum_time_us{0};
+
 public:
     void prepareForTransport(CSerializedNetMsg& msg, std::vector<unsigned char>& header) override;
+    void EnableFastChecksum() override { m_fast_checksum = true; }
+    bool FastChecksumEnabled() const override { return m_fast_checksum; }
+    std::chrono::microseconds GetChecksumTime() const override { return std::chrono::microseconds{m_checksum_time_us.load()}; }
 };
 
 /** Information about a peer */
@@ -9,11 +9,13 @@
 #include <banman.h>
 #include <blockencodings.h>
 #include <blockfilter.h>
+#include <blockindexcold.h>
 #include <chainparams.h>
 #include <consensus/validation.h>
 #include <hash.h>
 #include <index/blockfilterindex.h>
 #include <merkleblock.h>
+#include <miner.h>
 #include <netbase.h>
 #include <netmessagemaker.h>
 #include <policy/fees.h>
@@ -1455,6 +1457,7 @@ void PeerManager::NewPoWValidBlock(const CBlockIndex *pindex, const std::shared_
                     hashBlock.ToString(), pnode->GetId());
             m_connman.PushMessage(pnode, msgMaker.Make(NetMsgType::CMPCTBLOCK, *pcmpctblock));
             state.pindexBestHeaderSent = pindex;
+            g_stake_latency.Announced(hashBlock);
         }
     });
 }
@@ -2526,6 +2529,12 @@ void PeerManager::ProcessMessage(CNode& pfrom, const std::string& msg_type, CDat
             m_connman.PushMessage(&pfrom, msg_maker.Make(NetMsgType::WTXIDRELAY));
         }
 
+        if (gArgs.GetBoolArg("-fastchecksum", DEFAULT_FAST_CHECKSUM)) {
+            // Accept CRC32C checksums before the peer can learn that we do
+            pfrom.m_deserializer->AcceptFastChecksum();
+            m_connman.PushMessage(&pfrom, msg_maker.Make(NetMsgType::FASTCHECKSUM));
+        }
+
         m_connman.PushMessage(&pfrom, msg_maker.Make(NetMsgType::VERACK));
 
         // Signal ADDRv2 support (BIP155).
@@ -2702,6 +2711,20 @@ void PeerManager::ProcessMessage(CNode& pfrom, const std::string& msg_type, CDat
         return;
     }
 
+    // Like wtxidrelay, fastchecksum is negotiated between VERSION and VERACK
+    if (msg_type == NetMsgType::FASTCHECKSUM) {
+        if (pfrom.fSuccessfullyConnected) {
+            pfrom.fDisconnect = true;
+            return;
+        }
+        // Only switch if we announced fastchecksum too, so that the peer accepts it
+        if (pfrom.m_deserializer->AcceptsFastChecksum() && !pfrom.m_serializer->FastChecksumEnabled()) {
+            LogPrint(BCLog::NET, "using CRC32C message checksums with peer=%d\n", pfrom.GetId());
+            pfrom.m_serializer->EnableFastChecksum();
+        }
+        return;
+    }
+
     if (!pfrom.fSuccessfullyConnected) {
         LogPrint(BCLog::NET, "Unsupported message \"%s\" prior to verack from peer=%d\n", SanitizeString(msg_type), pfrom.GetId());
         return;
@@ -3031,7 +3054,7 @@ void PeerManager::ProcessMessage(CNode& pfrom, const std::string& msg_type, CDat
             return;
         }
 
-        LOCK(cs_main);
+        WAIT_LOCK(cs_main, lock);
         if (::ChainstateActive().IsInitialBlockDownload() && !pfrom.HasPermission(PF_DOWNLOAD)) {
             LogPrint(BCLog::NET, "Ignoring getheaders from peer=%d because node is in initial block download\n", pfrom.GetId());
             return;
@@ -3062,11 +3085,13 @@ void PeerManager::ProcessMessage(CNode& pfrom, const std::string& msg_type, CDat
 
         // we must use CBlocks, as CBlockHeaders won't include the 0x00 nTx count at the end
         std::vector<CBlock> vHeaders;
+        std::vector<std::pair<uint256, int>> vHeaderEntries;
         int nLimit = MAX_HEADERS_RESULTS;
         LogPrint(BCLog::NET, "getheaders %d to %s from peer=%d\n", (pindex ? pindex->nHeight : -1), hashStop.IsNull() ? "end" : hashStop.ToString(), pfrom.GetId());
         for (; pindex; pindex = ::ChainActive().Next(pindex))
         {
-            vHeaders.push_back(pindex->GetBlockHeader());
+            vHeaders.push_back(pindex->GetHotBlockHeader());
+            vHeaderEntries.emplace_back(pindex->GetBlockHash(), pindex->nHeight);
             if (--nLimit <= 0 || pindex->GetBlockHash() == hashStop)
                 break;
         }
@@ -3083,6 +3108,13 @@ void PeerManager::ProcessMessage(CNode& pfrom, const std::string& msg_type, CDat
         // will re-announce the new block via headers (or compact blocks again)
         // in the SendMessages logic.
         nodestate->pindexBestHeaderSent = pindex ? pindex : ::ChainActive().Tip();
+
+        // Headers deep in the chain have their block signature in the block
+        // tree DB, read them without holding cs_main
+        REVERSE_LOCK(lock);
+        for (size_t i = 0; i < vHeaders.size(); ++i) {
+            vHeaders[i].vchBlockSig = g_block_index_cold.Get(vHeaderEntries[i].first, vHeaderEntries[i].second).vchBlockSig;
+        }
         m_connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::HEADERS, vHeaders));
         return;
     }
@@ -4411,6 +4443,7 @@ bool PeerManager::SendMessages(CNode* pto)
                         m_connman.PushMessage(pto, msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK, cmpctblock));
                     }
                     state.pindexBestHeaderSent = pBestIndex;
+                    g_stake_latency.Announced(pBestIndex->GetBlockHash());
                 } else if (state.fPreferHeaders) {
                     if (vHeaders.size() > 1) {
                         LogPrint(BCLog::NET, "%s: %u headers, range (%s, %s), to peer=%d\n", __func__,
@@ -4423,6 +4456,7 @@ bool PeerManager::SendMessages(CNode* pto)
                     }
                     m_connman.PushMessage(pto, msgMaker.Make(NetMsgType::HEADERS, vHeaders));
                     state.pindexBestHeaderSent = pBestIndex;
+                    g_stake_latency.Announced(pBestIndex->GetBlockHash());
                 } else
                     fRevertToInv = true;
             }
@@ -4465,6 +4499,7 @@ bool PeerManager::SendMessages(CNode* pto)
             // Add blocks
             for (const uint256& hash : pto->vInventoryBlockToSend) {
                 vInv.push_back(CInv(MSG_BLOCK, hash));
+                g_stake_latency.Announced(hash);
                 if (vInv.size() == MAX_INV_SZ) {
                     m_connman.PushMessage(pto, msgMaker.Make(NetMsgType::INV, vInv));
                     vInv.clear();
@@ -5058,8 +5093,8 @@ void CleanBlockIndex()
                         CBlockIndex *pindex = (*it).second;
                         if(RemoveBlockIndex(pindex))
                         {
-                            delete pindex;
                             ::BlockIndex().erase(it);
+                            g_block_index_cold.Erase(blockHash);
                         }
                     }
                 }
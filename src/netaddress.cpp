@@ -6,6 +6,7 @@
 #include <netaddress.h>
 
 #include <crypto/common.h>
+#include <crypto/sha256.h>
 #include <crypto/sha3.h>
 #include <hash.h>
 #include <prevector.h>
@@ -189,7 +190,7 @@ bool CNetAddr::SetInternal(const std::string &name)
     }
     m_net = NET_INTERNAL;
     unsigned char hash[32] = {};
-    NeuralLeadQHash_iface().Write((const unsigned char*)name.data(), name.size()).Finalize(hash);
+    CSHA256().Write((const unsigned char*)name.data(), name.size()).Finalize(hash);
     m_addr.assign(hash, hash + ADDR_INTERNAL_SIZE);
     return true;
 }
@@ -0,0 +1,132 @@
+// Copyright (c) 2024 The NeuralLead developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <neuralleadnetio.h>
+
+#include <fstream>
+#include <iterator>
+
+#include <univalue.h>
+
+#if defined(_WIN32) || defined(_WIN64) || defined(__MINGW32__)
+#define NLNET_PATH_SEP "\\"
+#else
+#define NLNET_PATH_SEP "/"
+#endif
+
+namespace {
+
+bool ReadJsonFile(const std::string& path, UniValue& v, std::string& error)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        error = "cannot open " + path;
+        return false;
+    }
+    const std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (!v.read(data) || !v.isObject()) {
+        error = "cannot parse " + path;
+        return false;
+    }
+    return true;
+}
+
+/** Neurons of a group, from its Grid. */
+bool GroupSize(const UniValue& group, uint32_t& size)
+{
+    const UniValue& grid = find_value(group, "Grid");
+    if (!grid.isArray() || grid.empty()) return false;
+    double n = 1;
+    for (const UniValue& d : grid.getValues()) {
+        if (!d.isNum()) return false;
+        n *= d.get_real();
+    }
+    if (n < 1 || n > 65536) return false;
+    size = (uint32_t)n;
+    return true;
+}
+
+bool ReadLayer(const std::string& path, uint32_t index, uint32_t prev_size, NeuralLeadNet::LayerSpec& layer, std::string& error)
+{
+    UniValue group;
+    if (!ReadJsonFile(path, group, error)) return false;
+
+    uint32_t size;
+    const UniValue& model = find_value(group, "Model");
+    const UniValue& params = find_value(group, "params");
+    const UniValue& biases = find_value(group, "UseBiases");
+    const UniValue& dropout = find_value(group, "DropOut");
+    const UniValue& neurons = find_value(group, "Neurons");
+    if (!model.isStr() || model.get_str() != "Trad" || !GroupSize(group, size)) {
+        error = path + ": not a traditional group";
+        return false;
+    }
+    if (biases.isTrue() || (dropout.isNum() && dropout.get_real() != 0)) {
+        error = path + ": biases and dropout are not supported";
+        return false;
+    }
+    if (!params.isArray() || params.size() != 1 || !params[0].isStr()) {
+        error = path + ": missing activation";
+        return false;
+    }
+    if (params[0].get_str() == "Sigmoid") {
+        layer.act = NeuralLeadNet::Activation::SIGMOID;
+    } else if (params[0].get_str() == "EvenXorNot") {
+        layer.act = NeuralLeadNet::Activation::EVEN_XOR_NOT;
+    } else {
+        error = path + ": unsupported activation " + params[0].get_str();
+        return false;
+    }
+    if (!neurons.isArray() || neurons.size() != size) {
+        error = path + ": neuron count does not match Grid";
+        return false;
+    }
+
+    layer.synapses.assign(size, {});
+    for (uint32_t n = 0; n < size; ++n) {
+        const UniValue& pre = find_value(neurons[n], "preSynapses");
+        if (!pre.isArray()) continue;
+        for (const UniValue& syn : pre.getValues()) {
+            const UniValue& prep = find_value(syn, "prep");
+            const UniValue& prec = find_value(syn, "prec");
+            const UniValue& weight = find_value(syn, "Weight");
+            const UniValue& delay = find_value(syn, "Delay");
+            if (!prep.isNum() || !prec.isNum() || !weight.isNum() || prep.get_real() != index - 1 ||
+                prec.get_real() < 0 || prec.get_real() >= prev_size) {
+                error = path + ": synapse does not come from the previous group";
+                return false;
+            }
+            if (delay.isNum() && delay.get_real() != 0) {
+                error = path + ": delayed synapses are not supported";
+                return false;
+            }
+            layer.synapses[n].push_back({(uint32_t)prec.get_real(), (float)weight.get_real()});
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool ReadNeuralLeadNetLayers(const std::string& dir, std::vector<NeuralLeadNet::LayerSpec>& layers, std::string& error)
+{
+    layers.clear();
+
+    const std::string base = dir + NLNET_PATH_SEP + "neuralleadhash_";
+    UniValue input;
+    uint32_t input_size = 0;
+    if (!ReadJsonFile(base + "InputTo.coscienza.brain", input, error)) return false;
+    if (!GroupSize(input, input_size) || input_size != NeuralLeadNet::INPUTS) {
+        error = "unexpected InputTo group size";
+        return false;
+    }
+
+    layers.resize(2);
+    if (!ReadLayer(base + "s1.coscienza.brain", 1, NeuralLeadNet::INPUTS, layers[0], error) ||
+        !ReadLayer(base + "to.coscienza.brain", 2, layers[0].synapses.size(), layers[1], error)) {
+        layers.clear();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,22 @@
+// Copyright (c) 2024 The NeuralLead developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_NEURALLEADNETIO_H
+#define BITCOIN_NEURALLEADNETIO_H
+
+#include <crypto/neuralleadnet.h>
+
+#include <string>
+#include <vector>
+
+/** Directory of the neuralleadhash brain files, relative to the working directory. */
+static const char* const NEURALLEADNET_DIR = "neuralleadqhash";
+
+/** Read the s1 and to groups of the neuralleadhash network from the
+ * *.coscienza.brain files in dir, for NeuralLeadNet::Load() and
+ * SetNeuralNetBackend(). Only traditional groups without biases, dropout or
+ * delayed synapses are accepted. */
+bool ReadNeuralLeadNetLayers(const std::string& dir, std::vector<NeuralLeadNet::LayerSpec>& layers, std::string& error);
+
+#endif // BITCOIN_NEURALLEADNETIO_H
@@ -0,0 +1 @@
+#define BUILD_GIT_COMMIT "bf0fdf7"
@@ -53,6 +53,55 @@ CAmount GetNormalizedAmount(CAmount absoluteAmount, const Consensus::Params& par
     return absoluteAmount;
 }
 
+static arith_uint256 GetStakeKernelTarget(unsigned int nBits, int currentBlockHeight, CAmount prevoutValue)
+{
+    // Base target
+    arith_uint256 bnTarget;
+    bnTarget.SetCompact(nBits);
+    
+    // With the normalized value, all stakers of the same size have the opportunity to stake.
+    // Instead of using the absolute balance, the balance value is adjusted to the staker's class (small, medium, and big).
+    // This way, stakers all have the chance to mine, albeit with different priorities.
+    int64_t nValueIn;
+    if(currentBlockHeight >= 2774)
+        nValueIn = GetNormalizedAmount(prevoutValue, Params().GetConsensus());
+    else
+        nValueIn = prevoutValue;
+    
+    // Weighted target
+    arith_uint256 bnWeight = arith_uint256(nValueIn);
+    bnTarget *= bnWeight;
+    return bnTarget;
+}
+
+CHash256 GetStakeKernelMidstate(const uint256& nStakeModifier, uint32_t blockFromTime, const COutPoint& prevout)
+{
+    // Same bytes as serializing nStakeModifier, blockFromTime and prevout.hash
+    unsigned char time[4];
+    WriteLE32(time, blockFromTime);
+    CHash256 hasher;
+    hasher.Write(nStakeModifier).Write(time).Write(prevout.hash);
+    return hasher;
+}
+
+bool CheckStakeKernelHash(const CHash256& midstate, unsigned int nBits, uint32_t blockFromTime, int currentBlockHeight, CAmount prevoutValue, const COutPoint& prevout, unsigned int nTimeBlock, uint256& hashProofOfStake, uint256& targetProofOfStake)
+{
+    if (nTimeBlock < blockFromTime)  // Transaction timestamp violation
+        return error("CheckStakeKernelHash() : nTime violation");
+
+    arith_uint256 bnTarget = GetStakeKernelTarget(nBits, currentBlockHeight, prevoutValue);
+    targetProofOfStake = ArithToUint256(bnTarget);
+
+    // Calculate hash, finishing the preimage with prevout.n and nTimeBlock
+    unsigned char tail[8];
+    WriteLE32(tail, prevout.n);
+    WriteLE32(tail + 4, nTimeBlock);
+    CHash256(midstate).Write(tail).Finalize(hashProofOfStake);
+
+    // Now check if proof-of-stake hash meets target protocol
+    return UintToArith256(hashProofOfStake) <= bnTarget;
+}
+
 // BPS kernel protocol
 // coinstake must meet hash target according to the protocol:
 // kernel (input 0) must meet the formula
@@ -74,35 +123,10 @@ CAmount GetNormalizedAmount(CAmount absoluteAmount, const Consensus::Params& par
 //
 bool CheckStakeKernelHash(CBlockIndex* pindexPrev, unsigned int nBits, uint32_t blockFromTime, int currentBlockHeight, CAmount prevoutValue, const COutPoint& prevout, unsigned int nTimeBlock, uint256& hashProofOfStake, uint256& targetProofOfStake, bool fPrintProofOfStake)
 {
-    if (nTimeBlock < blockFromTime)  // Transaction timestamp violation
-        return error("CheckStakeKernelHash() : nTime violation");
-
-    // Base target
-    arith_uint256 bnTarget;
-    bnTarget.SetCompact(nBits);
-    
-    // With the normalized value, all stakers of the same size have the opportunity to stake.
-    // Instead of using the absolute balance, the balance value is adjusted to the staker's class (small, medium, and big).
-    // This way, stakers all have the chance to mine, albeit with different priorities.
-    int64_t nValueIn;
-    if(currentBlockHeight >= 2774)
-        nValueIn = GetNormalizedAmount(prevoutValue, Params().GetConsensus());
-    else
-        nValueIn = prevoutValue;
-    
-    // Weighted target
-    arith_uint256 bnWeight = arith_uint256(nValueIn);
-    bnTarget *= bnWeight;
-
-    targetProofOfStake = ArithToUint256(bnTarget);
-
     uint256 nStakeModifier = pindexPrev->nStakeModifier;
 
-    // Calculate hash
-    CDataStream ss(SER_GETHASH, 0);
-    ss << nStakeModifier;
-    ss << blockFromTime << prevout.hash << prevout.n << nTimeBlock;
-    hashProofOfStake = Hash(ss);
+    bool fKernel = CheckStakeKernelHash(GetStakeKernelMidstate(nStakeModifier, blockFromTime, prevout), nBits, blockFromTime, currentBlockHeight,
+                                        prevoutValue, prevout, nTimeBlock, hashProofOfStake, targetProofOfStake);
 
     if (fPrintProofOfStake) {
         LogPrint(BCLog::COINSTAKE, "CheckStakeKernelHash() : check modifier=%s nTimeBlockFrom=%u nPrevout=%u nTimeBlock=%u hashProof=%s\n",
@@ -111,17 +135,11 @@ bool CheckStakeKernelHash(CBlockIndex* pindexPrev, unsigned int nBits, uint32_t
             hashProofOfStake.ToString());
     }
 
-    // Now check if proof-of-stake hash meets target protocol
-    if (UintToArith256(hashProofOfStake) > bnTarget)
-    {
-        return false;
-    }
-    
-    return true;
+    return fKernel;
 }
 
 // Check kernel hash target and coinstake signature
-bool CheckProofOfStake(CBlockIndex* pindexPrev, BlockValidationState& state, const CTransaction& tx, unsigned int nBits, uint32_t nTimeBlock, uint256& hashProofOfStake, uint256& targetProofOfStake, CCoinsViewCache& view)
+bool CheckProofOfStake(CBlockIndex* pindexPrev, BlockValidationState& state, const CTransaction& tx, unsigned int nBits, uint32_t nTimeBlock, uint256& hashProofOfStake, uint256& targetProofOfStake, CCoinsViewCache& view, const uint256* pHashProofOfStake)
 {
     if (!tx.IsCoinStake())
         return error("CheckProofOfStake() : called on non-coinstake %s", tx.GetHash().ToString());
@@ -149,6 +167,13 @@ bool CheckProofOfStake(CBlockIndex* pindexPrev, BlockValidationState& state, con
         return state.Invalid(BlockValidationResult::BLOCK_INVALID_HEADER, "bad-stake-signature-verify", 
                             strprintf("CheckProofOfStake() : VerifySignature failed on coinstake %s", tx.GetHash().ToString()));
 
+    // The kernel of a block this node staked was checked when it was signed
+    if (pHashProofOfStake) {
+        hashProofOfStake = *pHashProofOfStake;
+        targetProofOfStake = ArithToUint256(GetStakeKernelTarget(nBits, pindexPrev->nHeight + 1, coinPrev.out.nValue));
+        return true;
+    }
+
     if (!CheckStakeKernelHash(pindexPrev, nBits, blockFrom->nTime, pindexPrev->nHeight+1, coinPrev.out.nValue, txin.prevout, nTimeBlock, hashProofOfStake, targetProofOfStake, true))
         // may occur during initial download or if behind on block chain sync
         return state.Invalid(BlockValidationResult::BLOCK_HEADER_SYNC, "bad-stake-kernel-check", 
@@ -208,7 +233,29 @@ bool CheckBlockInputPubKeyMatchesOutputPubKey(const CBlock& block, CCoinsViewCac
     return true;
 }
 
-bool CheckRecoveredPubKeyFromBlockSignature(CBlockIndex* pindexPrev, const CBlockHeader& block, CCoinsViewCache& view) {
+bool RecoverBlockSigners(const CBlockHeader& block, std::vector<CKeyID>& signers) {
+    signers.clear();
+    if(block.vchBlockSig.empty()) {
+        return false;
+    }
+
+    uint256 hash = block.GetHashWithoutSign();
+    for(uint8_t recid = 0; recid <= 3; ++recid) {
+        // One recovery gives the key in both encodings
+        CPubKey pubkey;
+        if(!pubkey.RecoverLaxDER(hash, block.vchBlockSig, recid, true)) {
+            continue;
+        }
+        signers.push_back(pubkey.GetID());
+        if(pubkey.Decompress()) {
+            signers.push_back(pubkey.GetID());
+        }
+    }
+
+    return true;
+}
+
+bool CheckRecoveredPubKeyFromBlockSignature(CBlockIndex* pindexPrev, const CBlockHeader& block, CCoinsViewCache& view, const std::vector<CKeyID>* signers) {
     Coin coinPrev;
     if(!view.GetCoin(block.prevoutStake, coinPrev)){
         if(!GetSpentCoinFromMainChain(pindexPrev, block.prevoutStake, &coinPrev)) {
@@ -216,26 +263,23 @@ bool CheckRecoveredPubKeyFromBlockSignature(CBlockIndex* pindexPrev, const CBloc
         }
     }
 
-    uint256 hash = block.GetHashWithoutSign();
-    CPubKey pubkey;
-
     if(block.vchBlockSig.empty()) {
         return error("CheckRecoveredPubKeyFromBlockSignature(): Signature is empty\n");
     }
 
-    for(uint8_t recid = 0; recid <= 3; ++recid) {
-        for(uint8_t compressed = 0; compressed < 2; ++compressed) {
-            if(!pubkey.RecoverLaxDER(hash, block.vchBlockSig, recid, compressed)) {
-                continue;
-            }
+    std::vector<CKeyID> recovered;
+    if(!signers) {
+        RecoverBlockSigners(block, recovered);
+        signers = &recovered;
+    }
 
-            CTxDestination address;
-            TxoutType txType=TxoutType::NONSTANDARD;
-            if(ExtractDestination(coinPrev.out.scriptPubKey, address, &txType, true)){
-                if ((txType == TxoutType::PUBKEY || txType == TxoutType::PUBKEYHASH || txType == TxoutType::COLDSTAKE) && address.type() == typeid(PKHash)) {
-                    if(PKHash(pubkey.GetID()) == boost::get<PKHash>(address)) {
-                        return true;
-                    }
+    CTxDestination address;
+    TxoutType txType=TxoutType::NONSTANDARD;
+    if(ExtractDestination(coinPrev.out.scriptPubKey, address, &txType, true)){
+        if ((txType == TxoutType::PUBKEY || txType == TxoutType::PUBKEYHASH || txType == TxoutType::COLDSTAKE) && address.type() == typeid(PKHash)) {
+            for(const CKeyID& signer : *signers) {
+                if(PKHash(signer) == boost::get<PKHash>(address)) {
+                    return true;
                 }
             }
         }
@@ -244,181 +288,171 @@ bool CheckRecoveredPubKeyFromBlockSignature(CBlockIndex* pindexPrev, const CBloc
     return false;
 }
 
-bool CheckKernel(CBlockIndex* pindexPrev, unsigned int nBits, uint32_t nTimeBlock, const COutPoint& prevout, CCoinsViewCache& view)
+bool CheckKernel(CBlockIndex* pindexPrev, unsigned int nBits, uint32_t nTimeBlock, const COutPoint& prevout, CCoinsViewCache& view, uint256* pHashProofOfStake)
 {
-    std::map<COutPoint, CStakeCache> tmp;
-    return CheckKernel(pindexPrev, nBits, nTimeBlock, prevout, view, tmp);
+    uint256 hashProofOfStake, targetProofOfStake;
+    Coin coinPrev;
+    if(!view.GetCoin(prevout, coinPrev)){
+        if(!GetSpentCoinFromMainChain(pindexPrev, prevout, &coinPrev)) {
+            return error("CheckKernel(): Could not find coin and it was not at the tip");
+        }
+    }
+
+    if(pindexPrev->nHeight + 1 - coinPrev.nHeight < COINBASE_MATURITY){
+        return error("CheckKernel(): Coin not matured");
+    }
+    CBlockIndex* blockFrom = pindexPrev->GetAncestor(coinPrev.nHeight);
+    if(!blockFrom) {
+        return error("CheckKernel(): Could not find block");
+    }
+    if(coinPrev.IsSpent()){
+        return error("CheckKernel(): Coin is spent");
+    }
+
+    bool fKernel = CheckStakeKernelHash(pindexPrev, nBits, blockFrom->nTime, pindexPrev->nHeight + 1, coinPrev.out.nValue, prevout,
+                                        nTimeBlock, hashProofOfStake, targetProofOfStake);
+    if (pHashProofOfStake) *pHashProofOfStake = hashProofOfStake;
+    return fKernel;
 }
 
-bool CheckKernel(CBlockIndex* pindexPrev, unsigned int nBits, uint32_t nTimeBlock, const COutPoint& prevout, CCoinsViewCache& view, const std::map<COutPoint, CStakeCache>& cache)
+bool CheckKernel(CBlockIndex* pindexPrev, unsigned int nBits, uint32_t nTimeBlock, const COutPoint& prevout, CCoinsViewCache& view, const StakeCacheMap& cache)
 {
     uint256 hashProofOfStake, targetProofOfStake;
     auto it=cache.find(prevout);
     if(it == cache.end()) {
         //not found in cache (shouldn't happen during staking, only during verification which does not use cache)
-        Coin coinPrev;
-        if(!view.GetCoin(prevout, coinPrev)){
-            if(!GetSpentCoinFromMainChain(pindexPrev, prevout, &coinPrev)) {
-                return error("CheckKernel(): Could not find coin and it was not at the tip");
-            }
-        }
-
-        if(pindexPrev->nHeight + 1 - coinPrev.nHeight < COINBASE_MATURITY){
-            return error("CheckKernel(): Coin not matured");
-        }
-        CBlockIndex* blockFrom = pindexPrev->GetAncestor(coinPrev.nHeight);
-        if(!blockFrom) {
-            return error("CheckKernel(): Could not find block");
-        }
-        if(coinPrev.IsSpent()){
-            return error("CheckKernel(): Coin is spent");
-        }
-
-        return CheckStakeKernelHash(pindexPrev, nBits, blockFrom->nTime, pindexPrev->nHeight + 1, coinPrev.out.nValue, prevout,
-                                    nTimeBlock, hashProofOfStake, targetProofOfStake);
+        return CheckKernel(pindexPrev, nBits, nTimeBlock, prevout, view);
     }
-    else
+
+    //found in cache
+    const CStakeCache& stake = it->second;
+    if(CheckStakeKernelHash(pindexPrev, nBits, stake.blockFromTime, pindexPrev->nHeight+1, stake.amount, prevout,
+                                nTimeBlock, hashProofOfStake, targetProofOfStake))
     {
-        //found in cache
-        const CStakeCache& stake = it->second;
-        if(CheckStakeKernelHash(pindexPrev, nBits, stake.blockFromTime, pindexPrev->nHeight+1, stake.amount, prevout,
-                                    nTimeBlock, hashProofOfStake, targetProofOfStake))
-        {
-            //Cache could potentially cause false positive stakes in the event of deep reorgs, so check without cache also
-            return CheckKernel(pindexPrev, nBits, nTimeBlock, prevout, view);
-        }
+        //Cache could potentially cause false positive stakes in the event of deep reorgs, so check without cache also
+        return CheckKernel(pindexPrev, nBits, nTimeBlock, prevout, view);
     }
     return false;
 }
 
-void CacheKernel(std::map<COutPoint, CStakeCache>& cache, const COutPoint& prevout, CBlockIndex* pindexPrev, CCoinsViewCache& view){
+bool CacheKernel(StakeCacheMap& cache, const COutPoint& prevout, CBlockIndex* pindexPrev, CCoinsViewCache& view){
     if(cache.find(prevout) != cache.end()){
         //already in cache
-        return;
+        return false;
     }
 
     Coin coinPrev;
     if(!view.GetCoin(prevout, coinPrev)){
-        return;
+        return false;
     }
 
     if(pindexPrev->nHeight + 1 - coinPrev.nHeight < COINBASE_MATURITY){
-        return;
+        return false;
     }
     CBlockIndex* blockFrom = pindexPrev->GetAncestor(coinPrev.nHeight);
     if(!blockFrom) {
-        return;
+        return false;
     }
 
-    CStakeCache c(blockFrom->nTime, coinPrev.out.nValue);
+    CStakeCache c(blockFrom->nTime, coinPrev.out.nValue, blockFrom->GetBlockHash());
     cache.insert({prevout, c});
+    return true;
 }
 
 /**
  * Proof-of-stake functions needed in the wallet but wallet independent
  */
-struct ScriptsElement{
-    CScript script;
-    uint256 hash;
-};
 
 /**
  * Cache of the recent mpos scripts for the block reward recipients
- * The max size of the map is 2 * nCacheScripts - nMPoSRewardRecipients, so in this case it is 20
+ * A ring indexed by height modulo nCacheScripts = 1.5 * nMPoSRewardRecipients, which
+ * covers the recipients of the next block with room for the chain to move on. An
+ * element is only used while its block is the one at that height in the active chain.
  */
-std::map<int, ScriptsElement> scriptsMap;
-
-unsigned int GetStakeMaxCombineInputs() { return 40; }
-
-unsigned int GetStakeSplitOutputs() { return 2; }
-
-bool NeedToEraseScriptFromCache(int nBlockHeight, int nCacheScripts, int nScriptHeight, const ScriptsElement& scriptElement)
+class CMPoSScriptCache
 {
-    // Erase element from cache if not in range [nBlockHeight - nCacheScripts, nBlockHeight + nCacheScripts]
-    if(nScriptHeight < (nBlockHeight - nCacheScripts) ||
-            nScriptHeight > (nBlockHeight + nCacheScripts))
-        return true;
-
-    // Erase element from cache if hash different
-    CBlockIndex* pblockindex = ::ChainActive()[nScriptHeight];
-    if(pblockindex && pblockindex->GetBlockHash() != scriptElement.hash)
-        return true;
-
-    return false;
-}
-
-void CleanScriptCache(int nHeight, const Consensus::Params& consensusParams)
-{
-    int nCacheScripts = consensusParams.nMPoSRewardRecipients * 1.5;
-
-    // Remove the scripts from cache that are not used
-    for (std::map<int, ScriptsElement>::iterator it=scriptsMap.begin(); it!=scriptsMap.end();){
-        if(NeedToEraseScriptFromCache(nHeight, nCacheScripts, it->first, it->second))
-        {
-            it = scriptsMap.erase(it);
-        }
-        else {
-            it++;
-        }
-    }
-}
-
-bool ReadFromScriptCache(CScript &script, CBlockIndex* pblockindex, int nHeight, const Consensus::Params& consensusParams)
-{
-    CleanScriptCache(nHeight, consensusParams);
-
-    // Find the script in the cache
-    std::map<int, ScriptsElement>::iterator it = scriptsMap.find(nHeight);
-    if(it != scriptsMap.end())
+public:
+    bool Read(CScript& script, const CBlockIndex* pblockindex, const Consensus::Params& consensusParams)
     {
-        if(it->second.hash == pblockindex->GetBlockHash())
+        LOCK(m_mutex);
+        const ScriptsElement& element = Slot(pblockindex->nHeight, consensusParams);
+        if(element.height == pblockindex->nHeight && element.hash == pblockindex->GetBlockHash())
         {
-            script = it->second.script;
+            script = element.script;
+            m_hits++;
             return true;
         }
+        m_misses++;
+        return false;
     }
 
-    return false;
-}
-
-void AddToScriptCache(CScript script, CBlockIndex* pblockindex, int nHeight, const Consensus::Params& consensusParams)
-{
-    CleanScriptCache(nHeight, consensusParams);
+    bool Contains(const CBlockIndex* pblockindex, const Consensus::Params& consensusParams)
+    {
+        LOCK(m_mutex);
+        const ScriptsElement& element = Slot(pblockindex->nHeight, consensusParams);
+        return element.height == pblockindex->nHeight && element.hash == pblockindex->GetBlockHash();
+    }
 
-    // Add the script into the cache
-    ScriptsElement listElement;
-    listElement.script = script;
-    listElement.hash = pblockindex->GetBlockHash();
-    scriptsMap.insert(std::pair<int, ScriptsElement>(nHeight, listElement));
-}
+    void Add(const CScript& script, const CBlockIndex* pblockindex, const Consensus::Params& consensusParams)
+    {
+        LOCK(m_mutex);
+        ScriptsElement& element = Slot(pblockindex->nHeight, consensusParams);
+        element.height = pblockindex->nHeight;
+        element.hash = pblockindex->GetBlockHash();
+        element.script = script;
+    }
 
-bool AddMPoSScript(std::vector<CScript> &mposScriptList, int nHeight, const Consensus::Params& consensusParams)
-{
-    // Check if the block index exist into the active chain
-    CBlockIndex* pblockindex = ::ChainActive()[nHeight];
-    if(!pblockindex)
+    void LogStats()
     {
-        LogPrint(BCLog::COINSTAKE, "Block index not found\n");
-        return false;
+        LOCK(m_mutex);
+        LogPrint(BCLog::COINSTAKE, "MPoS script cache: %u hits, %u misses\n", m_hits, m_misses);
     }
 
-    // Try find the script from the cache
-    CScript script;
-    if(ReadFromScriptCache(script, pblockindex, nHeight, consensusParams))
+    void GetStats(uint64_t& hits, uint64_t& misses)
     {
-        mposScriptList.push_back(script);
-        return true;
+        LOCK(m_mutex);
+        hits = m_hits;
+        misses = m_misses;
     }
 
-    // Read the block
-    uint160 stakeAddress;
-    if(!pblocktree->ReadStakeIndex(nHeight, stakeAddress)){
-        return false;
+private:
+    struct ScriptsElement{
+        int height = -1;
+        uint256 hash;
+        CScript script;
+    };
+
+    Mutex m_mutex;
+    std::vector<ScriptsElement> m_ring GUARDED_BY(m_mutex);
+    uint64_t m_hits GUARDED_BY(m_mutex) = 0;
+    uint64_t m_misses GUARDED_BY(m_mutex) = 0;
+
+    ScriptsElement& Slot(int nHeight, const Consensus::Params& consensusParams) EXCLUSIVE_LOCKS_REQUIRED(m_mutex)
+    {
+        const size_t nCacheScripts = std::max(1, int(consensusParams.nMPoSRewardRecipients * 1.5));
+        if(m_ring.size() != nCacheScripts)
+            m_ring.assign(nCacheScripts, ScriptsElement());
+        return m_ring[nHeight % nCacheScripts];
     }
+};
+
+static CMPoSScriptCache mposScriptCache;
+
+unsigned int GetStakeMaxCombineInputs() { return 40; }
+
+unsigned int GetStakeSplitOutputs() { return 2; }
 
+// Script paying the staker of pblockindex, from the stake index
+static bool GetMPoSScript(CScript& script, const CBlockIndex* pblockindex)
+{
     // The block reward for PoS is in the second transaction (coinstake) and the second or third output
     if(pblockindex->IsProofOfStake())
     {
+        uint160 stakeAddress;
+        if(!pblocktree->ReadStakeIndex(pblockindex->nHeight, stakeAddress)){
+            return false;
+        }
+
         if(stakeAddress == uint160())
         {
             LogPrint(BCLog::COINSTAKE, "Fail to solve script for mpos reward recipient\n");
@@ -429,29 +463,59 @@ bool AddMPoSScript(std::vector<CScript> &mposScriptList, int nHeight, const Cons
             // Make public key hash script
             script = CScript() << OP_DUP << OP_HASH160 << ToByteVector(stakeAddress) << OP_EQUALVERIFY << OP_CHECKSIG;
         }
+        return true;
+    }
 
-        // Add the script into the list
-        mposScriptList.push_back(script);
-
-        // Update script cache
-        AddToScriptCache(script, pblockindex, nHeight, consensusParams);
+    if(Params().MineBlocksOnDemand()){
+        //this could happen in regtest. Just ignore and add an empty script
+        script = CScript() << OP_RETURN;
+        return true;
     }
-    else
-    {
-        if(Params().MineBlocksOnDemand()){
-            //this could happen in regtest. Just ignore and add an empty script
-            script = CScript() << OP_RETURN;
-            mposScriptList.push_back(script);
-            return true;
+    LogPrint(BCLog::COINSTAKE, "The block is not proof-of-stake\n");
+    return false;
+}
 
-        }
-        LogPrint(BCLog::COINSTAKE, "The block is not proof-of-stake\n");
+bool AddMPoSScript(std::vector<CScript> &mposScriptList, int nHeight, const Consensus::Params& consensusParams)
+{
+    // Check if the block index exist into the active chain
+    CBlockIndex* pblockindex = ::ChainActive()[nHeight];
+    if(!pblockindex)
+    {
+        LogPrint(BCLog::COINSTAKE, "Block index not found\n");
         return false;
     }
 
+    // Try find the script from the cache
+    CScript script;
+    if(!mposScriptCache.Read(script, pblockindex, consensusParams))
+    {
+        if(!GetMPoSScript(script, pblockindex))
+            return false;
+        mposScriptCache.Add(script, pblockindex, consensusParams);
+    }
+
+    // Add the script into the list
+    mposScriptList.push_back(script);
     return true;
 }
 
+void UpdateMPoSScriptCache(const CBlockIndex* pindexNew, const Consensus::Params& consensusParams)
+{
+    // The block on top of pindexNew pays the staker COINBASE_MATURITY blocks back first
+    const CBlockIndex* pblockindex = pindexNew->GetAncestor(pindexNew->nHeight - COINBASE_MATURITY);
+    if(!pblockindex || mposScriptCache.Contains(pblockindex, consensusParams))
+        return;
+
+    CScript script;
+    if(GetMPoSScript(script, pblockindex))
+        mposScriptCache.Add(script, pblockindex, consensusParams);
+}
+
+void GetMPoSScriptCacheStats(uint64_t& hits, uint64_t& misses)
+{
+    mposScriptCache.GetStats(hits, misses);
+}
+
 bool GetMPoSOutputScripts(std::vector<CScript>& mposScriptList, int nHeight, const Consensus::Params& consensusParams)
 {
     bool ret = true;
@@ -462,6 +526,7 @@ bool GetMPoSOutputScripts(std::vector<CScript>& mposScriptList, int nHeight, con
     {
         ret &= AddMPoSScript(mposScriptList, nHeight - i, consensusParams);
     }
+    mposScriptCache.LogStats();
 
     return ret;
 }
@@ -7,6 +7,7 @@
 #define NEURALLEADCOIN_H
 
 #include <chain.h>
+#include <coins.h>
 #include <primitives/transaction.h>
 #include <consensus/validation.h>
 #include <txdb.h>
@@ -18,6 +19,8 @@
 #include <script/sign.h>
 #include <consensus/consensus.h>
 
+#include <unordered_map>
+
 class CBlockHeader;
 class CBlockIndex;
 class uint256;
@@ -27,13 +30,22 @@ class uint256;
 static const uint32_t STAKE_TIMESTAMP_MASK = 15;
 
 struct CStakeCache{
-    CStakeCache(uint32_t blockFromTime_, CAmount amount_) : blockFromTime(blockFromTime_), amount(amount_){
+    CStakeCache() : blockFromTime(0), amount(0){
+    }
+    CStakeCache(uint32_t blockFromTime_, CAmount amount_, const uint256& blockFrom_ = uint256()) : blockFromTime(blockFromTime_), amount(amount_), blockFrom(blockFrom_){
     }
     uint32_t blockFromTime;
     CAmount amount;
+    // Block that created the coin, the entry is only valid while it is in the active chain
+    uint256 blockFrom;
+
+    SERIALIZE_METHODS(CStakeCache, obj) { READWRITE(obj.blockFromTime, obj.amount, obj.blockFrom); }
 };
 
-void CacheKernel(std::map<COutPoint, CStakeCache>& cache, const COutPoint& prevout, CBlockIndex* pindexPrev, CCoinsViewCache& view);
+typedef std::unordered_map<COutPoint, CStakeCache, SaltedOutpointHasher> StakeCacheMap;
+
+// Add the kernel data of prevout to the cache, returns true if a new entry was added
+bool CacheKernel(StakeCacheMap& cache, const COutPoint& prevout, CBlockIndex* pindexPrev, CCoinsViewCache& view);
 
 // Compute the hash modifier for proof-of-stake
 uint256 ComputeStakeModifier(const CBlockIndex* pindexPrev, const uint256& kernel);
@@ -42,9 +54,19 @@ uint256 ComputeStakeModifier(const CBlockIndex* pindexPrev, const uint256& kerne
 // Sets hashProofOfStake on success return
 bool CheckStakeKernelHash(CBlockIndex* pindexPrev, unsigned int nBits, uint32_t blockFromTime, int currentBlockHeight, CAmount prevoutAmount, const COutPoint& prevout, unsigned int nTimeTx, uint256& hashProofOfStake, uint256& targetProofOfStake, bool fPrintProofOfStake = false);
 
+// Hash state of the stake kernel preimage up to prevout.hash. It only depends on the
+// tip (through the stake modifier) and the coin, not on the block time, so a staker
+// can compute it once per coin and finish the hash for every timestamp slot.
+CHash256 GetStakeKernelMidstate(const uint256& nStakeModifier, uint32_t blockFromTime, const COutPoint& prevout);
+
+// CheckStakeKernelHash() finishing the hash from GetStakeKernelMidstate()
+bool CheckStakeKernelHash(const CHash256& midstate, unsigned int nBits, uint32_t blockFromTime, int currentBlockHeight, CAmount prevoutAmount, const COutPoint& prevout, unsigned int nTimeTx, uint256& hashProofOfStake, uint256& targetProofOfStake);
+
 // Check kernel hash target and coinstake signature
-// Sets hashProofOfStake on success return
-bool CheckProofOfStake(CBlockIndex* pindexPrev, BlockValidationState& state, const CTransaction& tx, unsigned int nBits, uint32_t nTimeBlock, uint256& hashProofOfStake, uint256& targetProofOfStake, CCoinsViewCache& view);
+// Sets hashProofOfStake and targetProofOfStake on success return
+// pHashProofOfStake, when given, is the kernel hash of a stake the caller already checked against the target,
+// it is taken as is instead of being recomputed
+bool CheckProofOfStake(CBlockIndex* pindexPrev, BlockValidationState& state, const CTransaction& tx, unsigned int nBits, uint32_t nTimeBlock, uint256& hashProofOfStake, uint256& targetProofOfStake, CCoinsViewCache& view, const uint256* pHashProofOfStake = nullptr);
 
 // Check whether the coinstake timestamp meets protocol
 bool CheckCoinStakeTimestamp(uint32_t nTimeBlock);
@@ -53,14 +75,19 @@ bool CheckCoinStakeTimestamp(uint32_t nTimeBlock);
 // Since it is only used in ConnectBlock, we know that we have access to the full contextual utxo set
 bool CheckBlockInputPubKeyMatchesOutputPubKey(const CBlock& block, CCoinsViewCache& view);
 
+// Recover the key IDs the block signature can belong to, compressed and uncompressed for each recovery id.
+bool RecoverBlockSigners(const CBlockHeader& block, std::vector<CKeyID>& signers);
+
 // Recover the pubkey and check that it matches the prevoutStake's scriptPubKey.
-bool CheckRecoveredPubKeyFromBlockSignature(CBlockIndex* pindexPrev, const CBlockHeader& block, CCoinsViewCache& view);
+// signers, when given, are the block signers from RecoverBlockSigners() and the recovery is skipped.
+bool CheckRecoveredPubKeyFromBlockSignature(CBlockIndex* pindexPrev, const CBlockHeader& block, CCoinsViewCache& view, const std::vector<CKeyID>* signers = nullptr);
 
 // Wrapper around CheckStakeKernelHash()
 // Also checks existence of kernel input and min age
 // Convenient for searching a kernel
-bool CheckKernel(CBlockIndex* pindexPrev, unsigned int nBits, uint32_t nTimeBlock, const COutPoint& prevout, CCoinsViewCache& view);
-bool CheckKernel(CBlockIndex* pindexPrev, unsigned int nBits, uint32_t nTimeBlock, const COutPoint& prevout, CCoinsViewCache& view, const std::map<COutPoint, CStakeCache>& cache);
+// Sets *pHashProofOfStake, when given, to the kernel hash
+bool CheckKernel(CBlockIndex* pindexPrev, unsigned int nBits, uint32_t nTimeBlock, const COutPoint& prevout, CCoinsViewCache& view, uint256* pHashProofOfStake = nullptr);
+bool CheckKernel(CBlockIndex* pindexPrev, unsigned int nBits, uint32_t nTimeBlock, const COutPoint& prevout, CCoinsViewCache& view, const StakeCacheMap& cache);
 
 unsigned int GetStakeMaxCombineInputs();
 
@@ -69,6 +96,12 @@ unsigned int GetStakeSplitOutputs();
 bool GetMPoSOutputScripts(std::vector<CScript> &mposScroptList, int nHeight, const Consensus::Params& consensusParams);
 bool GetPoSOutputScripts(std::vector<CScript>& mposScriptList, int nHeight, int recipients, const Consensus::Params& consensusParams);
 
+// Cache the MPoS script that the block on top of pindexNew pays first, called when pindexNew is connected
+void UpdateMPoSScriptCache(const CBlockIndex* pindexNew, const Consensus::Params& consensusParams);
+
+// Lookups of the MPoS script cache so far
+void GetMPoSScriptCacheStats(uint64_t& hits, uint64_t& misses);
+
 bool CreateMPoSOutputs(CMutableTransaction& txNew, int64_t nRewardPiece, int nHeight, const Consensus::Params& consensusParams);
 
 #endif // NEURALLEADCOIN_H
@@ -304,6 +304,8 @@ public:
     /** Convert a CMutableTransaction into a CTransaction. */
     explicit CTransaction(const CMutableTransaction &tx);
     CTransaction(CMutableTransaction &&tx);
+    /** Convert with hashes already known to belong to tx (see TxHashSidecar), skipping their computation. */
+    CTransaction(CMutableTransaction &&tx, const uint256& hash, const uint256& witness_hash);
 
     template <typename Stream>
     inline void Serialize(Stream& s) const {
@@ -45,6 +45,7 @@ const char *CFHEADERS="cfheaders";
 const char *GETCFCHECKPT="getcfcheckpt";
 const char *CFCHECKPT="cfcheckpt";
 const char *WTXIDRELAY="wtxidrelay";
+const char *FASTCHECKSUM="fastchecksum";
 const char *UPDATE_PoS_NODE_INFO="updpni";
 const char *ADD_PoS_NODE_INFO="addpni";
 const char *GET_PoS_NODE_INFO="getpni";
@@ -88,6 +89,7 @@ const static std::string allNetMessageTypes[] = {
     NetMsgType::GETCFCHECKPT,
     NetMsgType::CFCHECKPT,
     NetMsgType::WTXIDRELAY,
+    NetMsgType::FASTCHECKSUM,
     NetMsgType::UPDATE_PoS_NODE_INFO,
     NetMsgType::ADD_PoS_NODE_INFO,
     NetMsgType::GET_PoS_NODE_INFO,
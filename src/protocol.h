@@ -260,6 +260,12 @@ extern const char* CFCHECKPT;
  * @since protocol version 70016 as described by BIP 339.
  */
 extern const char* WTXIDRELAY;
+/**
+ * Indicates that a node accepts a CRC32C of the payload in the checksum field
+ * of the message header, instead of the first 4 bytes of its double QHash.
+ * Sent between VERSION and VERACK.
+ */
+extern const char* FASTCHECKSUM;
 
 /** New Informations about PoS Node Status to propagate */
 extern const char* UPDATE_PoS_NODE_INFO;
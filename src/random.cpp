@@ -6,7 +6,7 @@
 #include <random.h>
 
 #include <compat/cpuid.h>
-#include <crypto/neuralleadqhash_interface.h>
+#include <crypto/sha256.h>
 #include <crypto/sha512.h>
 #include <support/cleanse.h>
 #ifdef WIN32
@@ -365,7 +365,7 @@ class RNGState {
     bool m_strongly_seeded GUARDED_BY(m_mutex) = false;
 
     Mutex m_events_mutex;
-    NeuralLeadQHash_iface m_events_hasher GUARDED_BY(m_events_mutex);
+    CSHA256 m_events_hasher GUARDED_BY(m_events_mutex);
 
 public:
     RNGState() noexcept
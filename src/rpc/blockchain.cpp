@@ -231,7 +231,7 @@ UniValue blockheaderToJSON(const CBlockIndex* tip, const CBlockIndex* blockindex
         result.pushKV("nextblockhash", pnext->GetBlockHash().GetHex());
 
     result.pushKV("flags", strprintf("%s", blockindex->IsProofOfStake()? "proof-of-stake" : "proof-of-work"));
-    result.pushKV("proofhash", blockindex->hashProof.GetHex());
+    result.pushKV("proofhash", blockindex->GetCold().hashProof.GetHex());
     result.pushKV("modifier", blockindex->nStakeModifier.GetHex());
 
     return result;
@@ -281,7 +281,7 @@ UniValue blockToJSON(const CBlock& block, const CBlockIndex* tip, const CBlockIn
         result.pushKV("nextblockhash", pnext->GetBlockHash().GetHex());
 
     result.pushKV("flags", strprintf("%s", blockindex->IsProofOfStake()? "proof-of-stake" : "proof-of-work"));
-    result.pushKV("proofhash", blockindex->hashProof.GetHex());
+    result.pushKV("proofhash", blockindex->GetCold().hashProof.GetHex());
     result.pushKV("modifier", blockindex->nStakeModifier.GetHex());
 
     if (block.IsProofOfStake())
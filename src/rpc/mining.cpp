@@ -15,6 +15,7 @@
 #include <net.h>
 #include <node/context.h>
 #include <policy/fees.h>
+#include <pos.h>
 #include <pow.h>
 #include <rpc/blockchain.h>
 #include <rpc/mining.h>
@@ -24,6 +25,7 @@
 #include <script/script.h>
 #include <script/signingprovider.h>
 #include <shutdown.h>
+#include <stakerstats.h>
 #include <txmempool.h>
 #include <univalue.h>
 #include <util/fees.h>
@@ -404,6 +406,26 @@ static RPCHelpMan getmininginfo()
     };
 }
 
+static UniValue PublishLatencyToJSON()
+{
+    const CStakeLatency::Stats latency = g_stake_latency.GetStats();
+    UniValue publish(UniValue::VOBJ);
+    publish.pushKV("blocks", latency.count);
+    publish.pushKV("last", latency.last * 0.001);
+    publish.pushKV("average", latency.count ? latency.total * 0.001 / latency.count : 0.0);
+    publish.pushKV("max", latency.max * 0.001);
+    return publish;
+}
+
+static UniValue CacheLookupsToJSON(uint64_t hits, uint64_t misses)
+{
+    UniValue cache(UniValue::VOBJ);
+    cache.pushKV("hits", hits);
+    cache.pushKV("misses", misses);
+    cache.pushKV("hitratio", hits + misses ? double(hits) / (hits + misses) : 0.0);
+    return cache;
+}
+
 static UniValue getstakinginfo(const JSONRPCRequest& request)
 {
             RPCHelpMan{"getstakinginfo",
@@ -421,6 +443,13 @@ static UniValue getstakinginfo(const JSONRPCRequest& request)
                         {RPCResult::Type::NUM,  "weight", "The size of the mempool"},
                         {RPCResult::Type::NUM,  "netstakeweight", "The size of the mempool"},
                         {RPCResult::Type::NUM,  "expectedtime", "The size of the mempool"},
+                        {RPCResult::Type::OBJ,  "publishlatency", "Time from finding a stake kernel to announcing the block to the first peer",
+                        {
+                            {RPCResult::Type::NUM, "blocks", "Staked blocks announced since startup"},
+                            {RPCResult::Type::NUM, "last", "Latency of the last one, in milliseconds"},
+                            {RPCResult::Type::NUM, "average", "Average latency, in milliseconds"},
+                            {RPCResult::Type::NUM, "max", "Highest latency, in milliseconds"},
+                        }},
                     }
                 },
                 RPCExamples{
@@ -469,6 +498,113 @@ static UniValue getstakinginfo(const JSONRPCRequest& request)
 
     obj.pushKV("expectedtime", nExpectedTime);
 
+    obj.pushKV("publishlatency", PublishLatencyToJSON());
+
+    return obj;
+}
+
+static UniValue getstakerstats(const JSONRPCRequest& request)
+{
+            RPCHelpMan{"getstakerstats",
+                "\nReturns statistics of the staker rounds since startup, a round being a kernel search over the lookahead slots of a tip.\n"
+                "The same object as last_round is published on the stakerstats ZMQ topic after every round.",
+                {},
+                RPCResult{
+                    RPCResult::Type::OBJ, "", "",
+                    {
+                        {RPCResult::Type::OBJ, "last_round", /* optional */ true, "The last round, if any",
+                        {
+                            {RPCResult::Type::NUM_TIME, "time", "The adjusted time the round started, in " + UNIX_EPOCH_TIME},
+                            {RPCResult::Type::NUM, "candidates", "Coins searched"},
+                            {RPCResult::Type::NUM, "slots", "Lookahead slots searched"},
+                            {RPCResult::Type::NUM, "slots_scanned", "Slots whose scan completed"},
+                            {RPCResult::Type::NUM, "slots_missed", "Scanned slots whose scan completed after the slot had passed"},
+                            {RPCResult::Type::NUM, "hashes", "Kernel hashes computed"},
+                            {RPCResult::Type::NUM, "hashps", "Kernel hashes per second"},
+                            {RPCResult::Type::BOOL, "kernel_found", "Whether a kernel was found"},
+                            {RPCResult::Type::NUM, "search_ms", "Kernel search time"},
+                            {RPCResult::Type::NUM, "cs_main_ms", "Time of the round spent holding cs_main"},
+                            {RPCResult::Type::NUM, "cs_wallet_ms", "Time of the round spent holding cs_wallet"},
+                            {RPCResult::Type::ARR, "slot_scan_ms", "Time from the start of the search to the end of each slot scan",
+                                {{RPCResult::Type::NUM, "", ""}}},
+                        }},
+                        {RPCResult::Type::OBJ, "totals", "Sums over all the rounds",
+                        {
+                            {RPCResult::Type::NUM, "rounds", "Rounds"},
+                            {RPCResult::Type::NUM, "kernels_found", "Rounds that found a kernel"},
+                            {RPCResult::Type::NUM, "hashes", "Kernel hashes computed"},
+                            {RPCResult::Type::NUM, "hashps", "Kernel hashes per second of search"},
+                            {RPCResult::Type::NUM, "slots", "Lookahead slots searched"},
+                            {RPCResult::Type::NUM, "slots_scanned", "Slots whose scan completed"},
+                            {RPCResult::Type::NUM, "slots_missed", "Scanned slots whose scan completed after the slot had passed"},
+                            {RPCResult::Type::NUM, "search_ms", "Kernel search time"},
+                            {RPCResult::Type::NUM, "cs_main_ms", "Time spent holding cs_main"},
+                            {RPCResult::Type::NUM, "cs_wallet_ms", "Time spent holding cs_wallet"},
+                            {RPCResult::Type::OBJ_DYN, "slot_scan_ms", "Scanned slots by scan time, keyed by the upper bound of each bucket in milliseconds",
+                            {
+                                {RPCResult::Type::NUM, "bound", "Slots in the bucket"},
+                            }},
+                        }},
+                        {RPCResult::Type::OBJ, "stakecache", "Lookups of the staking coins in the wallet stake cache",
+                        {
+                            {RPCResult::Type::NUM, "hits", "Coins already cached"},
+                            {RPCResult::Type::NUM, "misses", "Coins read from the chainstate"},
+                            {RPCResult::Type::NUM, "hitratio", "Share of hits"},
+                        }},
+                        {RPCResult::Type::OBJ, "mposcache", "Lookups of the MPoS reward script cache",
+                        {
+                            {RPCResult::Type::NUM, "hits", "Scripts already cached"},
+                            {RPCResult::Type::NUM, "misses", "Scripts read from the stake index"},
+                            {RPCResult::Type::NUM, "hitratio", "Share of hits"},
+                        }},
+                        {RPCResult::Type::OBJ, "publishlatency", "Time from finding a stake kernel to announcing the block to the first peer",
+                        {
+                            {RPCResult::Type::NUM, "blocks", "Staked blocks announced since startup"},
+                            {RPCResult::Type::NUM, "last", "Latency of the last one, in milliseconds"},
+                            {RPCResult::Type::NUM, "average", "Average latency, in milliseconds"},
+                            {RPCResult::Type::NUM, "max", "Highest latency, in milliseconds"},
+                        }},
+                    }
+                },
+                RPCExamples{
+                    HelpExampleCli("getstakerstats", "")
+            + HelpExampleRpc("getstakerstats", "")
+                },
+            }.Check(request);
+
+    UniValue obj(UniValue::VOBJ);
+
+    StakerRound last;
+    if (g_staker_stats.GetLastRound(last)) {
+        obj.pushKV("last_round", StakerRoundToJSON(last));
+    }
+
+    const CStakerStats::Totals totals = g_staker_stats.GetTotals();
+    UniValue total(UniValue::VOBJ);
+    total.pushKV("rounds", totals.rounds);
+    total.pushKV("kernels_found", totals.kernels_found);
+    total.pushKV("hashes", totals.hashes);
+    total.pushKV("hashps", totals.search_time > 0 ? totals.hashes * 1000000.0 / totals.search_time : 0.0);
+    total.pushKV("slots", totals.slots);
+    total.pushKV("slots_scanned", totals.slots_scanned);
+    total.pushKV("slots_missed", totals.slots_missed);
+    total.pushKV("search_ms", totals.search_time * 0.001);
+    total.pushKV("cs_main_ms", totals.cs_main_time * 0.001);
+    total.pushKV("cs_wallet_ms", totals.cs_wallet_time * 0.001);
+    UniValue histogram(UniValue::VOBJ);
+    for (size_t i = 0; i < totals.slot_histogram.size(); ++i) {
+        const std::string bound = i < STAKER_SLOT_BUCKETS.size() ? ToString(STAKER_SLOT_BUCKETS[i]) : "inf";
+        histogram.pushKV(bound, totals.slot_histogram[i]);
+    }
+    total.pushKV("slot_scan_ms", histogram);
+    obj.pushKV("totals", total);
+
+    obj.pushKV("stakecache", CacheLookupsToJSON(totals.stake_cache_hits, totals.stake_cache_misses));
+    uint64_t nMPoSHits, nMPoSMisses;
+    GetMPoSScriptCacheStats(nMPoSHits, nMPoSMisses);
+    obj.pushKV("mposcache", CacheLookupsToJSON(nMPoSHits, nMPoSMisses));
+    obj.pushKV("publishlatency", PublishLatencyToJSON());
+
     return obj;
 }
 
@@ -1400,6 +1536,7 @@ static const CRPCCommand commands[] =
     { "mining",             "submitheader",           &submitheader,           {"hexdata"} },
 
     { "mining",             "getstakinginfo",         &getstakinginfo,         {} },
+    { "mining",             "getstakerstats",         &getstakerstats,         {} },
     { "mining",             "getstakingstatus",       &getstakingstatus,       {} },
     
     { "mining",             "newstakingstep",         &newstakingstep,         {"wallet_name"} },
@@ -3,6 +3,7 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <blockindexcold.h>
 #include <httpserver.h>
 #include <index/blockfilterindex.h>
 #include <index/txindex.h>
@@ -20,6 +21,7 @@
 #include <util/ref.h>
 #include <util/strencodings.h>
 #include <util/system.h>
+#include <validation.h>
 
 #include <stdint.h>
 #include <tuple>
@@ -427,6 +429,31 @@ static RPCHelpMan mockscheduler()
     };
 }
 
+static UniValue RPCStakeSeenInfo()
+{
+    LOCK(cs_main);
+    const CStakeSeen& stake_seen = ::StakeSeen();
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("entries", uint64_t(stake_seen.size()));
+    obj.pushKV("max_entries", uint64_t(MAX_STAKE_SEEN));
+    obj.pushKV("usage", uint64_t(stake_seen.DynamicMemoryUsage()));
+    obj.pushKV("max_usage", uint64_t(CStakeSeen::MaxDynamicMemoryUsage()));
+    return obj;
+}
+
+static UniValue RPCBlockIndexInfo()
+{
+    LOCK(cs_main);
+    const BlockMap& block_index = ::BlockIndex();
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("entries", uint64_t(block_index.size()));
+    obj.pushKV("usage", uint64_t(block_index.DynamicMemoryUsage()));
+    obj.pushKV("cold_pinned", uint64_t(g_block_index_cold.Pinned()));
+    obj.pushKV("cold_cached", uint64_t(g_block_index_cold.Cached()));
+    obj.pushKV("cold_usage", uint64_t(g_block_index_cold.DynamicMemoryUsage()));
+    return obj;
+}
+
 static UniValue RPCLockedMemoryInfo()
 {
     LockedPool::Stats stats = LockedPoolManager::Instance().stats();
@@ -484,6 +511,21 @@ static RPCHelpMan getmemoryinfo()
                                 {RPCResult::Type::NUM, "chunks_used", "Number allocated chunks"},
                                 {RPCResult::Type::NUM, "chunks_free", "Number unused chunks"},
                             }},
+                            {RPCResult::Type::OBJ, "stakeseen", "Information about the recently seen proof-of-stake kernels",
+                            {
+                                {RPCResult::Type::NUM, "entries", "Number of stakes tracked"},
+                                {RPCResult::Type::NUM, "max_entries", "Upper bound on the number of stakes tracked"},
+                                {RPCResult::Type::NUM, "usage", "Estimated memory usage in bytes"},
+                                {RPCResult::Type::NUM, "max_usage", "Estimated upper bound on the memory usage in bytes"},
+                            }},
+                            {RPCResult::Type::OBJ, "blockindex", "Information about the in-memory block index",
+                            {
+                                {RPCResult::Type::NUM, "entries", "Number of block index entries"},
+                                {RPCResult::Type::NUM, "usage", "Estimated memory usage of the entries kept in memory, in bytes"},
+                                {RPCResult::Type::NUM, "cold_pinned", "Block signatures and proof hashes held until the block index is written"},
+                                {RPCResult::Type::NUM, "cold_cached", "Block signatures and proof hashes cached after a read from the block index database"},
+                                {RPCResult::Type::NUM, "cold_usage", "Estimated memory usage of the signatures and proof hashes in memory, in bytes"},
+                            }},
                         }
                     },
                     RPCResult{"mode \"mallocinfo\"",
@@ -500,6 +542,8 @@ static RPCHelpMan getmemoryinfo()
     if (mode == "stats") {
         UniValue obj(UniValue::VOBJ);
         obj.pushKV("locked", RPCLockedMemoryInfo());
+        obj.pushKV("stakeseen", RPCStakeSeenInfo());
+        obj.pushKV("blockindex", RPCBlockIndexInfo());
         return obj;
     } else if (mode == "mallocinfo") {
 #ifdef HAVE_MALLOC_INFO
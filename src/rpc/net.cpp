@@ -118,6 +118,11 @@ static RPCHelpMan getpeerinfo()
                             {RPCResult::Type::NUM_TIME, "last_block", "The " + UNIX_EPOCH_TIME + " of the last block received from this peer"},
                             {RPCResult::Type::NUM, "bytessent", "The total bytes sent"},
                             {RPCResult::Type::NUM, "bytesrecv", "The total bytes received"},
+                            {RPCResult::Type::NUM, "sendrate", "The average bytes sent per second since the connection was established"},
+                            {RPCResult::Type::NUM, "recvrate", "The average bytes received per second since the connection was established"},
+                            {RPCResult::Type::BOOL, "fastchecksum_send", "Whether the messages sent to the peer carry a CRC32C checksum"},
+                            {RPCResult::Type::BOOL, "fastchecksum_recv", "Whether CRC32C checksums are accepted from the peer"},
+                            {RPCResult::Type::NUM, "checksumtime", "The time spent computing message checksums for the peer, in seconds"},
                             {RPCResult::Type::NUM_TIME, "conntime", "The " + UNIX_EPOCH_TIME + " of the connection"},
                             {RPCResult::Type::NUM, "timeoffset", "The time offset in seconds"},
                             {RPCResult::Type::NUM, "pingtime", "ping time (if available)"},
@@ -198,6 +203,12 @@ static RPCHelpMan getpeerinfo()
         obj.pushKV("last_block", stats.nLastBlockTime);
         obj.pushKV("bytessent", stats.nSendBytes);
         obj.pushKV("bytesrecv", stats.nRecvBytes);
+        const int64_t connected_secs = std::max<int64_t>(1, GetSystemTimeInSeconds() - stats.nTimeConnected);
+        obj.pushKV("sendrate", stats.nSendBytes / connected_secs);
+        obj.pushKV("recvrate", stats.nRecvBytes / connected_secs);
+        obj.pushKV("fastchecksum_send", stats.m_fast_checksum_send);
+        obj.pushKV("fastchecksum_recv", stats.m_fast_checksum_recv);
+        obj.pushKV("checksumtime", ((double)stats.m_checksum_time.count()) / 1e6);
         obj.pushKV("conntime", stats.nTimeConnected);
         obj.pushKV("timeoffset", stats.nTimeOffset);
         if (stats.m_ping_usec > 0) {
@@ -5,6 +5,7 @@
 
 #include <script/sigcache.h>
 
+#include <crypto/sha256.h>
 #include <pubkey.h>
 #include <random.h>
 #include <uint256.h>
@@ -23,8 +24,8 @@ class CSignatureCache
 {
 private:
      //! Entries are SHA256(nonce || 'E' or 'S' || 31 zero bytes || signature hash || public key || signature):
-    NeuralLeadQHash_iface m_salted_hasher_ecdsa;
-    NeuralLeadQHash_iface m_salted_hasher_schnorr;
+    CSHA256 m_salted_hasher_ecdsa;
+    CSHA256 m_salted_hasher_schnorr;
     typedef CuckooCache::cache<uint256, SignatureCacheHasher> map_type;
     map_type setValid;
     boost::shared_mutex cs_sigcache;
@@ -48,14 +49,14 @@ public:
     void
     ComputeEntryECDSA(uint256& entry, const uint256 &hash, const std::vector<unsigned char>& vchSig, const CPubKey& pubkey) const
     {
-        NeuralLeadQHash_iface hasher = m_salted_hasher_ecdsa;
+        CSHA256 hasher = m_salted_hasher_ecdsa;
         hasher.Write(hash.begin(), 32).Write(&pubkey[0], pubkey.size()).Write(&vchSig[0], vchSig.size()).Finalize(entry.begin());
     }
 
     void
     ComputeEntrySchnorr(uint256& entry, const uint256 &hash, Span<const unsigned char> sig, const XOnlyPubKey& pubkey) const
     {
-        NeuralLeadQHash_iface hasher = m_salted_hasher_schnorr;
+        CSHA256 hasher = m_salted_hasher_schnorr;
         hasher.Write(hash.begin(), 32).Write(&pubkey[0], pubkey.size()).Write(sig.data(), sig.size()).Finalize(entry.begin());
     }
 
@@ -0,0 +1,78 @@
+// Copyright (c) 2024 The NeuralLead developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <stakerstats.h>
+
+#include <univalue.h>
+#include <validationinterface.h>
+
+#include <algorithm>
+
+CStakerStats g_staker_stats;
+
+void CStakerStats::AddRound(const StakerRound& round)
+{
+    {
+        LOCK(m_mutex);
+        m_has_last = true;
+        m_last = round;
+        m_totals.rounds++;
+        m_totals.kernels_found += round.kernel_found;
+        m_totals.hashes += round.hashes;
+        m_totals.slots += round.slots;
+        m_totals.slots_scanned += round.slots_scanned;
+        m_totals.slots_missed += round.slots_missed;
+        m_totals.search_time += round.search_time;
+        m_totals.cs_main_time += round.cs_main_time;
+        m_totals.cs_wallet_time += round.cs_wallet_time;
+        for (int64_t time : round.slot_times) {
+            const auto bucket = std::lower_bound(STAKER_SLOT_BUCKETS.begin(), STAKER_SLOT_BUCKETS.end(), (time + 999) / 1000);
+            m_totals.slot_histogram[bucket - STAKER_SLOT_BUCKETS.begin()]++;
+        }
+    }
+    GetMainSignals().StakerRoundCompleted(round);
+}
+
+void CStakerStats::AddStakeCacheLookups(uint64_t hits, uint64_t misses)
+{
+    LOCK(m_mutex);
+    m_totals.stake_cache_hits += hits;
+    m_totals.stake_cache_misses += misses;
+}
+
+bool CStakerStats::GetLastRound(StakerRound& round) const
+{
+    LOCK(m_mutex);
+    if (!m_has_last) return false;
+    round = m_last;
+    return true;
+}
+
+CStakerStats::Totals CStakerStats::GetTotals() const
+{
+    LOCK(m_mutex);
+    return m_totals;
+}
+
+UniValue StakerRoundToJSON(const StakerRound& round)
+{
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("time", round.time);
+    obj.pushKV("candidates", round.candidates);
+    obj.pushKV("slots", round.slots);
+    obj.pushKV("slots_scanned", round.slots_scanned);
+    obj.pushKV("slots_missed", round.slots_missed);
+    obj.pushKV("hashes", round.hashes);
+    obj.pushKV("hashps", round.search_time > 0 ? round.hashes * 1000000.0 / round.search_time : 0.0);
+    obj.pushKV("kernel_found", round.kernel_found);
+    obj.pushKV("search_ms", round.search_time * 0.001);
+    obj.pushKV("cs_main_ms", round.cs_main_time * 0.001);
+    obj.pushKV("cs_wallet_ms", round.cs_wallet_time * 0.001);
+    UniValue slot_times(UniValue::VARR);
+    for (int64_t time : round.slot_times) {
+        slot_times.push_back(time * 0.001);
+    }
+    obj.pushKV("slot_scan_ms", slot_times);
+    return obj;
+}
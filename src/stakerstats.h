@@ -0,0 +1,83 @@
+// Copyright (c) 2024 The NeuralLead developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_STAKERSTATS_H
+#define BITCOIN_STAKERSTATS_H
+
+#include <sync.h>
+
+#include <array>
+#include <stdint.h>
+#include <vector>
+
+class UniValue;
+
+//! Upper bounds of the slot scan time histogram buckets in milliseconds, the last bucket has none
+static constexpr std::array<int64_t, 10> STAKER_SLOT_BUCKETS{{1, 2, 5, 10, 20, 50, 100, 200, 500, 1000}};
+
+/** One round of the staker: a kernel search over the lookahead slots of a tip. */
+struct StakerRound
+{
+    //! Adjusted time the round started, in seconds
+    int64_t time{0};
+    uint64_t candidates{0};
+    uint64_t slots{0};
+    //! Slots scanned to the end, and those of them whose scan ended after the slot had passed
+    uint64_t slots_scanned{0};
+    uint64_t slots_missed{0};
+    uint64_t hashes{0};
+    bool kernel_found{false};
+    //! Times in microseconds: kernel search, and the parts of the round
+    //! holding cs_main and cs_wallet
+    int64_t search_time{0};
+    int64_t cs_main_time{0};
+    int64_t cs_wallet_time{0};
+    //! Time from the start of the search to the end of the scan of each scanned slot
+    std::vector<int64_t> slot_times;
+};
+
+/**
+ * Staker instrumentation, accumulated over the rounds of all the staking
+ * wallets since startup. Reported by getstakerstats and published on the
+ * stakerstats ZMQ topic after every round.
+ */
+class CStakerStats
+{
+public:
+    struct Totals {
+        uint64_t rounds{0};
+        uint64_t kernels_found{0};
+        uint64_t hashes{0};
+        uint64_t slots{0};
+        uint64_t slots_scanned{0};
+        uint64_t slots_missed{0};
+        int64_t search_time{0};
+        int64_t cs_main_time{0};
+        int64_t cs_wallet_time{0};
+        uint64_t stake_cache_hits{0};
+        uint64_t stake_cache_misses{0};
+        //! Scanned slots by scan time, see STAKER_SLOT_BUCKETS
+        std::array<uint64_t, STAKER_SLOT_BUCKETS.size() + 1> slot_histogram{};
+    };
+
+    void AddRound(const StakerRound& round);
+    void AddStakeCacheLookups(uint64_t hits, uint64_t misses);
+
+    //! The last round, false if there was none
+    bool GetLastRound(StakerRound& round) const;
+    Totals GetTotals() const;
+
+private:
+    mutable Mutex m_mutex;
+    bool m_has_last GUARDED_BY(m_mutex){false};
+    StakerRound m_last GUARDED_BY(m_mutex);
+    Totals m_totals GUARDED_BY(m_mutex);
+};
+
+extern CStakerStats g_staker_stats;
+
+//! JSON form of a round, for getstakerstats and the stakerstats ZMQ topic
+UniValue StakerRoundToJSON(const StakerRound& round);
+
+#endif // BITCOIN_STAKERSTATS_H
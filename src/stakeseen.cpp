@@ -0,0 +1,69 @@
+// Copyright (c) 2024 The NeuralLead developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <stakeseen.h>
+
+#include <memusage.h>
+
+#include <algorithm>
+
+void CStakeSeen::insert(const Stake& stake)
+{
+    const int64_t time = stake.second;
+    if (Expired(time)) return;
+    if (!m_stakes.insert(stake).second) return;
+    m_buckets[time / STAKE_SEEN_BUCKET].push_back(stake);
+
+    if (time > m_newest) {
+        m_newest = time;
+        const int64_t oldest = (m_newest - STAKE_SEEN_WINDOW) / STAKE_SEEN_BUCKET;
+        while (!m_buckets.empty() && m_buckets.begin()->first < oldest) {
+            EraseBucket(m_buckets.begin());
+        }
+    }
+    while (m_stakes.size() > MAX_STAKE_SEEN) {
+        EraseBucket(m_buckets.begin());
+    }
+}
+
+size_t CStakeSeen::count(const Stake& stake) const
+{
+    if (Expired(stake.second)) return 0;
+    return m_stakes.count(stake);
+}
+
+void CStakeSeen::clear()
+{
+    m_stakes.clear();
+    m_buckets.clear();
+    m_newest = 0;
+}
+
+void CStakeSeen::EraseBucket(std::map<int64_t, std::vector<Stake>>::iterator it)
+{
+    for (const Stake& stake : it->second) {
+        m_stakes.erase(stake);
+    }
+    m_buckets.erase(it);
+}
+
+size_t CStakeSeen::DynamicMemoryUsage() const
+{
+    size_t usage = memusage::DynamicUsage(m_stakes) + memusage::DynamicUsage(m_buckets);
+    for (const auto& bucket : m_buckets) {
+        usage += memusage::DynamicUsage(bucket.second);
+    }
+    return usage;
+}
+
+size_t CStakeSeen::MaxDynamicMemoryUsage()
+{
+    // Up to twice as many hash buckets and vector slots as entries after growth,
+    // and at most one time bucket per STAKE_SEEN_BUCKET in the window
+    const size_t buckets = std::min<size_t>(MAX_STAKE_SEEN, STAKE_SEEN_WINDOW / STAKE_SEEN_BUCKET + 2);
+    return memusage::MallocUsage(sizeof(memusage::unordered_node<Stake>)) * MAX_STAKE_SEEN +
+           memusage::MallocUsage(sizeof(void*) * MAX_STAKE_SEEN * 2) +
+           memusage::MallocUsage(sizeof(memusage::stl_tree_node<std::pair<const int64_t, std::vector<Stake>>>)) * buckets +
+           memusage::MallocUsage(sizeof(Stake) * MAX_STAKE_SEEN * 2) + memusage::MallocUsage(1) * buckets;
+}
@@ -0,0 +1,62 @@
+// Copyright (c) 2024 The NeuralLead developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_STAKESEEN_H
+#define BITCOIN_STAKESEEN_H
+
+#include <coins.h>
+#include <primitives/transaction.h>
+
+#include <map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+//! Stakes with a block time this far behind the newest one are forgotten
+static const int64_t STAKE_SEEN_WINDOW = 12 * 60 * 60;
+//! Granularity at which stakes expire
+static const int64_t STAKE_SEEN_BUCKET = 10 * 60;
+//! Hard cap on the number of stakes kept, the oldest buckets go first
+static const size_t MAX_STAKE_SEEN = 100000;
+
+/**
+ * The stakes (prevout, block time) of the known proof-of-stake block indexes,
+ * used to turn away duplicate stakes.
+ *
+ * A duplicate stake is only a cheap attack while its block time is recent, so
+ * stakes older than STAKE_SEEN_WINDOW before the newest block time seen are
+ * dropped, in STAKE_SEEN_BUCKET steps, and count() no longer reports them.
+ * Lookups are a single hash set probe and the size is capped by
+ * MAX_STAKE_SEEN whatever the chain length.
+ */
+class CStakeSeen
+{
+public:
+    typedef std::pair<COutPoint, unsigned int> Stake;
+
+    void insert(const Stake& stake);
+    size_t count(const Stake& stake) const;
+    void clear();
+
+    size_t size() const { return m_stakes.size(); }
+    size_t DynamicMemoryUsage() const;
+    //! Memory usage at MAX_STAKE_SEEN entries
+    static size_t MaxDynamicMemoryUsage();
+
+private:
+    struct StakeHasher {
+        SaltedOutpointHasher hasher;
+        size_t operator()(const Stake& stake) const { return hasher(stake.first) ^ (stake.second * 0x9E3779B97F4A7C15ULL); }
+    };
+
+    std::unordered_set<Stake, StakeHasher> m_stakes;
+    //! Stakes by block time bucket, for expiry
+    std::map<int64_t, std::vector<Stake>> m_buckets;
+    int64_t m_newest{0};
+
+    bool Expired(int64_t time) const { return time < m_newest - STAKE_SEEN_WINDOW; }
+    void EraseBucket(std::map<int64_t, std::vector<Stake>>::iterator it);
+};
+
+#endif // BITCOIN_STAKESEEN_H
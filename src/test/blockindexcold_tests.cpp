@@ -0,0 +1,151 @@
+// Copyright (c) 2024 The NeuralLead developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <blockindexcold.h>
+#include <chain.h>
+#include <test/util/setup_common.h>
+#include <txdb.h>
+#include <validation.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(blockindexcold_tests, TestingSetup)
+
+static CBlockIndexCold RandomCold()
+{
+    CBlockIndexCold cold;
+    cold.vchBlockSig = g_insecure_rand_ctx.randbytes(72);
+    cold.hashProof = InsecureRand256();
+    return cold;
+}
+
+BOOST_AUTO_TEST_CASE(blockindexcold_reads_written_entries)
+{
+    const uint256 hash = InsecureRand256();
+    CBlockIndex index;
+    index.phashBlock = &hash;
+    const CBlockIndexCold cold = RandomCold();
+
+    g_block_index_cold.Set(hash, cold);
+    BOOST_CHECK(index.GetCold().vchBlockSig == cold.vchBlockSig);
+    BOOST_CHECK(pblocktree->WriteBatchSync({}, 0, {&index}));
+    g_block_index_cold.Written({&index});
+
+    // A store that never saw the entry reads it from the block tree DB,
+    // and only keeps it in memory when asked to
+    CBlockIndexColdStore store(1);
+    CBlockIndexCold in_memory;
+    BOOST_CHECK(store.Get(hash, -1, false).vchBlockSig == cold.vchBlockSig);
+    BOOST_CHECK_EQUAL(store.Cached(), 0U);
+    BOOST_CHECK(!store.GetInMemory(hash, in_memory));
+    BOOST_CHECK(store.Get(hash).vchBlockSig == cold.vchBlockSig);
+    BOOST_CHECK(store.GetInMemory(hash, in_memory));
+    BOOST_CHECK(in_memory.vchBlockSig == cold.vchBlockSig);
+    BOOST_CHECK_EQUAL(store.Get(hash).hashProof, cold.hashProof);
+    BOOST_CHECK_EQUAL(store.Cached(), 1U);
+    BOOST_CHECK(store.Get(InsecureRand256()).vchBlockSig.empty());
+}
+
+BOOST_AUTO_TEST_CASE(blockindexcold_keeps_unwritten_entries)
+{
+    CBlockIndexColdStore store(1);
+    std::vector<uint256> hashes(3);
+    std::vector<CBlockIndex> indexes(3);
+    std::vector<CBlockIndexCold> colds(3);
+    for (size_t i = 0; i < 3; ++i) {
+        hashes[i] = InsecureRand256();
+        indexes[i].phashBlock = &hashes[i];
+        colds[i] = RandomCold();
+        store.Set(hashes[i], colds[i]);
+    }
+    BOOST_CHECK_EQUAL(store.Pinned(), 3U);
+
+    // Written entries go to the LRU, the first one is evicted and was never in the DB
+    store.Written({&indexes[0], &indexes[1]});
+    BOOST_CHECK_EQUAL(store.Pinned(), 1U);
+    BOOST_CHECK_EQUAL(store.Cached(), 1U);
+    BOOST_CHECK(store.Get(hashes[0]).vchBlockSig.empty());
+    BOOST_CHECK(store.Get(hashes[1]).vchBlockSig == colds[1].vchBlockSig);
+    BOOST_CHECK(store.Get(hashes[2]).vchBlockSig == colds[2].vchBlockSig);
+
+    // A new proof hash pins the entry again
+    BOOST_CHECK(!store.SetHashProof(hashes[1], colds[1].hashProof));
+    BOOST_CHECK(store.SetHashProof(hashes[1], uint256::ONE));
+    BOOST_CHECK_EQUAL(store.Pinned(), 2U);
+    BOOST_CHECK_EQUAL(store.Cached(), 0U);
+    BOOST_CHECK_EQUAL(store.Get(hashes[1]).hashProof, uint256::ONE);
+    BOOST_CHECK(store.Get(hashes[1]).vchBlockSig == colds[1].vchBlockSig);
+
+    store.Clear();
+    BOOST_CHECK_EQUAL(store.Pinned(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(blockindexcold_erases_removed_entries)
+{
+    CBlockIndexColdStore store(2);
+    std::vector<uint256> hashes(3);
+    std::vector<CBlockIndex> indexes(3);
+    for (size_t i = 0; i < 3; ++i) {
+        hashes[i] = InsecureRand256();
+        indexes[i].phashBlock = &hashes[i];
+        store.Set(hashes[i], RandomCold());
+    }
+    store.Written({&indexes[0]});
+    BOOST_CHECK_EQUAL(store.Pinned(), 2U);
+    BOOST_CHECK_EQUAL(store.Cached(), 1U);
+
+    // An entry removed before it was written is not pinned anymore
+    store.Erase(hashes[1]);
+    BOOST_CHECK_EQUAL(store.Pinned(), 1U);
+    BOOST_CHECK(store.Get(hashes[1]).vchBlockSig.empty());
+
+    // Nor cached once written
+    store.Erase(hashes[0]);
+    BOOST_CHECK_EQUAL(store.Cached(), 0U);
+    store.Erase(hashes[2]);
+    store.Erase(InsecureRand256());
+    BOOST_CHECK_EQUAL(store.Pinned(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(blockindexcold_keeps_recent_entries)
+{
+    CBlockIndexColdStore store(1, 3);
+    std::vector<uint256> hashes(6);
+    std::vector<CBlockIndex> indexes(6);
+    std::vector<CBlockIndexCold> colds(6);
+    std::vector<const CBlockIndex*> written;
+    for (size_t i = 0; i < 6; ++i) {
+        hashes[i] = InsecureRand256();
+        indexes[i].phashBlock = &hashes[i];
+        indexes[i].nHeight = i;
+        colds[i] = RandomCold();
+        store.Set(hashes[i], colds[i]);
+        written.push_back(&indexes[i]);
+    }
+
+    // Heights 2 to 5 are recent, over the bound the lowest goes to the LRU
+    store.SetRecentHeight(2);
+    store.Written(written);
+    BOOST_CHECK_EQUAL(store.Pinned(), 0U);
+    BOOST_CHECK_EQUAL(store.Recent(), 3U);
+    BOOST_CHECK_EQUAL(store.Cached(), 1U);
+    for (size_t i = 3; i < 6; ++i) {
+        BOOST_CHECK(store.Get(hashes[i]).vchBlockSig == colds[i].vchBlockSig);
+    }
+    BOOST_CHECK(store.Get(hashes[2]).vchBlockSig == colds[2].vchBlockSig);
+    BOOST_CHECK(store.Get(hashes[0]).vchBlockSig.empty());
+
+    // A higher tip drops the older recent entries to the LRU
+    store.SetRecentHeight(5);
+    BOOST_CHECK_EQUAL(store.Recent(), 1U);
+    BOOST_CHECK_EQUAL(store.Cached(), 1U);
+    BOOST_CHECK(store.Get(hashes[4]).vchBlockSig == colds[4].vchBlockSig);
+    BOOST_CHECK(store.Get(hashes[3]).vchBlockSig.empty());
+    BOOST_CHECK(store.Get(hashes[5]).vchBlockSig == colds[5].vchBlockSig);
+
+    store.Erase(hashes[5]);
+    BOOST_CHECK_EQUAL(store.Recent(), 0U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
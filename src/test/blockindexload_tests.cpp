@@ -0,0 +1,88 @@
+// Copyright (c) 2024 The NeuralLead developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chain.h>
+#include <chainparams.h>
+#include <test/util/setup_common.h>
+#include <txdb.h>
+
+#include <map>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(blockindexload_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(blockindexload_reads_every_range_in_order)
+{
+    CBlockTreeDB blocktree(1 << 20, true);
+    std::vector<uint256> hashes(1000);
+    std::vector<CBlockIndex> indexes(hashes.size());
+    std::vector<const CBlockIndex*> written;
+    for (size_t i = 0; i < hashes.size(); ++i) {
+        hashes[i] = InsecureRand256();
+        indexes[i].phashBlock = &hashes[i];
+        indexes[i].pprev = i > 0 ? &indexes[i - 1] : nullptr;
+        indexes[i].nHeight = i;
+        indexes[i].prevoutStake = COutPoint(InsecureRand256(), 1);
+        written.push_back(&indexes[i]);
+    }
+    BOOST_CHECK(blocktree.WriteBatchSync({}, 0, written));
+
+    for (int threads : {1, 3, 16, 300}) {
+        std::map<uint256, CBlockIndexEntry> loaded;
+        auto insert_entries = [&](std::vector<CBlockIndexEntry>& range) {
+            for (const CBlockIndexEntry& entry : range) {
+                // Ranges come in key order
+                BOOST_CHECK(loaded.empty() || std::prev(loaded.end())->first < entry.hash);
+                BOOST_CHECK(loaded.emplace(entry.hash, entry).second);
+            }
+        };
+        BOOST_CHECK(blocktree.LoadBlockIndexGuts(Params().GetConsensus(), insert_entries, false, threads));
+        BOOST_CHECK_EQUAL(loaded.size(), hashes.size());
+        for (size_t i = 0; i < hashes.size(); ++i) {
+            const CBlockIndexEntry& entry = loaded.at(hashes[i]);
+            BOOST_CHECK_EQUAL(entry.hashPrev, i > 0 ? hashes[i - 1] : uint256());
+            BOOST_CHECK_EQUAL(entry.index.nHeight, int(i));
+            BOOST_CHECK(entry.index.prevoutStake == indexes[i].prevoutStake);
+            BOOST_CHECK(entry.index.pprev == nullptr);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(blockindexload_fails_on_bad_entries)
+{
+    std::vector<uint256> hashes(100);
+    std::vector<CBlockIndex> indexes(hashes.size());
+    std::vector<const CBlockIndex*> written;
+    for (size_t i = 0; i < hashes.size(); ++i) {
+        hashes[i] = InsecureRand256();
+        indexes[i].phashBlock = &hashes[i];
+        indexes[i].pprev = i > 0 ? &indexes[i - 1] : nullptr;
+        indexes[i].nHeight = i;
+        indexes[i].prevoutStake = COutPoint(InsecureRand256(), 1);
+        written.push_back(&indexes[i]);
+    }
+    size_t inserted = 0;
+    auto insert_entries = [&](std::vector<CBlockIndexEntry>& range) { inserted += range.size(); };
+
+    // The entries are stored under random hashes, none matches its header once rehashed
+    {
+        CBlockTreeDB blocktree(1 << 20, true);
+        BOOST_CHECK(blocktree.WriteBatchSync({}, 0, written));
+        for (int threads : {1, 3, 16}) {
+            BOOST_CHECK(blocktree.LoadBlockIndexGuts(Params().GetConsensus(), insert_entries, false, threads));
+            BOOST_CHECK(!blocktree.LoadBlockIndexGuts(Params().GetConsensus(), insert_entries, true, threads));
+        }
+    }
+
+    // A value that does not deserialize fails the load, whichever range it falls in
+    for (int threads : {1, 3, 16}) {
+        CBlockTreeDB blocktree(1 << 20, true);
+        BOOST_CHECK(blocktree.WriteBatchSync({}, 0, written));
+        BOOST_CHECK(blocktree.Write(std::make_pair('b', InsecureRand256()), char(0x80)));
+        BOOST_CHECK(!blocktree.LoadBlockIndexGuts(Params().GetConsensus(), insert_entries, false, threads));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
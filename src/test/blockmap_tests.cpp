@@ -0,0 +1,93 @@
+// Copyright (c) 2024 The NeuralLead developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <blockmap.h>
+#include <memusage.h>
+#include <test/util/setup_common.h>
+#include <tinyformat.h>
+
+#include <unordered_map>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(blockmap_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(blockmap_keeps_nodes_in_place)
+{
+    BlockMap block_index;
+    std::vector<uint256> hashes;
+    std::vector<CBlockIndex*> nodes;
+    for (int i = 0; i < 10000; ++i) {
+        hashes.push_back(InsecureRand256());
+        auto inserted = block_index.emplace(hashes.back());
+        BOOST_CHECK(inserted.second);
+        BOOST_CHECK(*inserted.first->second->phashBlock == hashes.back());
+        inserted.first->second->nHeight = i;
+        nodes.push_back(inserted.first->second);
+    }
+    BOOST_CHECK(!block_index.emplace(hashes[0]).second);
+    BOOST_CHECK_EQUAL(block_index.size(), hashes.size());
+
+    // Erase every third entry, the others are still found at the same address
+    CBlockIndex* last_erased = nullptr;
+    for (size_t i = 0; i < hashes.size(); i += 3) {
+        block_index.erase(block_index.find(hashes[i]));
+        last_erased = nodes[i];
+    }
+    size_t count = 0;
+    for (const auto& entry : block_index) {
+        BOOST_CHECK(entry.first == *entry.second->phashBlock);
+        ++count;
+    }
+    BOOST_CHECK_EQUAL(count, block_index.size());
+    for (size_t i = 0; i < hashes.size(); ++i) {
+        auto it = block_index.find(hashes[i]);
+        if (i % 3 == 0) {
+            BOOST_CHECK(it == block_index.end());
+            BOOST_CHECK_EQUAL(block_index.count(hashes[i]), 0U);
+        } else {
+            BOOST_CHECK(it != block_index.end() && it->second == nodes[i]);
+            BOOST_CHECK_EQUAL(it->second->nHeight, int(i));
+            BOOST_CHECK(*nodes[i]->phashBlock == hashes[i]);
+        }
+    }
+
+    // Erased nodes are reused, without the fields of the entry they held
+    const uint256 hash = InsecureRand256();
+    CBlockIndex* pindex = block_index.emplace(hash).first->second;
+    BOOST_CHECK(pindex == last_erased);
+    BOOST_CHECK_EQUAL(pindex->nHeight, 0);
+    BOOST_CHECK(pindex->phashBlock && *pindex->phashBlock == hash);
+
+    const size_t usage = block_index.DynamicMemoryUsage();
+    BOOST_CHECK(usage >= block_index.size() * sizeof(CBlockIndex));
+    block_index.clear();
+    BOOST_CHECK(block_index.empty());
+    BOOST_CHECK(block_index.begin() == block_index.end());
+    BOOST_CHECK(block_index.find(hash) == block_index.end());
+    BOOST_CHECK_EQUAL(block_index.DynamicMemoryUsage(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(blockmap_memory_per_entry)
+{
+    static constexpr size_t ENTRIES = 100000;
+    BlockMap block_index;
+    std::unordered_map<uint256, CBlockIndex*, BlockHasher> map_block_index;
+    for (size_t i = 0; i < ENTRIES; ++i) {
+        const uint256 hash = InsecureRand256();
+        block_index.emplace(hash);
+        map_block_index.emplace(hash, nullptr);
+    }
+    BOOST_CHECK_EQUAL(block_index.size(), ENTRIES);
+
+    // Less than a heap allocated CBlockIndex behind a std::unordered_map entry
+    const size_t per_entry = block_index.DynamicMemoryUsage() / ENTRIES;
+    const size_t unordered_per_entry = (memusage::DynamicUsage(map_block_index) + ENTRIES * memusage::MallocUsage(sizeof(CBlockIndex))) / ENTRIES;
+    BOOST_TEST_MESSAGE(strprintf("BlockMap: %u bytes per entry, std::unordered_map: %u", per_entry, unordered_per_entry));
+    BOOST_CHECK_LT(per_entry, unordered_per_entry);
+    // The node, up to a chunk of slack and four table slots
+    BOOST_CHECK_LE(per_entry, sizeof(uint256) + sizeof(CBlockIndex) + 4 * sizeof(void*) + 64);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
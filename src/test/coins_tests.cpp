@@ -5,15 +5,18 @@
 #include <attributes.h>
 #include <clientversion.h>
 #include <coins.h>
+#include <memusage.h>
 #include <script/standard.h>
 #include <streams.h>
 #include <test/util/setup_common.h>
+#include <tinyformat.h>
 #include <txdb.h>
 #include <uint256.h>
 #include <undo.h>
 #include <util/strencodings.h>
 
 #include <map>
+#include <unordered_map>
 #include <vector>
 
 #include <boost/test/unit_test.hpp>
@@ -81,7 +84,7 @@ public:
     void SelfTest() const
     {
         // Manually recompute the dynamic usage of the whole data, and compare it.
-        size_t ret = memusage::DynamicUsage(cacheCoins);
+        size_t ret = cacheCoins.DynamicMemoryUsage();
         size_t count = 0;
         for (const auto& entry : cacheCoins) {
             ret += entry.second.coin.DynamicMemoryUsage();
@@ -878,4 +881,80 @@ BOOST_AUTO_TEST_CASE(ccoins_write)
                     CheckWriteCoins(parent_value, child_value, parent_value, parent_flags, child_flags, parent_flags);
 }
 
+BOOST_AUTO_TEST_CASE(ccoins_map)
+{
+    // Compare a CCoinsMap to a std::map under random insertions and erasures,
+    // with few enough outpoints that erased slots are reused and rehashed.
+    CCoinsMap map;
+    std::map<COutPoint, CAmount> expected;
+    std::vector<COutPoint> outpoints;
+    for (int i = 0; i < 500; ++i) {
+        outpoints.emplace_back(InsecureRand256(), InsecureRandRange(4));
+    }
+
+    for (int i = 0; i < 20000; ++i) {
+        const COutPoint& outpoint = outpoints[InsecureRandRange(outpoints.size())];
+        if (InsecureRandBool()) {
+            CCoinsCacheEntry entry;
+            entry.coin.out.nValue = InsecureRandRange(MAX_MONEY);
+            entry.coin.out.scriptPubKey.assign(InsecureRandRange(64), 1);
+            entry.flags = CCoinsCacheEntry::DIRTY;
+            const CAmount value = entry.coin.out.nValue;
+            const auto inserted = map.emplace(outpoint, std::move(entry));
+            BOOST_CHECK_EQUAL(inserted.second, expected.emplace(outpoint, value).second);
+            BOOST_CHECK(inserted.first->first == outpoint);
+        } else {
+            const auto it = map.find(outpoint);
+            BOOST_CHECK_EQUAL(it != map.end(), expected.count(outpoint) == 1);
+            if (it != map.end()) {
+                BOOST_CHECK_EQUAL(it->second.coin.out.nValue, expected[outpoint]);
+                map.erase(it);
+                expected.erase(outpoint);
+            }
+        }
+        BOOST_CHECK_EQUAL(map.size(), expected.size());
+    }
+
+    // Entries are found again by iterating, and can be erased while doing so
+    size_t count = 0;
+    for (auto it = map.begin(); it != map.end();) {
+        BOOST_CHECK_EQUAL(it->second.coin.out.nValue, expected.at(it->first));
+        ++count;
+        it = map.erase(it);
+    }
+    BOOST_CHECK_EQUAL(count, expected.size());
+    BOOST_CHECK(map.empty());
+
+    map[outpoints[0]].flags = CCoinsCacheEntry::DIRTY | CCoinsCacheEntry::FRESH;
+    BOOST_CHECK(map.find(outpoints[0])->second.coin.IsSpent());
+    BOOST_CHECK_GT(map.DynamicMemoryUsage(), 0U);
+    map.clear();
+    BOOST_CHECK(map.find(outpoints[0]) == map.end());
+    BOOST_CHECK_EQUAL(map.DynamicMemoryUsage(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(ccoins_map_memory)
+{
+    // The coins map holds more coins per byte of dbcache than the
+    // std::unordered_map it replaced, for coins with an inline script
+    static constexpr size_t COINS = 100000;
+    CCoinsMap map;
+    std::unordered_map<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher> unordered;
+    for (size_t i = 0; i < COINS; ++i) {
+        const COutPoint outpoint(InsecureRand256(), InsecureRandRange(4));
+        CCoinsCacheEntry entry;
+        entry.coin.out.nValue = 1 + InsecureRandRange(COIN);
+        entry.coin.out.scriptPubKey.assign((uint32_t)25, 1);
+        entry.flags = CCoinsCacheEntry::DIRTY;
+        unordered.emplace(outpoint, entry);
+        map.emplace(outpoint, std::move(entry));
+    }
+    BOOST_CHECK_EQUAL(map.size(), COINS);
+
+    const size_t per_coin = map.DynamicMemoryUsage() / map.size();
+    const size_t unordered_per_coin = memusage::DynamicUsage(unordered) / unordered.size();
+    BOOST_TEST_MESSAGE(strprintf("CCoinsMap: %u bytes per coin, std::unordered_map: %u", per_coin, unordered_per_coin));
+    BOOST_CHECK_LT(per_coin, unordered_per_coin);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
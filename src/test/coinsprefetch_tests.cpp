@@ -0,0 +1,84 @@
+// Copyright (c) 2024 The NeuralLead developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <coinsprefetch.h>
+#include <primitives/block.h>
+#include <test/util/setup_common.h>
+#include <txdb.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(coinsprefetch_tests, BasicTestingSetup)
+
+static Coin RandomCoin()
+{
+    return Coin(CTxOut(InsecureRandRange(1000) + 1, CScript() << OP_TRUE), 1, false, false);
+}
+
+BOOST_AUTO_TEST_CASE(coinsprefetch_block_prevouts)
+{
+    CMutableTransaction coinbase, spend, child;
+    coinbase.vin.resize(1);
+    spend.vin.emplace_back(COutPoint(InsecureRand256(), 0));
+    spend.vin.emplace_back(COutPoint(InsecureRand256(), 3));
+    spend.vout.resize(1);
+    child.vin.emplace_back(COutPoint(CTransaction(spend).GetHash(), 0));
+
+    CBlock block;
+    block.vtx = {MakeTransactionRef(coinbase), MakeTransactionRef(spend), MakeTransactionRef(child)};
+    // The coinbase input and the coin created in the block are not read
+    const std::vector<COutPoint> prevouts = GetBlockPrevouts(block);
+    BOOST_CHECK_EQUAL(prevouts.size(), 2U);
+    BOOST_CHECK(prevouts[0] == spend.vin[0].prevout);
+    BOOST_CHECK(prevouts[1] == spend.vin[1].prevout);
+}
+
+BOOST_AUTO_TEST_CASE(coinsprefetch_warms_cache)
+{
+    CCoinsViewDB db{"test", 1 << 23, true, false};
+    std::vector<COutPoint> outpoints;
+    std::vector<Coin> coins;
+    {
+        CCoinsViewCache cache(&db);
+        for (int i = 0; i < 1000; ++i) {
+            outpoints.emplace_back(InsecureRand256(), i);
+            coins.push_back(RandomCoin());
+            cache.AddCoin(outpoints.back(), Coin(coins.back()), false);
+        }
+        cache.SetBestBlock(InsecureRand256());
+        BOOST_CHECK(cache.Flush());
+    }
+
+    CCoinsPrefetch prefetch;
+    prefetch.outpoints = outpoints;
+    prefetch.outpoints.emplace_back(InsecureRand256(), 0);
+    PrefetchCoins(db, prefetch);
+    BOOST_CHECK(prefetch.IsCurrent(db));
+    BOOST_CHECK(prefetch.coins.back().IsSpent());
+    for (size_t i = 0; i < outpoints.size(); ++i) {
+        BOOST_CHECK(prefetch.coins[i].out == coins[i].out);
+    }
+
+    // A coin the cache already has, here spent, is left alone
+    CCoinsViewCache cache(&db);
+    BOOST_CHECK(cache.SpendCoin(outpoints[0]));
+    BOOST_CHECK_EQUAL(WarmCoinsCache(cache, db, prefetch), outpoints.size() - 1);
+    BOOST_CHECK(!cache.HaveCoin(outpoints[0]));
+    BOOST_CHECK(cache.HaveCoinInCache(outpoints[1]));
+    BOOST_CHECK(cache.AccessCoin(outpoints[1]).out == coins[1].out);
+    BOOST_CHECK(!cache.HaveCoinInCache(prefetch.outpoints.back()));
+
+    // Coins read before a write are dropped
+    CCoinsPrefetch stale;
+    stale.outpoints = {outpoints[2]};
+    PrefetchCoins(db, stale);
+    cache.SetBestBlock(InsecureRand256());
+    BOOST_CHECK(cache.Flush());
+    BOOST_CHECK(!stale.IsCurrent(db));
+    CCoinsViewCache other(&db);
+    BOOST_CHECK_EQUAL(WarmCoinsCache(other, db, stale), 0U);
+    BOOST_CHECK(!other.HaveCoinInCache(outpoints[2]));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -5,15 +5,19 @@
 #include <crypto/aes.h>
 #include <crypto/chacha20.h>
 #include <crypto/chacha_poly_aead.h>
+#include <crypto/cryptoconf.h>
 #include <crypto/hkdf_sha256_32.h>
 #include <crypto/hmac_sha256.h>
 #include <crypto/hmac_sha512.h>
+#include <crypto/neuralleadnet.h>
 #include <crypto/poly1305.h>
 #include <crypto/ripemd160.h>
 #include <crypto/sha1.h>
+#include <crypto/sha256.h>
 #include <crypto/neuralleadqhash_interface.h>
 #include <crypto/sha3.h>
 #include <crypto/sha512.h>
+#include <neuralleadnetio.h>
 #include <random.h>
 #include <test/util/setup_common.h>
 #include <util/strencodings.h>
@@ -54,7 +58,7 @@ static void TestVector(const Hasher &h, const In &in, const Out &out) {
 }
 
 static void TestSHA1(const std::string &in, const std::string &hexout) { TestVector(CSHA1(), in, ParseHex(hexout));}
-static void TestSHA256(const std::string &in, const std::string &hexout) { TestVector(NeuralLeadQHash_iface(), in, ParseHex(hexout));}
+static void TestSHA256(const std::string &in, const std::string &hexout) { TestVector(CSHA256(), in, ParseHex(hexout));}
 static void TestSHA512(const std::string &in, const std::string &hexout) { TestVector(CSHA512(), in, ParseHex(hexout));}
 static void TestRIPEMD160(const std::string &in, const std::string &hexout) { TestVector(CRIPEMD160(), in, ParseHex(hexout));}
 
@@ -751,6 +755,84 @@ BOOST_AUTO_TEST_CASE(sha256d64)
     }
 }
 
+BOOST_AUTO_TEST_CASE(sha256d64_lanes)
+{
+    // The 4-way/8-way lane kernels selected by SHA256AutoDetect must match the single blob path,
+    // including for the in-place use in ComputeMerkleRoot.
+    for (int i = 0; i <= 37; ++i) {
+        unsigned char in[64 * 37];
+        unsigned char out1[32 * 37], out2[32 * 37];
+        for (int j = 0; j < 64 * i; ++j) {
+            in[j] = InsecureRandBits(8);
+        }
+        for (int j = 0; j < i; ++j) {
+            SHA256D64(out1 + 32 * j, in + 64 * j, 1);
+        }
+        SHA256D64(out2, in, i);
+        BOOST_CHECK(memcmp(out1, out2, 32 * i) == 0);
+        SHA256D64(in, in, i);
+        BOOST_CHECK(memcmp(out1, in, 32 * i) == 0);
+    }
+}
+
+#ifndef WIN32
+BOOST_AUTO_TEST_CASE(qhash_quantum_kernel)
+{
+    // The closed-form quantum mixing kernel must be bit-identical to the qpp simulation.
+    // The crypto_qhash_quantum fuzz target extends this to arbitrary numbers of states.
+    for (int i = 0; i < 100000; ++i) {
+        uint32_t v[8];
+        for (int j = 0; j < 8; ++j) {
+            v[j] = InsecureRand32();
+        }
+        switch (i % 4) {
+        case 1: // zero rotation angles
+            for (int j = 0; j < 4; ++j) v[j + 4] = v[j];
+            break;
+        case 2: // full rotation angles
+            for (int j = 0; j < 4; ++j) v[j + 4] = ~v[j];
+            break;
+        case 3: // angles close to zero
+            for (int j = 0; j < 4; ++j) v[j + 4] = v[j] ^ InsecureRandBits(8);
+            break;
+        }
+        BOOST_CHECK_EQUAL(QuantumMix(v), QuantumMixReference(v));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(qhash_native_neural_network)
+{
+    NeuralLeadNet net;
+    std::vector<NeuralLeadNet::LayerSpec> layers;
+    std::string error;
+    BOOST_REQUIRE_MESSAGE(ReadNeuralLeadNetLayers(NEURALLEADNET_DIR, layers, error), error);
+    BOOST_REQUIRE_MESSAGE(net.Load(layers, error), error);
+
+    // The vectorized pass must be bit-identical to the strict one, and both to
+    // the NeuralLeadQHash runtime, as the outputs feed the hash state.
+    for (int i = 0; i < 10000; ++i) {
+        uint32_t state[8];
+        float inputs[32], expected[8], native[8], strict[8];
+        for (int j = 0; j < 8; ++j) {
+            state[j] = i < 2 ? (i ? 0xffffffff : 0) : InsecureRand32();
+        }
+        InputsIntToNeuralLead(state, inputs);
+        neuralNetwork(inputs, expected);
+        net.Run(inputs, native);
+        net.RunStrict(inputs, strict);
+        BOOST_CHECK(memcmp(native, strict, NeuralLeadNet::OUTPUTS * sizeof(float)) == 0);
+        BOOST_CHECK(memcmp(expected, strict, NeuralLeadNet::OUTPUTS * sizeof(float)) == 0);
+    }
+
+    BOOST_CHECK(SetNeuralNetBackend(NeuralNetBackend::NATIVE, layers, error));
+    BOOST_CHECK_EQUAL(NeuralNetBackendName(), "native");
+    BOOST_CHECK(SetNeuralNetBackend(NeuralNetBackend::RUNTIME, {}, error));
+    BOOST_CHECK(!ReadNeuralLeadNetLayers("nonexistent", layers, error));
+    BOOST_CHECK(!SetNeuralNetBackend(NeuralNetBackend::NATIVE, layers, error));
+    BOOST_CHECK_EQUAL(NeuralNetBackendName(), "runtime");
+}
+#endif
+
 static void TestSHA3_256(const std::string& input, const std::string& output)
 {
     const auto in_bytes = ParseHex(input);
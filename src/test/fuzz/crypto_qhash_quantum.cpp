@@ -0,0 +1,26 @@
+// Copyright (c) 2024 SimonJRiddix & NeuralLead
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <crypto/cryptoconf.h>
+#include <test/fuzz/FuzzedDataProvider.h>
+#include <test/fuzz/fuzz.h>
+#include <test/fuzz/util.h>
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+void test_one_input(const std::vector<uint8_t>& buffer)
+{
+#ifndef WIN32
+    FuzzedDataProvider fuzzed_data_provider{buffer.data(), buffer.size()};
+    while (fuzzed_data_provider.remaining_bytes() > 0) {
+        uint32_t v[8];
+        for (int i = 0; i < 8; ++i) {
+            v[i] = fuzzed_data_provider.ConsumeIntegral<uint32_t>();
+        }
+        assert(QuantumMix(v) == QuantumMixReference(v));
+    }
+#endif
+}
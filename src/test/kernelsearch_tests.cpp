@@ -0,0 +1,129 @@
+// Copyright (c) 2024 The NeuralLead developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <arith_uint256.h>
+#include <chain.h>
+#include <kernelsearch.h>
+#include <pos.h>
+#include <streams.h>
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(kernelsearch_tests, BasicTestingSetup)
+
+static bool SerialFind(CBlockIndex* pindexPrev, unsigned int nBits, const std::vector<StakeCandidate>& coins, const std::vector<uint32_t>& slots, size_t& slot, size_t& coin)
+{
+    for (slot = 0; slot < slots.size(); ++slot) {
+        for (coin = 0; coin < coins.size(); ++coin) {
+            uint256 hashProofOfStake, targetProofOfStake;
+            if (CheckStakeKernelHash(pindexPrev, nBits, coins[coin].blockFromTime, pindexPrev->nHeight + 1, coins[coin].amount, coins[coin].prevout,
+                                     slots[slot], hashProofOfStake, targetProofOfStake)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+BOOST_AUTO_TEST_CASE(kernel_midstate_matches_full_hash)
+{
+    CBlockIndex index;
+    index.nHeight = 100;
+    for (int i = 0; i < 20; ++i) {
+        index.nStakeModifier = InsecureRand256();
+        const COutPoint prevout(InsecureRand256(), InsecureRand32());
+        const uint32_t blockFromTime = InsecureRand32() / 2;
+        const uint32_t nTimeBlock = blockFromTime + InsecureRand32() / 2;
+
+        CDataStream ss(SER_GETHASH, 0);
+        ss << index.nStakeModifier << blockFromTime << prevout.hash << prevout.n << nTimeBlock;
+        const uint256 expected = Hash(ss);
+
+        uint256 hashProofOfStake, targetProofOfStake;
+        CheckStakeKernelHash(&index, 0x1d00ffff, blockFromTime, index.nHeight + 1, COIN, prevout, nTimeBlock, hashProofOfStake, targetProofOfStake);
+        BOOST_CHECK_EQUAL(hashProofOfStake, expected);
+        const CHash256 midstate = GetStakeKernelMidstate(index.nStakeModifier, blockFromTime, prevout);
+        CheckStakeKernelHash(midstate, 0x1d00ffff, blockFromTime, index.nHeight + 1, COIN, prevout, nTimeBlock, hashProofOfStake, targetProofOfStake);
+        BOOST_CHECK_EQUAL(hashProofOfStake, expected);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(kernelsearch_matches_serial_scan)
+{
+    CBlockIndex index;
+    index.nHeight = 100;
+    index.nStakeModifier = InsecureRand256();
+
+    std::vector<StakeCandidate> coins;
+    for (int i = 0; i < 150; ++i) {
+        coins.push_back({COutPoint(InsecureRand256(), i % 3), 1000, COIN});
+    }
+    const std::vector<uint32_t> slots{100000, 100016, 100032};
+    const auto never = [] { return false; };
+
+    CKernelSearch serial(1);
+    CKernelSearch parallel(4);
+    BOOST_CHECK_EQUAL(parallel.Threads(), 4U);
+    // From almost every pair meeting the target to almost none
+    for (int shift : {28, 32, 36, 44}) {
+        const unsigned int nBits = arith_uint256(~arith_uint256() >> shift).GetCompact();
+        size_t expected_slot = 0, expected_coin = 0;
+        const bool expected = SerialFind(&index, nBits, coins, slots, expected_slot, expected_coin);
+        for (CKernelSearch* search : {&serial, &parallel}) {
+            size_t slot = 0, coin = 0;
+            BOOST_CHECK_EQUAL(search->Find(&index, nBits, coins, slots, never, slot, coin), expected);
+            if (expected) {
+                BOOST_CHECK_EQUAL(slot, expected_slot);
+                BOOST_CHECK_EQUAL(coin, expected_coin);
+            }
+        }
+    }
+
+    // The midstates follow the tip
+    index.nStakeModifier = InsecureRand256();
+    const unsigned int nBits = arith_uint256(~arith_uint256() >> 32).GetCompact();
+    size_t expected_slot = 0, expected_coin = 0;
+    const bool expected = SerialFind(&index, nBits, coins, slots, expected_slot, expected_coin);
+    size_t found_slot = 0, found_coin = 0;
+    BOOST_CHECK_EQUAL(parallel.Find(&index, nBits, coins, slots, never, found_slot, found_coin), expected);
+    BOOST_CHECK(!expected || (found_slot == expected_slot && found_coin == expected_coin));
+    for (const StakeCandidate& candidate : coins) {
+        BOOST_CHECK(candidate.hasMidstate && candidate.midstateModifier == index.nStakeModifier);
+    }
+
+    // An interrupted search finds nothing, the next one runs normally
+    size_t slot, coin;
+    const unsigned int easy = arith_uint256(~arith_uint256() >> 28).GetCompact();
+    BOOST_CHECK(!parallel.Find(&index, easy, coins, slots, [] { return true; }, slot, coin));
+    BOOST_CHECK(parallel.Find(&index, easy, coins, slots, never, slot, coin));
+    std::vector<StakeCandidate> none;
+    BOOST_CHECK(!parallel.Find(&index, easy, none, slots, never, slot, coin));
+}
+
+BOOST_AUTO_TEST_CASE(kernelsearch_reports_stats)
+{
+    CBlockIndex index;
+    index.nHeight = 100;
+    index.nStakeModifier = InsecureRand256();
+
+    std::vector<StakeCandidate> coins;
+    for (int i = 0; i < 150; ++i) {
+        coins.push_back({COutPoint(InsecureRand256(), i % 3), 1000, COIN});
+    }
+    const std::vector<uint32_t> slots{100000, 100016, 100032};
+    const unsigned int unreachable = arith_uint256(1).GetCompact();
+    size_t slot, coin;
+
+    CKernelSearch parallel(4);
+    BOOST_CHECK(!parallel.Find(&index, unreachable, coins, slots, [] { return false; }, slot, coin));
+    const CKernelSearch::Stats& stats = parallel.LastStats();
+    BOOST_CHECK_EQUAL(stats.hashes, coins.size() * slots.size());
+    BOOST_CHECK_EQUAL(stats.slot_times.size(), slots.size());
+    for (int64_t time : stats.slot_times) {
+        BOOST_CHECK(time >= 0 && time <= stats.time);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -769,4 +769,58 @@ BOOST_AUTO_TEST_CASE(PoissonNextSend)
     g_mock_deterministic_tests = false;
 }
 
+
+extern bool mostSecure;
+
+/** Serialize a message of type and payload, and feed it back into deserializer. */
+static Optional<CNetMessage> TransportRoundTrip(TransportSerializer& serializer, TransportDeserializer& deserializer, const std::vector<unsigned char>& payload)
+{
+    CSerializedNetMsg msg;
+    msg.m_type = NetMsgType::PING;
+    msg.data = payload;
+    std::vector<unsigned char> header;
+    serializer.prepareForTransport(msg, header);
+
+    std::vector<unsigned char> wire(header);
+    wire.insert(wire.end(), msg.data.begin(), msg.data.end());
+    const char* pch = (const char*)wire.data();
+    unsigned int bytes = wire.size();
+    while (bytes > 0) {
+        const int handled = deserializer.Read(pch, bytes);
+        BOOST_REQUIRE(handled > 0);
+        pch += handled;
+        bytes -= handled;
+    }
+    BOOST_REQUIRE(deserializer.Complete());
+    uint32_t out_err_raw_size{0};
+    return deserializer.GetMessage(std::chrono::microseconds{0}, out_err_raw_size);
+}
+
+BOOST_AUTO_TEST_CASE(fast_checksum_transport)
+{
+    const bool most_secure = mostSecure;
+    mostSecure = true;
+    const std::vector<unsigned char> payload{1, 2, 3, 4, 5, 6, 7, 8};
+
+    V1TransportSerializer serializer;
+    V1TransportDeserializer deserializer{Params(), (NodeId)0, SER_NETWORK, INIT_PROTO_VERSION};
+
+    // Legacy checksums on both sides
+    BOOST_CHECK(TransportRoundTrip(serializer, deserializer, payload));
+
+    // Once fastchecksum is announced, legacy checksums are still accepted
+    deserializer.AcceptFastChecksum();
+    BOOST_CHECK(TransportRoundTrip(serializer, deserializer, payload));
+
+    serializer.EnableFastChecksum();
+    BOOST_CHECK(TransportRoundTrip(serializer, deserializer, payload));
+    BOOST_CHECK(TransportRoundTrip(serializer, deserializer, {}));
+
+    // A CRC32C checksum is rejected by a peer that did not announce fastchecksum
+    V1TransportDeserializer legacy{Params(), (NodeId)1, SER_NETWORK, INIT_PROTO_VERSION};
+    BOOST_CHECK(!TransportRoundTrip(serializer, legacy, payload));
+
+    mostSecure = most_secure;
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,46 @@
+// Copyright (c) 2024 The NeuralLead developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <key.h>
+#include <pos.h>
+#include <test/util/setup_common.h>
+
+#include <algorithm>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(pos_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(block_signers_match_full_recovery)
+{
+    for (bool compressed : {true, false}) {
+        CKey key;
+        key.MakeNewKey(compressed);
+        CBlockHeader header;
+        header.nTime = 1700000000;
+        header.prevoutStake = COutPoint(InsecureRand256(), 1);
+        BOOST_CHECK(key.Sign(header.GetHashWithoutSign(), header.vchBlockSig));
+
+        std::vector<CKeyID> signers;
+        BOOST_CHECK(RecoverBlockSigners(header, signers));
+        BOOST_CHECK(std::count(signers.begin(), signers.end(), key.GetPubKey().GetID()) == 1);
+
+        // Same keys as one recovery per recovery id and encoding
+        std::vector<CKeyID> expected;
+        for (uint8_t recid = 0; recid <= 3; ++recid) {
+            for (bool comp : {true, false}) {
+                CPubKey pubkey;
+                if (pubkey.RecoverLaxDER(header.GetHashWithoutSign(), header.vchBlockSig, recid, comp)) expected.push_back(pubkey.GetID());
+            }
+        }
+        BOOST_CHECK(signers == expected);
+    }
+
+    CBlockHeader unsigned_header;
+    std::vector<CKeyID> signers{CKeyID()};
+    BOOST_CHECK(!RecoverBlockSigners(unsigned_header, signers));
+    BOOST_CHECK(signers.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
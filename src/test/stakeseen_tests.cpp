@@ -0,0 +1,54 @@
+// Copyright (c) 2024 The NeuralLead developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <stakeseen.h>
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(stakeseen_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(stakeseen_expires_old_stakes)
+{
+    CStakeSeen seen;
+    const int64_t now = 1700000000;
+    const CStakeSeen::Stake old(COutPoint(InsecureRand256(), 0), now - STAKE_SEEN_WINDOW - 2 * STAKE_SEEN_BUCKET);
+    const CStakeSeen::Stake recent(COutPoint(InsecureRand256(), 1), now - 2 * STAKE_SEEN_BUCKET);
+
+    seen.insert(old);
+    seen.insert(recent);
+    BOOST_CHECK_EQUAL(seen.count(old), 1U);
+    BOOST_CHECK_EQUAL(seen.count(recent), 1U);
+    // Same prevout, other time
+    BOOST_CHECK_EQUAL(seen.count(CStakeSeen::Stake(recent.first, recent.second + 16)), 0U);
+
+    // A newer stake moves the window past the old one
+    seen.insert(CStakeSeen::Stake(COutPoint(InsecureRand256(), 0), now));
+    BOOST_CHECK_EQUAL(seen.count(old), 0U);
+    BOOST_CHECK_EQUAL(seen.count(recent), 1U);
+    BOOST_CHECK_EQUAL(seen.size(), 2U);
+
+    // Stakes already out of the window are not kept
+    seen.insert(old);
+    BOOST_CHECK_EQUAL(seen.count(old), 0U);
+    BOOST_CHECK_EQUAL(seen.size(), 2U);
+
+    seen.clear();
+    BOOST_CHECK_EQUAL(seen.size(), 0U);
+    BOOST_CHECK_EQUAL(seen.count(recent), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(stakeseen_is_bounded)
+{
+    CStakeSeen seen;
+    const int64_t now = 1700000000;
+    // More stakes than the cap, all within half a window
+    for (size_t i = 0; i < MAX_STAKE_SEEN + 1000; ++i) {
+        seen.insert(CStakeSeen::Stake(COutPoint(InsecureRand256(), 0), now + i * (STAKE_SEEN_WINDOW / 2) / MAX_STAKE_SEEN));
+    }
+    BOOST_CHECK(seen.size() <= MAX_STAKE_SEEN);
+    BOOST_CHECK(seen.DynamicMemoryUsage() <= CStakeSeen::MaxDynamicMemoryUsage());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
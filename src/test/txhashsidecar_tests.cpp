@@ -0,0 +1,133 @@
+// Copyright (c) 2024 The NeuralLead developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <clientversion.h>
+#include <primitives/block.h>
+#include <streams.h>
+#include <test/util/setup_common.h>
+#include <txhashsidecar.h>
+#include <util/system.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(txhashsidecar_tests, BasicTestingSetup)
+
+static CBlock MakeBlock(int ntx)
+{
+    CBlock block;
+    block.nVersion = 4;
+    block.nTime = 1700000000;
+    for (int i = 0; i < ntx; ++i) {
+        CMutableTransaction mtx;
+        mtx.vin.resize(1);
+        mtx.vin[0].prevout = COutPoint(InsecureRand256(), i);
+        mtx.vin[0].scriptWitness.stack.push_back(std::vector<unsigned char>(i + 1, 0x42));
+        mtx.vout.resize(1);
+        mtx.vout[0].nValue = i * COIN;
+        block.vtx.push_back(MakeTransactionRef(std::move(mtx)));
+    }
+    return block;
+}
+
+static std::vector<uint8_t> Serialize(const CBlock& block)
+{
+    CDataStream stream(SER_DISK, CLIENT_VERSION);
+    stream << block;
+    return std::vector<uint8_t>(stream.begin(), stream.end());
+}
+
+BOOST_AUTO_TEST_CASE(txhashsidecar_roundtrip)
+{
+    TxHashSidecar sidecar(GetDataDir());
+    const CBlock block = MakeBlock(5);
+    const std::vector<uint8_t> raw = Serialize(block);
+    const FlatFilePos pos(3, 1234);
+
+    TxHashSidecar::Entry entry;
+    BOOST_CHECK(!sidecar.Find(pos, entry));
+    sidecar.Add(pos, block, raw);
+    BOOST_REQUIRE(sidecar.Find(pos, entry));
+    BOOST_CHECK(!sidecar.Find(FlatFilePos(3, 1235), entry));
+
+    // A fresh instance finds the record on disk
+    TxHashSidecar reopened(GetDataDir());
+    BOOST_REQUIRE(reopened.Find(pos, entry));
+    BOOST_CHECK_EQUAL(entry.hashes.size(), block.vtx.size());
+
+    CBlock read;
+    BOOST_REQUIRE(TxHashSidecar::Deserialize(raw, entry, read));
+    BOOST_CHECK_EQUAL(read.GetHash(), block.GetHash());
+    BOOST_REQUIRE_EQUAL(read.vtx.size(), block.vtx.size());
+    for (size_t i = 0; i < block.vtx.size(); ++i) {
+        BOOST_CHECK_EQUAL(read.vtx[i]->GetHash(), block.vtx[i]->GetHash());
+        BOOST_CHECK_EQUAL(read.vtx[i]->GetWitnessHash(), block.vtx[i]->GetWitnessHash());
+        BOOST_CHECK(*read.vtx[i] == *block.vtx[i]);
+    }
+
+    // Block bytes that changed since the record was written are rejected
+    std::vector<uint8_t> modified = raw;
+    modified[modified.size() / 2] ^= 1;
+    BOOST_CHECK(!TxHashSidecar::Deserialize(modified, entry, read));
+
+    reopened.Remove(3);
+    BOOST_CHECK(!reopened.Find(pos, entry));
+    BOOST_CHECK(!fs::exists(GetDataDir() / "txh00003.dat"));
+}
+
+BOOST_AUTO_TEST_CASE(txhashsidecar_torn_record)
+{
+    const CBlock block1 = MakeBlock(2);
+    const CBlock block2 = MakeBlock(3);
+    {
+        TxHashSidecar sidecar(GetDataDir());
+        sidecar.Add(FlatFilePos(0, 8), block1, Serialize(block1));
+    }
+
+    // Simulate a crash in the middle of an append
+    {
+        FILE* f = fsbridge::fopen(GetDataDir() / "txh00000.dat", "ab");
+        BOOST_REQUIRE(f);
+        const unsigned char partial[] = {0x74, 0x78, 0x68, 0x73, 0x10, 0x00};
+        fwrite(partial, 1, sizeof(partial), f);
+        fclose(f);
+    }
+
+    TxHashSidecar sidecar(GetDataDir());
+    TxHashSidecar::Entry entry;
+    BOOST_CHECK(sidecar.Find(FlatFilePos(0, 8), entry));
+    sidecar.Add(FlatFilePos(0, 500), block2, Serialize(block2));
+
+    TxHashSidecar reopened(GetDataDir());
+    BOOST_CHECK(reopened.Find(FlatFilePos(0, 8), entry));
+    BOOST_REQUIRE(reopened.Find(FlatFilePos(0, 500), entry));
+    BOOST_CHECK_EQUAL(entry.hashes.size(), 3U);
+}
+
+BOOST_AUTO_TEST_CASE(txhashsidecar_replaces_stale_record)
+{
+    const CBlock block1 = MakeBlock(2);
+    const CBlock block2 = MakeBlock(3);
+    const std::vector<uint8_t> raw2 = Serialize(block2);
+    const FlatFilePos pos(1, 8);
+
+    TxHashSidecar sidecar(GetDataDir());
+    sidecar.Add(pos, block1, Serialize(block1));
+
+    // The block file was rewritten at the same position
+    TxHashSidecar::Entry entry;
+    BOOST_REQUIRE(sidecar.Find(pos, entry));
+    CBlock read;
+    BOOST_CHECK(!TxHashSidecar::Deserialize(raw2, entry, read));
+    sidecar.Add(pos, block2, raw2);
+    BOOST_REQUIRE(sidecar.Find(pos, entry));
+    BOOST_CHECK(TxHashSidecar::Deserialize(raw2, entry, read));
+
+    // The latest record also wins when the file is scanned again
+    TxHashSidecar reopened(GetDataDir());
+    BOOST_REQUIRE(reopened.Find(pos, entry));
+    BOOST_REQUIRE(TxHashSidecar::Deserialize(raw2, entry, read));
+    BOOST_CHECK_EQUAL(read.GetHash(), block2.GetHash());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
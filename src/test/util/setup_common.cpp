@@ -10,6 +10,7 @@
 #include <consensus/params.h>
 #include <consensus/validation.h>
 #include <crypto/neuralleadqhash_interface.h>
+#include <crypto/sha256.h>
 #include <init.h>
 #include <interfaces/chain.h>
 #include <miner.h>
@@ -101,6 +102,7 @@ BasicTestingSetup::BasicTestingSetup(const std::string& chainName, const std::ve
     AppInitParameterInteraction(*m_node.args);
     LogInstance().StartLogging();
     SHA256AutoDetect();
+    LocalSHA256AutoDetect();
     ECC_Start();
     SetupEnvironment();
     SetupNetworking();
@@ -164,6 +166,7 @@ TestingSetup::TestingSetup(const std::string& chainName, const std::vector<const
     constexpr int script_check_threads = 2;
     for (int i = 0; i < script_check_threads; ++i) {
         threadGroup.create_thread([i]() { return ThreadScriptCheck(i); });
+        threadGroup.create_thread([i]() { return ThreadHeaderSigCheck(i); });
     }
     g_parallel_script_checks = true;
 
@@ -2,6 +2,7 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <chain.h>
 #include <chainparams.h>
 #include <net.h>
 #include <signet.h>
@@ -119,4 +120,81 @@ BOOST_AUTO_TEST_CASE(signet_parse_tests)
     BOOST_CHECK(!CheckSignetBlockSolution(block, signet_params->GetConsensus()));
 }
 
+//! Offset of the nonce in the header of the block stored at pos
+static long NonceOffset(const FlatFilePos& pos)
+{
+    return pos.nPos + 4 + 32 + 32 + 4 + 4;
+}
+
+//! Flip the lowest bit of the byte at offset in the block file of pos
+static void FlipBlockFileBit(const FlatFilePos& pos, long offset)
+{
+    FILE* file = fsbridge::fopen(GetBlockPosFilename(pos), "rb+");
+    BOOST_REQUIRE(file);
+    BOOST_REQUIRE(fseek(file, offset, SEEK_SET) == 0);
+    const int byte = fgetc(file);
+    BOOST_REQUIRE(byte != EOF && fseek(file, offset, SEEK_SET) == 0);
+    fputc(byte ^ 1, file);
+    fclose(file);
+}
+
+BOOST_AUTO_TEST_CASE(read_block_frame_test)
+{
+    const CBlockIndex* genesis = WITH_LOCK(cs_main, return ::ChainActive().Genesis());
+    BOOST_REQUIRE(genesis && genesis->IsValid(BLOCK_VALID_TRANSACTIONS));
+    const Consensus::Params& consensus = Params().GetConsensus();
+
+    CBlock block;
+    BOOST_REQUIRE(ReadBlockFromDisk(block, genesis, consensus));
+    BOOST_CHECK_EQUAL(block.GetHash(), genesis->GetBlockHash());
+    BOOST_CHECK_EQUAL(block.GetHash(), Params().GenesisBlock().GetHash());
+
+    // Change the nonce of the stored header: the frame checksum no longer
+    // matches, so the read falls back to the full proof and hash checks
+    const FlatFilePos pos = WITH_LOCK(cs_main, return genesis->GetBlockPos());
+    FlipBlockFileBit(pos, NonceOffset(pos));
+    BOOST_CHECK(!ReadBlockFromDisk(block, genesis, consensus));
+
+    FlipBlockFileBit(pos, NonceOffset(pos));
+    BOOST_CHECK(ReadBlockFromDisk(block, genesis, consensus));
+}
+
+BOOST_AUTO_TEST_CASE(read_block_skips_proof_check)
+{
+    const CBlockIndex* genesis = WITH_LOCK(cs_main, return ::ChainActive().Genesis());
+    BOOST_REQUIRE(genesis && genesis->IsValid(BLOCK_VALID_TRANSACTIONS));
+    const Consensus::Params& consensus = Params().GetConsensus();
+
+    // Validated, intact footer and a header matching the index: no proof re-hash
+    CBlock block;
+    const uint64_t checks = g_read_block_proof_checks;
+    BOOST_REQUIRE(ReadBlockFromDisk(block, genesis, consensus));
+    BOOST_CHECK_EQUAL(g_read_block_proof_checks, checks);
+    BOOST_CHECK_EQUAL(block.GetHash(), genesis->GetBlockHash());
+
+    // The read by position does not know the block was validated
+    const FlatFilePos pos = WITH_LOCK(cs_main, return genesis->GetBlockPos());
+    BOOST_REQUIRE(ReadBlockFromDisk(block, pos, consensus));
+    BOOST_CHECK_EQUAL(g_read_block_proof_checks, checks + 1);
+}
+
+BOOST_AUTO_TEST_CASE(read_block_tampered_header_falls_back)
+{
+    const CBlockIndex* genesis = WITH_LOCK(cs_main, return ::ChainActive().Genesis());
+    BOOST_REQUIRE(genesis && genesis->IsValid(BLOCK_VALID_TRANSACTIONS));
+    const Consensus::Params& consensus = Params().GetConsensus();
+    const FlatFilePos pos = WITH_LOCK(cs_main, return genesis->GetBlockPos());
+
+    // A tampered header breaks the footer CRC, so the proof is checked again
+    CBlock block;
+    FlipBlockFileBit(pos, NonceOffset(pos));
+    const uint64_t checks = g_read_block_proof_checks;
+    BOOST_CHECK(!ReadBlockFromDisk(block, genesis, consensus));
+    BOOST_CHECK_EQUAL(g_read_block_proof_checks, checks + 1);
+
+    FlipBlockFileBit(pos, NonceOffset(pos));
+    BOOST_CHECK(ReadBlockFromDisk(block, genesis, consensus));
+    BOOST_CHECK_EQUAL(g_read_block_proof_checks, checks + 1);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
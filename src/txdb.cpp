@@ -16,7 +16,9 @@
 #include <util/vector.h>
 #include <validation.h>
 
+#include <atomic>
 #include <stdint.h>
+#include <thread>
 
 #include <boost/thread.hpp>
 
@@ -81,6 +83,7 @@ std::vector<uint256> CCoinsViewDB::GetHeadBlocks() const {
 }
 
 bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) {
+    ++m_write_generation;
     CDBBatch batch(*m_db);
     size_t count = 0;
     size_t changed = 0;
@@ -137,6 +140,7 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) {
 
     LogPrint(BCLog::COINDB, "Writing final batch of %.2f MiB\n", batch.SizeEstimate() * (1.0 / 1048576.0));
     bool ret = m_db->WriteBatch(batch);
+    ++m_write_generation;
     LogPrint(BCLog::COINDB, "Committed %u changed transaction outputs (out of %u) to coin database...\n", (unsigned int)changed, (unsigned int)count);
     return ret;
 }
@@ -234,6 +238,15 @@ bool CBlockTreeDB::WriteBatchSync(const std::vector<std::pair<int, const CBlockF
     return WriteBatch(batch, true);
 }
 
+bool CBlockTreeDB::ReadBlockIndexCold(const uint256& hash, CBlockIndexCold& cold) {
+    CDiskBlockIndex diskindex;
+    if (!Read(std::make_pair(DB_BLOCK_INDEX, hash), diskindex))
+        return false;
+    cold.vchBlockSig = std::move(diskindex.vchBlockSig);
+    cold.hashProof = diskindex.hashProof;
+    return true;
+}
+
 bool CBlockTreeDB::WriteFlag(const std::string &name, bool fValue) {
     return Write(std::make_pair(DB_FLAG, name), fValue ? '1' : '0');
 }
@@ -246,54 +259,81 @@ bool CBlockTreeDB::ReadFlag(const std::string &name, bool &fValue) {
     return true;
 }
 
-bool CBlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex)
+bool CBlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<void(std::vector<CBlockIndexEntry>&)> insertEntries, bool rehash_headers, int threads)
 {
-    std::unique_ptr<CDBIterator> pcursor(NewIterator());
-
-    pcursor->Seek(std::make_pair(DB_BLOCK_INDEX, uint256()));
-
-    // Load m_block_index
-    while (pcursor->Valid()) {
-        if (ShutdownRequested()) return false;
-        std::pair<char, uint256> key;
-        if (pcursor->GetKey(key) && key.first == DB_BLOCK_INDEX) {
+    // Block index keys are ordered by the first byte of the block hash, split them in one range per thread
+    threads = std::max(1, std::min(threads, 256));
+    std::vector<std::vector<CBlockIndexEntry>> ranges(threads);
+    std::atomic<bool> failed{false};
+
+    auto read_range = [&](int range) {
+        const unsigned int range_end = 256 * (range + 1) / threads;
+        uint256 start;
+        *start.begin() = 256 * range / threads;
+        std::unique_ptr<CDBIterator> pcursor(NewIterator());
+        pcursor->Seek(std::make_pair(DB_BLOCK_INDEX, start));
+
+        std::vector<CBlockIndexEntry>& entries = ranges[range];
+        while (pcursor->Valid() && !failed) {
+            if (ShutdownRequested()) {
+                failed = true;
+                return;
+            }
+            std::pair<char, uint256> key;
+            if (!pcursor->GetKey(key) || key.first != DB_BLOCK_INDEX || *key.second.begin() >= range_end) break;
             CDiskBlockIndex diskindex;
-            if (pcursor->GetValue(diskindex)) {
-                // Construct block index object
-                CBlockIndex* pindexNew = insertBlockIndex(diskindex.GetBlockHash());
-                pindexNew->pprev          = insertBlockIndex(diskindex.hashPrev);
-                pindexNew->nHeight        = diskindex.nHeight;
-                pindexNew->nFile          = diskindex.nFile;
-                pindexNew->nDataPos       = diskindex.nDataPos;
-                pindexNew->nUndoPos       = diskindex.nUndoPos;
-                pindexNew->nVersion       = diskindex.nVersion;
-                pindexNew->hashMerkleRoot = diskindex.hashMerkleRoot;
-                pindexNew->nTime          = diskindex.nTime;
-                pindexNew->nBits          = diskindex.nBits;
-                pindexNew->nNonce         = diskindex.nNonce;
-                pindexNew->nStatus        = diskindex.nStatus;
-                pindexNew->nTx            = diskindex.nTx;
-                pindexNew->nStakeModifier = diskindex.nStakeModifier;
-                pindexNew->prevoutStake   = diskindex.prevoutStake;
-                pindexNew->vchBlockSig    = diskindex.vchBlockSig;
-                pindexNew->nMoneySupply   = diskindex.nMoneySupply;
-
-                if (!CheckIndexProof(*pindexNew, consensusParams))
-                    return error("%s: CheckIndexProof failed: %s", __func__, pindexNew->ToString());
-
-                if (pindexNew->IsProofOfStake())
-                    ::StakeSeen().insert(std::make_pair(pindexNew->prevoutStake, pindexNew->nTime));
-                
-                pcursor->Next();
-            } else {
-                return error("%s: failed to read value", __func__);
+            if (!pcursor->GetValue(diskindex)) {
+                error("%s: failed to read value", __func__);
+                failed = true;
+                return;
             }
-        } else {
-            break;
+            if (rehash_headers && diskindex.GetBlockHash() != key.second) {
+                error("%s: block index entry %s does not match its header", __func__, key.second.ToString());
+                failed = true;
+                return;
+            }
+
+            // Construct block index object, the signature stays in the DB
+            entries.push_back({key.second, diskindex.hashPrev, CBlockIndex()});
+            CBlockIndex* pindexNew = &entries.back().index;
+            pindexNew->phashBlock     = &entries.back().hash;
+            pindexNew->nHeight        = diskindex.nHeight;
+            pindexNew->nFile          = diskindex.nFile;
+            pindexNew->nDataPos       = diskindex.nDataPos;
+            pindexNew->nUndoPos       = diskindex.nUndoPos;
+            pindexNew->nVersion       = diskindex.nVersion;
+            pindexNew->hashMerkleRoot = diskindex.hashMerkleRoot;
+            pindexNew->nTime          = diskindex.nTime;
+            pindexNew->nBits          = diskindex.nBits;
+            pindexNew->nNonce         = diskindex.nNonce;
+            pindexNew->nStatus        = diskindex.nStatus;
+            pindexNew->nTx            = diskindex.nTx;
+            pindexNew->nStakeModifier = diskindex.nStakeModifier;
+            pindexNew->prevoutStake   = diskindex.prevoutStake;
+            pindexNew->nMoneySupply   = diskindex.nMoneySupply;
+
+            if (!CheckIndexProof(*pindexNew, consensusParams)) {
+                error("%s: CheckIndexProof failed: %s", __func__, pindexNew->ToString());
+                failed = true;
+                return;
+            }
+            // The entries vector may move, the block map points it to its own copy of the hash
+            pindexNew->phashBlock = nullptr;
+
+            pcursor->Next();
         }
-    }
+    };
 
-    return true;
+    std::vector<std::thread> readers;
+    for (int range = 0; range < threads; ++range) {
+        readers.emplace_back(read_range, range);
+    }
+    for (int range = 0; range < threads; ++range) {
+        readers[range].join();
+        if (!failed) insertEntries(ranges[range]);
+        std::vector<CBlockIndexEntry>().swap(ranges[range]);
+    }
+    return !failed;
 }
 
 bool CBlockTreeDB::WriteStakeIndex(unsigned int height, uint160 address) {
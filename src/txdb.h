@@ -11,6 +11,7 @@
 #include <chain.h>
 #include <primitives/block.h>
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <utility>
@@ -69,6 +70,13 @@ public:
 
     //! Dynamically alter the underlying leveldb cache size.
     void ResizeCache(size_t new_cache_size) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+    //! Incremented when BatchWrite starts and when it ends, coins read while it was odd or
+    //! before it changed may be stale
+    uint64_t GetWriteGeneration() const { return m_write_generation; }
+
+private:
+    std::atomic<uint64_t> m_write_generation{0};
 };
 
 /** Specialization of CCoinsViewCursor to iterate over a CCoinsViewDB */
@@ -93,6 +101,14 @@ private:
     friend class CCoinsViewDB;
 };
 
+/** A block index entry built by LoadBlockIndexGuts, not linked to its parent yet */
+struct CBlockIndexEntry
+{
+    uint256 hash;
+    uint256 hashPrev;
+    CBlockIndex index;
+};
+
 /** Access to the block database (blocks/index/) */
 class CBlockTreeDB : public CDBWrapper
 {
@@ -100,13 +116,20 @@ public:
     explicit CBlockTreeDB(size_t nCacheSize, bool fMemory = false, bool fWipe = false);
 
     bool WriteBatchSync(const std::vector<std::pair<int, const CBlockFileInfo*> >& fileInfo, int nLastFile, const std::vector<const CBlockIndex*>& blockinfo);
+    bool ReadBlockIndexCold(const uint256& hash, CBlockIndexCold& cold);
     bool ReadBlockFileInfo(int nFile, CBlockFileInfo &info);
     bool ReadLastBlockFile(int &nFile);
     bool WriteReindexing(bool fReindexing);
     void ReadReindexing(bool &fReindexing);
     bool WriteFlag(const std::string &name, bool fValue);
     bool ReadFlag(const std::string &name, bool &fValue);
-    bool LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex);
+    /** Load all block index entries. Entries are keyed by their block hash, which is trusted
+     *  unless rehash_headers is set, as hashing every header is the bulk of the startup time.
+     *  Each of the threads reads and builds the entries of its own range of block hashes, and
+     *  insertEntries is given the entries of each range on the calling thread, in order, as soon
+     *  as that range has been read, while the later ranges may still be being read. It may move
+     *  from or free the vector. */
+    bool LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<void(std::vector<CBlockIndexEntry>&)> insertEntries, bool rehash_headers = false, int threads = 1);
 
     bool WriteStakeIndex(unsigned int height, uint160 address);
     bool ReadStakeIndex(unsigned int height, uint160& address);
@@ -0,0 +1,181 @@
+// Copyright (c) 2024 The NeuralLead developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <txhashsidecar.h>
+
+#include <clientversion.h>
+#include <crypto/common.h>
+#include <primitives/block.h>
+#include <streams.h>
+#include <tinyformat.h>
+#include <util/system.h>
+
+#include <crc32c/crc32c.h>
+
+std::unique_ptr<TxHashSidecar> g_txhash_sidecar;
+
+namespace {
+//! magic, block data position, block size, block CRC32C, transaction count
+constexpr size_t RECORD_HEADER_SIZE = 20;
+constexpr size_t RECORD_HASHES_SIZE = 64;
+constexpr size_t RECORD_TRAILER_SIZE = 4;
+} // namespace
+
+TxHashSidecar::TxHashSidecar(const fs::path& blocks_dir) : m_dir(blocks_dir) {}
+
+TxHashSidecar::~TxHashSidecar()
+{
+    LOCK(m_mutex);
+    Close();
+}
+
+fs::path TxHashSidecar::FileName(int file) const
+{
+    return m_dir / strprintf("txh%05u.dat", file);
+}
+
+void TxHashSidecar::Scan(int file)
+{
+    if (!m_scanned.insert(file).second) return;
+
+    std::unordered_map<uint32_t, uint64_t>& offsets = m_offsets[file];
+    const fs::path path = FileName(file);
+    FILE* f = fsbridge::fopen(path, "rb");
+    if (!f) return;
+
+    fseek(f, 0, SEEK_END);
+    const long file_size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    uint64_t offset = 0;
+    unsigned char header[RECORD_HEADER_SIZE];
+    while (fread(header, 1, sizeof(header), f) == sizeof(header) && ReadLE32(header) == RECORD_MAGIC) {
+        const uint64_t record_size = RECORD_HEADER_SIZE + (uint64_t)ReadLE32(header + 16) * RECORD_HASHES_SIZE + RECORD_TRAILER_SIZE;
+        if (offset + record_size > (uint64_t)file_size) break;
+        // A later record for the same block supersedes the earlier ones
+        offsets[ReadLE32(header + 4)] = offset;
+        offset += record_size;
+        if (fseek(f, offset, SEEK_SET) != 0) break;
+    }
+    fclose(f);
+
+    // Drop a torn record left by a crash, so that later appends stay reachable
+    if (offset < (uint64_t)file_size) {
+        LogPrintf("%s: truncating %s from %d to %d bytes\n", __func__, path.string(), file_size, offset);
+        try {
+            fs::resize_file(path, offset);
+        } catch (const fs::filesystem_error& e) {
+            LogPrintf("%s: %s\n", __func__, fsbridge::get_filesystem_error_message(e));
+        }
+    }
+}
+
+FILE* TxHashSidecar::Open(int file)
+{
+    if (m_file_num == file) return m_file;
+    Close();
+    m_file = fsbridge::fopen(FileName(file), "a+b");
+    if (m_file) m_file_num = file;
+    return m_file;
+}
+
+void TxHashSidecar::Close()
+{
+    if (m_file) fclose(m_file);
+    m_file = nullptr;
+    m_file_num = -1;
+}
+
+bool TxHashSidecar::Find(const FlatFilePos& pos, Entry& entry)
+{
+    LOCK(m_mutex);
+    Scan(pos.nFile);
+    const auto& offsets = m_offsets[pos.nFile];
+    const auto it = offsets.find(pos.nPos);
+    if (it == offsets.end()) return false;
+    const uint64_t offset = it->second;
+
+    FILE* f = Open(pos.nFile);
+    if (!f) return false;
+    std::vector<unsigned char> record(RECORD_HEADER_SIZE);
+    bool ok = fseek(f, offset, SEEK_SET) == 0 && fread(record.data(), 1, RECORD_HEADER_SIZE, f) == RECORD_HEADER_SIZE &&
+              ReadLE32(record.data()) == RECORD_MAGIC && ReadLE32(record.data() + 4) == pos.nPos;
+    if (ok) {
+        const uint32_t count = ReadLE32(record.data() + 16);
+        record.resize(RECORD_HEADER_SIZE + (size_t)count * RECORD_HASHES_SIZE + RECORD_TRAILER_SIZE);
+        ok = fread(record.data() + RECORD_HEADER_SIZE, 1, record.size() - RECORD_HEADER_SIZE, f) == record.size() - RECORD_HEADER_SIZE &&
+             crc32c::Crc32c(record.data(), record.size() - RECORD_TRAILER_SIZE) == ReadLE32(record.data() + record.size() - RECORD_TRAILER_SIZE);
+    }
+    if (!ok) return false;
+
+    entry.block_size = ReadLE32(record.data() + 8);
+    entry.block_crc = ReadLE32(record.data() + 12);
+    const uint32_t count = ReadLE32(record.data() + 16);
+    entry.hashes.resize(count);
+    const unsigned char* p = record.data() + RECORD_HEADER_SIZE;
+    for (uint32_t i = 0; i < count; ++i, p += RECORD_HASHES_SIZE) {
+        memcpy(entry.hashes[i].first.begin(), p, 32);
+        memcpy(entry.hashes[i].second.begin(), p + 32, 32);
+    }
+    return true;
+}
+
+void TxHashSidecar::Add(const FlatFilePos& pos, const CBlock& block, const std::vector<uint8_t>& raw)
+{
+    std::vector<unsigned char> record(RECORD_HEADER_SIZE + block.vtx.size() * RECORD_HASHES_SIZE + RECORD_TRAILER_SIZE);
+    WriteLE32(record.data(), RECORD_MAGIC);
+    WriteLE32(record.data() + 4, pos.nPos);
+    WriteLE32(record.data() + 8, raw.size());
+    WriteLE32(record.data() + 12, crc32c::Crc32c(raw.data(), raw.size()));
+    WriteLE32(record.data() + 16, block.vtx.size());
+    unsigned char* p = record.data() + RECORD_HEADER_SIZE;
+    for (const auto& tx : block.vtx) {
+        memcpy(p, tx->GetHash().begin(), 32);
+        memcpy(p + 32, tx->GetWitnessHash().begin(), 32);
+        p += RECORD_HASHES_SIZE;
+    }
+    WriteLE32(p, crc32c::Crc32c(record.data(), record.size() - RECORD_TRAILER_SIZE));
+
+    LOCK(m_mutex);
+    Scan(pos.nFile);
+    FILE* f = Open(pos.nFile);
+    if (!f) return;
+    fseek(f, 0, SEEK_END);
+    const long offset = ftell(f);
+    const bool ok = offset >= 0 && fwrite(record.data(), 1, record.size(), f) == record.size();
+    if (fflush(f) == 0 && ok) {
+        // Supersedes a stale record at the same position, if any
+        m_offsets[pos.nFile][pos.nPos] = offset;
+    } else {
+        Close();
+    }
+}
+
+void TxHashSidecar::Remove(int file)
+{
+    LOCK(m_mutex);
+    if (m_file_num == file) Close();
+    m_scanned.erase(file);
+    m_offsets.erase(file);
+    fs::remove(FileName(file));
+}
+
+bool TxHashSidecar::Deserialize(const std::vector<uint8_t>& raw, const Entry& entry, CBlock& block)
+{
+    if (raw.size() != entry.block_size || crc32c::Crc32c(raw.data(), raw.size()) != entry.block_crc) return false;
+
+    try {
+        VectorReader stream(SER_DISK, CLIENT_VERSION, raw, 0);
+        block.SetNull();
+        stream >> static_cast<CBlockHeader&>(block);
+        if (ReadCompactSize(stream) != entry.hashes.size()) return false;
+        block.vtx.reserve(entry.hashes.size());
+        for (const auto& hashes : entry.hashes) {
+            block.vtx.push_back(std::make_shared<const CTransaction>(CMutableTransaction(deserialize, stream), hashes.first, hashes.second));
+        }
+        return stream.empty();
+    } catch (const std::exception&) {
+        return false;
+    }
+}
@@ -0,0 +1,83 @@
+// Copyright (c) 2024 The NeuralLead developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_TXHASHSIDECAR_H
+#define BITCOIN_TXHASHSIDECAR_H
+
+#include <flatfile.h>
+#include <fs.h>
+#include <sync.h>
+#include <uint256.h>
+
+#include <map>
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+class CBlock;
+
+/** Default for -txhashsidecar */
+static const bool DEFAULT_TXHASH_SIDECAR = false;
+
+/**
+ * Sidecar files (txh?????.dat next to blk?????.dat) holding the txids and wtxids
+ * of the blocks stored in the matching block file, so that reading a block back
+ * does not have to hash every transaction again.
+ *
+ * Each block gets an append-only record:
+ *   magic, block data position, block size, CRC32C of the serialized block,
+ *   transaction count, (txid, wtxid) per transaction, CRC32C of the record.
+ * The hashes are only used when the CRC32C of the block bytes read from disk
+ * matches, which is much cheaper than recomputing them. Records that are torn,
+ * corrupted or stale are ignored and the block is hashed as usual; a stale
+ * record is superseded by appending a new one for the same position.
+ */
+class TxHashSidecar
+{
+public:
+    struct Entry {
+        uint32_t block_size{0};
+        uint32_t block_crc{0};
+        std::vector<std::pair<uint256, uint256>> hashes;
+    };
+
+    explicit TxHashSidecar(const fs::path& blocks_dir);
+    ~TxHashSidecar();
+
+    /** Look up the record of the block stored at pos. */
+    bool Find(const FlatFilePos& pos, Entry& entry);
+
+    /** Record the hashes of block, stored at pos and serialized as raw, replacing any earlier record. */
+    void Add(const FlatFilePos& pos, const CBlock& block, const std::vector<uint8_t>& raw);
+
+    /** Forget and delete the sidecar of a pruned block file. */
+    void Remove(int file);
+
+    /** Deserialize the block in raw using the hashes of entry, if entry describes these exact bytes. */
+    static bool Deserialize(const std::vector<uint8_t>& raw, const Entry& entry, CBlock& block);
+
+private:
+    static constexpr uint32_t RECORD_MAGIC = 0x73687874; // "txhs"
+
+    const fs::path m_dir;
+    Mutex m_mutex;
+    //! Files whose records have been scanned into m_offsets
+    std::set<int> m_scanned GUARDED_BY(m_mutex);
+    //! Record offset in the sidecar by block file and block data position
+    std::map<int, std::unordered_map<uint32_t, uint64_t>> m_offsets GUARDED_BY(m_mutex);
+    //! Last sidecar used, kept open for the next lookup or append
+    FILE* m_file GUARDED_BY(m_mutex){nullptr};
+    int m_file_num GUARDED_BY(m_mutex){-1};
+
+    fs::path FileName(int file) const;
+    void Scan(int file) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+    FILE* Open(int file) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+    void Close() EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+};
+
+/** Sidecar in use, or null if -txhashsidecar is disabled */
+extern std::unique_ptr<TxHashSidecar> g_txhash_sidecar;
+
+#endif // BITCOIN_TXHASHSIDECAR_H
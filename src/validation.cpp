@@ -6,15 +6,19 @@
 #include <validation.h>
 
 #include <arith_uint256.h>
+#include <blockindexcold.h>
 #include <chain.h>
 #include <chainparams.h>
 #include <checkpoints.h>
 #include <checkqueue.h>
+#include <coinsprefetch.h>
 #include <consensus/consensus.h>
 #include <consensus/merkle.h>
 #include <consensus/tx_check.h>
 #include <consensus/tx_verify.h>
 #include <consensus/validation.h>
+#include <crypto/common.h>
+#include <crypto/sha256.h>
 #include <cuckoocache.h>
 #include <flatfile.h>
 #include <hash.h>
@@ -40,6 +44,7 @@
 #include <timedata.h>
 #include <tinyformat.h>
 #include <txdb.h>
+#include <txhashsidecar.h>
 #include <txmempool.h>
 #include <uint256.h>
 #include <undo.h>
@@ -57,9 +62,12 @@
 #include <key_io.h>
 
 #include <string>
+#include <thread>
 
 #include <boost/algorithm/string/replace.hpp>
 
+#include <crc32c/crc32c.h>
+
 #define MICRO 0.000001
 #define MILLI 0.001
 
@@ -146,6 +154,7 @@ bool fHavePruned = false;
 bool fPruneMode = false;
 bool fRequireStandard = true;
 bool fCheckBlockIndex = false;
+BlockIndexVerifyMode g_verify_block_index = BlockIndexVerifyMode::NONE;
 bool fCheckpointsEnabled = DEFAULT_CHECKPOINTS_ENABLED;
 uint64_t nPruneTarget = 0;
 int64_t nMaxTipAge = DEFAULT_MAX_TIP_AGE;
@@ -1163,7 +1172,7 @@ bool CheckHeaderPoW(const CBlockHeader& block, const Consensus::Params& consensu
     return CheckProofOfWork(block.GetHash(), block.nBits, consensusParams);
 }
 
-bool CheckHeaderPoS(const CBlockHeader& block, const Consensus::Params& consensusParams)
+bool CheckHeaderPoS(const CBlockHeader& block, const Consensus::Params& consensusParams, const std::vector<CKeyID>* signers = nullptr, uint256* pHashProofOfStake = nullptr)
 {
     // Check for proof of stake block header
     // Get prev block index
@@ -1174,11 +1183,11 @@ bool CheckHeaderPoS(const CBlockHeader& block, const Consensus::Params& consensu
     // Check the kernel hash
     CBlockIndex* pindexPrev = (*mi).second;
 
-    if (pindexPrev->nHeight >= consensusParams.nEnableHeaderSignatureHeight && !CheckRecoveredPubKeyFromBlockSignature(pindexPrev, block, ::ChainstateActive().CoinsTip())) {
+    if (pindexPrev->nHeight >= consensusParams.nEnableHeaderSignatureHeight && !CheckRecoveredPubKeyFromBlockSignature(pindexPrev, block, ::ChainstateActive().CoinsTip(), signers)) {
         return error("Failed signature check");
     }
 
-    return CheckKernel(pindexPrev, block.nBits, block.StakeTime(), block.prevoutStake, ::ChainstateActive().CoinsTip());
+    return CheckKernel(pindexPrev, block.nBits, block.StakeTime(), block.prevoutStake, ::ChainstateActive().CoinsTip(), pHashProofOfStake);
 }
 
 bool CheckHeaderProof(const CBlockHeader& block, const Consensus::Params& consensusParams) 
@@ -1194,15 +1203,13 @@ bool CheckHeaderProof(const CBlockHeader& block, const Consensus::Params& consen
 
 bool CheckIndexProof(const CBlockIndex& block, const Consensus::Params& consensusParams)
 {
-    // Get the hash of the proof
-    // After validating the PoS block the computed hash proof is saved in the block index, which is used to check the index
-    uint256 hashProof = block.IsProofOfWork() ? block.GetBlockHash() : block.hashProof;
     // Check for proof after the hash proof is computed
     if (block.IsProofOfStake()) {
         //blocks are loaded out of order, so checking PoS kernels here is not practical
         return true; //CheckKernel(block.pprev, block.nBits, block.nTime, block.prevoutStake);
     } else {
-        return CheckProofOfWork(hashProof, block.nBits, consensusParams, false);
+        // The hash proof of a PoW block is its hash
+        return CheckProofOfWork(block.GetBlockHash(), block.nBits, consensusParams, false);
     }
 }
 
@@ -1212,6 +1219,9 @@ bool CheckIndexProof(const CBlockIndex& block, const Consensus::Params& consensu
 // CBlock and CBlockIndex
 //
 
+//! Size of the CRC32C frame checksum written after each block in blk?????.dat
+static constexpr unsigned int BLOCK_SERIALIZATION_FOOTER_SIZE = 4;
+
 static bool WriteBlockToDisk(const CBlock& block, FlatFilePos& pos, const CMessageHeader::MessageStartChars& messageStart)
 {
     // Open history file to append
@@ -1228,33 +1238,91 @@ static bool WriteBlockToDisk(const CBlock& block, FlatFilePos& pos, const CMessa
     if (fileOutPos < 0)
         return error("WriteBlockToDisk: ftell failed");
     pos.nPos = (unsigned int)fileOutPos;
-    fileout << block;
+    CDataStream raw(SER_DISK, CLIENT_VERSION);
+    raw << block;
+    fileout.write(raw.data(), raw.size());
+
+    // Write the frame checksum
+    unsigned char crc[BLOCK_SERIALIZATION_FOOTER_SIZE];
+    WriteLE32(crc, crc32c::Crc32c((const unsigned char*)raw.data(), raw.size()));
+    fileout.write((const char*)crc, sizeof(crc));
+
+    if (g_txhash_sidecar) {
+        g_txhash_sidecar->Add(pos, block, std::vector<uint8_t>(raw.begin(), raw.end()));
+    }
 
     return true;
 }
 
-bool ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos, const Consensus::Params& consensusParams)
+/**
+ * Read the block stored at pos. intact is set when the block is followed by a
+ * CRC32C frame matching its bytes, i.e. the data is exactly what WriteBlockToDisk
+ * wrote. Blocks written before the frame was introduced are never intact.
+ */
+static bool ReadBlockData(CBlock& block, const FlatFilePos& pos, bool& intact)
 {
     block.SetNull();
+    intact = false;
 
-    // Open history file to read
-    CAutoFile filein(OpenBlockFile(pos, true), SER_DISK, CLIENT_VERSION);
+    // Open history file at the size field of the index header
+    if (pos.nPos < 4)
+        return error("ReadBlockFromDisk: Invalid position %s", pos.ToString());
+    FlatFilePos hpos = pos;
+    hpos.nPos -= 4;
+    CAutoFile filein(OpenBlockFile(hpos, true), SER_DISK, CLIENT_VERSION);
     if (filein.IsNull())
         return error("ReadBlockFromDisk: OpenBlockFile failed for %s", pos.ToString());
 
-    // Read block
+    std::vector<uint8_t> raw;
+    try {
+        unsigned int nSize;
+        filein >> nSize;
+        if (nSize > MAX_SIZE)
+            return error("%s: Block data is larger than maximum deserialization size for %s: %s versus %s",
+                    __func__, pos.ToString(), nSize, MAX_SIZE);
+        raw.resize(nSize);
+        filein.read((char*)raw.data(), raw.size());
+    }
+    catch (const std::exception& e) {
+        return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), pos.ToString());
+    }
+    unsigned char crc[BLOCK_SERIALIZATION_FOOTER_SIZE];
+    intact = fread(crc, 1, sizeof(crc), filein.Get()) == sizeof(crc) &&
+             ReadLE32(crc) == crc32c::Crc32c(raw.data(), raw.size());
+
+    // Deserialize, taking the transaction hashes from the sidecar when it matches the block bytes
+    TxHashSidecar::Entry sidecar_entry;
+    if (g_txhash_sidecar && g_txhash_sidecar->Find(pos, sidecar_entry)) {
+        if (TxHashSidecar::Deserialize(raw, sidecar_entry, block)) return true;
+        LogPrint(BCLog::VALIDATION, "%s: stale txid sidecar record for %s\n", __func__, pos.ToString());
+        block.SetNull();
+    }
     try {
-        filein >> block;
+        VectorReader stream(SER_DISK, CLIENT_VERSION, raw, 0);
+        stream >> block;
     }
     catch (const std::exception& e) {
         return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), pos.ToString());
     }
 
+    if (g_txhash_sidecar) {
+        // Only reached without a usable record: backfill blocks written before
+        // the sidecar was enabled, or supersede a stale record
+        g_txhash_sidecar->Add(pos, block, raw);
+    }
+    return true;
+}
+
+std::atomic<uint64_t> g_read_block_proof_checks{0};
 
+/** Check the header and, on signet, the block solution of a block read from disk. */
+static bool CheckBlockFromDisk(const CBlock& block, const FlatFilePos& pos, const Consensus::Params& consensusParams, bool check_proof)
+{
     // Check the header
-    if(!block.IsProofOfStake()) {
+    if(check_proof && !block.IsProofOfStake()) {
         //PoS blocks can be loaded out of order from disk, which makes PoS impossible to validate. So, do not validate their headers
         //they will be validated later in CheckBlock and ConnectBlock anyway
+        ++g_read_block_proof_checks;
         if (!CheckHeaderProof(block, consensusParams))
         {
             return error("ReadBlockFromDisk: Errors in block header at %s", pos.ToString());
@@ -1269,22 +1337,68 @@ bool ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos, const Consensus::P
     return true;
 }
 
-bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus::Params& consensusParams)
+/**
+ * Whether header has the fields stored in the index entry, and so the hash of the entry.
+ * The block signature is only compared when it is in memory: this is called with cs_main
+ * held when serving blocks, and a block read back intact from its own position cannot have
+ * another header than the one that was validated.
+ */
+static bool MatchesIndexHeader(const CBlockHeader& header, const CBlockIndex& index)
 {
-    FlatFilePos blockPos;
-    {
-        LOCK(cs_main);
-        blockPos = pindex->GetBlockPos();
+    CBlockIndexCold cold;
+    return header.nVersion == index.nVersion &&
+           header.hashPrevBlock == (index.pprev ? index.pprev->GetBlockHash() : uint256()) &&
+           header.hashMerkleRoot == index.hashMerkleRoot &&
+           header.nTime == index.nTime &&
+           header.nBits == index.nBits &&
+           header.nNonce == index.nNonce &&
+           header.prevoutStake == index.prevoutStake &&
+           (!g_block_index_cold.GetInMemory(index.GetBlockHash(), cold) || header.vchBlockSig == cold.vchBlockSig);
+}
+
+bool ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos, const Consensus::Params& consensusParams)
+{
+    bool intact;
+    return ReadBlockData(block, pos, intact) && CheckBlockFromDisk(block, pos, consensusParams, true);
+}
+
+/** Read the block of pindex stored at blockPos, without taking cs_main. */
+static bool ReadIndexedBlock(CBlock& block, const CBlockIndex* pindex, const FlatFilePos& blockPos, bool validated, const Consensus::Params& consensusParams)
+{
+    bool intact;
+    if (!ReadBlockData(block, blockPos, intact))
+        return false;
+
+    // A block that passed CheckBlock when it was stored and whose frame checksum
+    // still matches is what was validated, so there is no need to hash its header
+    // again: comparing it with the index entry is enough.
+    if (validated && intact) {
+        if (!MatchesIndexHeader(block, *pindex))
+            return error("ReadBlockFromDisk(CBlock&, CBlockIndex*): header doesn't match index for %s at %s",
+                    pindex->ToString(), blockPos.ToString());
+        return CheckBlockFromDisk(block, blockPos, consensusParams, false);
     }
 
-    if (!ReadBlockFromDisk(block, blockPos, consensusParams))
+    if (!CheckBlockFromDisk(block, blockPos, consensusParams, true))
         return false;
     if (block.GetHash() != pindex->GetBlockHash())
         return error("ReadBlockFromDisk(CBlock&, CBlockIndex*): GetHash() doesn't match index for %s at %s",
-                pindex->ToString(), pindex->GetBlockPos().ToString());
+                pindex->ToString(), blockPos.ToString());
     return true;
 }
 
+bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus::Params& consensusParams)
+{
+    FlatFilePos blockPos;
+    bool validated;
+    {
+        LOCK(cs_main);
+        blockPos = pindex->GetBlockPos();
+        validated = pindex->IsValid(BLOCK_VALID_TRANSACTIONS);
+    }
+    return ReadIndexedBlock(block, pindex, blockPos, validated, consensusParams);
+}
+
 bool ReadRawBlockFromDisk(std::vector<uint8_t>& block, const FlatFilePos& pos, const CMessageHeader::MessageStartChars& message_start)
 {
     FlatFilePos hpos = pos;
@@ -1448,7 +1562,7 @@ BlockMap& BlockIndex()
     return g_chainman.m_blockman.m_block_index;
 }
 
-StakeSeenSet& StakeSeen()
+CStakeSeen& StakeSeen()
 {
      LOCK(::cs_main);
     return g_chainman.m_blockman.m_stake_seen;
@@ -1616,7 +1730,7 @@ int GetSpendHeight(const CCoinsViewCache& inputs)
 
 
 static CuckooCache::cache<uint256, SignatureCacheHasher> g_scriptExecutionCache;
-static NeuralLeadQHash_iface g_scriptExecutionCacheHasher;
+static CSHA256 g_scriptExecutionCacheHasher;
 
 void InitScriptExecutionCache() {
     // Setup the salted hasher
@@ -1667,7 +1781,7 @@ bool CheckInputScripts(const CTransaction& tx, TxValidationState &state, const C
     // properly commits to the scriptPubKey in the inputs view of that
     // transaction).
     uint256 hashCacheEntry;
-    NeuralLeadQHash_iface hasher = g_scriptExecutionCacheHasher;
+    CSHA256 hasher = g_scriptExecutionCacheHasher;
     hasher.Write(tx.GetWitnessHash().begin(), 32).Write((unsigned char*)&flags, sizeof(flags)).Finalize(hashCacheEntry.begin());
     AssertLockHeld(cs_main); //TODO: Remove this requirement by making CuckooCache not require external locks
     if (g_scriptExecutionCache.contains(hashCacheEntry, !cacheFullScriptStore)) {
@@ -1967,6 +2081,40 @@ void ThreadScriptCheck(int worker_num) {
     scriptcheckqueue.Thread();
 }
 
+/**
+ * Recovers the signers of a proof-of-stake header, so that the coin check
+ * under cs_main is only a lookup. See ProcessNewBlockHeaders().
+ */
+class CHeaderSigCheck
+{
+private:
+    const CBlockHeader* m_header{nullptr};
+    std::vector<CKeyID>* m_signers{nullptr};
+
+public:
+    CHeaderSigCheck() {}
+    CHeaderSigCheck(const CBlockHeader& header, std::vector<CKeyID>& signers) : m_header(&header), m_signers(&signers) {}
+
+    bool operator()()
+    {
+        RecoverBlockSigners(*m_header, *m_signers);
+        return true;
+    }
+
+    void swap(CHeaderSigCheck& check)
+    {
+        std::swap(m_header, check.m_header);
+        std::swap(m_signers, check.m_signers);
+    }
+};
+
+static CCheckQueue<CHeaderSigCheck> headersigcheckqueue(128);
+
+void ThreadHeaderSigCheck(int worker_num) {
+    util::ThreadRename(strprintf("headersig.%i", worker_num));
+    headersigcheckqueue.Thread();
+}
+
 VersionBitsCache versionbitscache GUARDED_BY(cs_main);
 
 int32_t ComputeBlockVersion(const CBlockIndex* pindexPrev, const Consensus::Params& params)
@@ -2981,6 +3129,8 @@ bool CChainState::FlushStateToDisk(
                 if (!pblocktree->WriteBatchSync(vFiles, nLastBlockFile, vBlocks)) {
                     return AbortNode(state, "Failed to write to block index database");
                 }
+                g_block_index_cold.SetRecentHeight(m_chain.Height() - BLOCK_INDEX_COLD_RECENT_DEPTH);
+                g_block_index_cold.Written(vBlocks);
             }
             // Finally remove any pruned files
             if (fFlushForPrune) {
@@ -3169,6 +3319,7 @@ bool CChainState::DisconnectTip(BlockValidationState& state, const CChainParams&
 }
 
 static int64_t nTimeReadFromDisk = 0;
+static int64_t nTimePrefetchCoins = 0;
 static int64_t nTimeConnectTotal = 0;
 static int64_t nTimeFlush = 0;
 static int64_t nTimeChainState = 0;
@@ -3220,7 +3371,50 @@ public:
  *
  * The block is added to connectTrace if connection succeeds.
  */
-bool CChainState::ConnectTip(BlockValidationState& state, const CChainParams& chainparams, CBlockIndex* pindexNew, const std::shared_ptr<const CBlock>& pblock, ConnectTrace& connectTrace, DisconnectedBlockTransactions &disconnectpool)
+/**
+ * Reads a block from disk and the coins it spends from the coins DB on a
+ * background thread, which takes no lock and only reads the block files and
+ * the coins DB. The result is stored in slot when the thread is joined, at the
+ * latest on destruction, so that no read outlives the hold on cs_main of the
+ * caller.
+ */
+class BlockReadAhead
+{
+public:
+    explicit BlockReadAhead(CPrefetchedBlock& slot) : m_slot(slot) {}
+    ~BlockReadAhead() { Join(); }
+
+    void Start(const CBlockIndex* pindex, const CCoinsViewDB& db, const Consensus::Params& params) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+    {
+        Join();
+        if (!(pindex->nStatus & BLOCK_HAVE_DATA)) return;
+        const FlatFilePos pos = pindex->GetBlockPos();
+        const bool validated = pindex->IsValid(BLOCK_VALID_TRANSACTIONS);
+        m_thread = std::thread([this, pindex, pos, validated, &db, &params] {
+            std::shared_ptr<CBlock> block = std::make_shared<CBlock>();
+            if (!ReadIndexedBlock(*block, pindex, pos, validated, params)) return;
+            m_result.hash = pindex->GetBlockHash();
+            m_result.coins.outpoints = GetBlockPrevouts(*block);
+            PrefetchCoins(db, m_result.coins);
+            m_result.block = std::move(block);
+        });
+    }
+
+    void Join()
+    {
+        if (!m_thread.joinable()) return;
+        m_thread.join();
+        if (m_result.block) m_slot = std::move(m_result);
+        m_result = CPrefetchedBlock();
+    }
+
+private:
+    CPrefetchedBlock& m_slot;
+    CPrefetchedBlock m_result;
+    std::thread m_thread;
+};
+
+bool CChainState::ConnectTip(BlockValidationState& state, const CChainParams& chainparams, CBlockIndex* pindexNew, const std::shared_ptr<const CBlock>& pblock, ConnectTrace& connectTrace, DisconnectedBlockTransactions &disconnectpool, CCoinsPrefetch* prefetch)
 {
     AssertLockHeld(cs_main);
     AssertLockHeld(m_mempool.cs);
@@ -3242,6 +3436,19 @@ bool CChainState::ConnectTip(BlockValidationState& state, const CChainParams& ch
     int64_t nTime2 = GetTimeMicros(); nTimeReadFromDisk += nTime2 - nTime1;
     int64_t nTime3;
     LogPrint(BCLog::BENCH, "  - Load block from disk: %.2fms [%.2fs]\n", (nTime2 - nTime1) * MILLI, nTimeReadFromDisk * MICRO);
+    // Warm the coins cache with the coins the block spends, so that ConnectBlock does not read them one by one
+    CCoinsPrefetch own_prefetch;
+    if (!prefetch || !prefetch->IsCurrent(CoinsDB())) {
+        for (const COutPoint& prevout : GetBlockPrevouts(blockConnecting)) {
+            if (!CoinsTip().HaveCoinInCache(prevout)) own_prefetch.outpoints.push_back(prevout);
+        }
+        PrefetchCoins(CoinsDB(), own_prefetch);
+        prefetch = &own_prefetch;
+    }
+    const size_t nPrefetched = WarmCoinsCache(CoinsTip(), CoinsDB(), *prefetch);
+    int64_t nTime2a = GetTimeMicros(); nTimePrefetchCoins += nTime2a - nTime2;
+    LogPrint(BCLog::BENCH, "  - Prefetch coins: %.2fms (%u coins) [%.2fs]\n", (nTime2a - nTime2) * MILLI, nPrefetched, nTimePrefetchCoins * MICRO);
+    nTime2 = nTime2a;
     {
         CCoinsViewCache view(&CoinsTip());
         bool rv = ConnectBlock(blockConnecting, state, pindexNew, view, chainparams);
@@ -3384,6 +3591,7 @@ bool CChainState::ActivateBestChainStep(BlockValidationState& state, const CChai
 
     // Build list of new blocks to connect.
     std::vector<CBlockIndex*> vpindexToConnect;
+    BlockReadAhead read_ahead(m_next_block);
     bool fContinue = true;
     int nHeight = pindexFork ? pindexFork->nHeight : -1;
     while (fContinue && nHeight != pindexMostWork->nHeight) {
@@ -3399,9 +3607,25 @@ bool CChainState::ActivateBestChainStep(BlockValidationState& state, const CChai
         }
         nHeight = nTargetHeight;
 
-        // Connect new blocks.
-        for (CBlockIndex *pindexConnect : reverse_iterate(vpindexToConnect)) {
-            if (!ConnectTip(state, chainparams, pindexConnect, pindexConnect == pindexMostWork ? pblock : std::shared_ptr<const CBlock>(), connectTrace, disconnectpool)) {
+        // Connect new blocks, reading the next one and its coins meanwhile.
+        for (auto it = vpindexToConnect.rbegin(); it != vpindexToConnect.rend(); ++it) {
+            CBlockIndex* pindexConnect = *it;
+            std::shared_ptr<const CBlock> pblockConnect = pindexConnect == pindexMostWork ? pblock : nullptr;
+            CCoinsPrefetch prefetch;
+            bool fPrefetched = false;
+            read_ahead.Join();
+            if (!pblockConnect && m_next_block.block && m_next_block.hash == pindexConnect->GetBlockHash()) {
+                pblockConnect = std::move(m_next_block.block);
+                prefetch = std::move(m_next_block.coins);
+                fPrefetched = true;
+            }
+            m_next_block = CPrefetchedBlock();
+            const auto next = std::next(it);
+            if (next != vpindexToConnect.rend() && !(*next == pindexMostWork && pblock)) {
+                read_ahead.Start(*next, CoinsDB(), chainparams.GetConsensus());
+            }
+
+            if (!ConnectTip(state, chainparams, pindexConnect, pblockConnect, connectTrace, disconnectpool, fPrefetched ? &prefetch : nullptr)) {
                 if (state.IsInvalid()) {
                     // The block violates a consensus rule.
                     if (state.GetResult() != BlockValidationResult::BLOCK_MUTATED) {
@@ -3543,6 +3767,7 @@ bool CChainState::ActivateBestChain(BlockValidationState &state, const CChainPar
                 for (const PerBlockConnectTrace& trace : connectTrace.GetBlocksConnected()) {
                     assert(trace.pblock && trace.pindex);
                     GetMainSignals().BlockConnected(trace.pblock, trace.pindex);
+                    UpdateMPoSScriptCache(trace.pindex, chainparams.GetConsensus());
                 }
             } while (!m_chain.Tip() || (starting_tip && CBlockIndexWorkComparator()(m_chain.Tip(), starting_tip)));
             if (!blocks_connected) return true;
@@ -3797,26 +4022,25 @@ void ResetBlockFailureFlags(CBlockIndex *pindex) {
     return ::ChainstateActive().ResetBlockFailureFlags(pindex);
 }
 
-CBlockIndex* BlockManager::AddToBlockIndex(const CBlockHeader& block)
+CBlockIndex* BlockManager::AddToBlockIndex(const CBlockHeader& block, const uint256* phash)
 {
     AssertLockHeld(cs_main);
 
     // Check for duplicate
-    uint256 hash = block.GetHash();
+    const uint256 hash = phash ? *phash : block.GetHash();
     BlockMap::iterator it = m_block_index.find(hash);
     if (it != m_block_index.end())
         return it->second;
 
     // Construct new block index object
-    CBlockIndex* pindexNew = new CBlockIndex(block);
+    CBlockIndex* pindexNew = m_block_index.emplace(hash, block).first->second;
     // We assign the sequence id to blocks only when the full data is available,
     // to avoid miners withholding blocks but broadcasting headers, to get a
     // competitive advantage.
     pindexNew->nSequenceId = 0;
-    BlockMap::iterator mi = m_block_index.insert(std::make_pair(hash, pindexNew)).first;
     if (pindexNew->IsProofOfStake())
         ::StakeSeen().insert(std::make_pair(pindexNew->prevoutStake, pindexNew->nTime));
-    pindexNew->phashBlock = &((*mi).first);
+    g_block_index_cold.Set(hash, {block.vchBlockSig, uint256()});
     BlockMap::iterator miPrev = m_block_index.find(block.hashPrevBlock);
     if (miPrev != m_block_index.end())
     {
@@ -3981,7 +4205,7 @@ bool CheckFirstCoinstakeOutput(const CBlock& block)
 
 #ifdef ENABLE_WALLET
 // novacoin: attempt to generate suitable proof-of-stake
-bool SignBlock(std::shared_ptr<CBlock> pblock, CWallet& wallet, const CAmount& nTotalFees, uint32_t nTime, std::set<std::pair<const CWalletTx*,unsigned int> >& setCoins)
+bool SignBlock(std::shared_ptr<CBlock> pblock, CWallet& wallet, const CAmount& nTotalFees, uint32_t nTime, std::set<std::pair<const CWalletTx*,unsigned int> >& setCoins, const COutPoint* pkernel, uint256* pHashProofOfStake)
 {
     // if we are trying to sign
     //    something except proof-of-stake block template
@@ -4005,7 +4229,7 @@ bool SignBlock(std::shared_ptr<CBlock> pblock, CWallet& wallet, const CAmount& n
     //int64_t nSearchInterval = IsProtocolV2(nBestHeight+1) ? 1 : nSearchTime - nLastCoinStakeSearchTime;
     //IsProtocolV2 mean POS 2 or higher, so the modified line is:
     LOCK(wallet.cs_wallet);
-    if (wallet.CreateCoinStake(wallet, pblock->nBits, nTotalFees, nTimeBlock, txCoinStake, key, setCoins))
+    if (wallet.CreateCoinStake(wallet, pblock->nBits, nTotalFees, nTimeBlock, txCoinStake, key, setCoins, pkernel))
     {
         if (nTimeBlock >= ::ChainActive().Tip()->GetMedianTimePast()+1)
         {
@@ -4025,7 +4249,7 @@ bool SignBlock(std::shared_ptr<CBlock> pblock, CWallet& wallet, const CAmount& n
             // append a signature to our block and ensure that is LowS
             return key.Sign(pblock->GetHashWithoutSign(), pblock->vchBlockSig) &&
                        EnsureLowS(pblock->vchBlockSig) &&
-                       CheckHeaderPoS(*pblock, Params().GetConsensus());
+                       CheckHeaderPoS(*pblock, Params().GetConsensus(), nullptr, pHashProofOfStake);
         }
     }
 
@@ -4100,7 +4324,7 @@ bool CheckBlockSignature(const CBlock& block)
     return CPubKey(vchPubKey).Verify(block.GetHashWithoutSign(), block.vchBlockSig);
 }
 
-static bool CheckBlockHeader(const CBlockHeader& block, BlockValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW = true, bool fCheckPOS = true)
+static bool CheckBlockHeader(const CBlockHeader& block, BlockValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW = true, bool fCheckPOS = true, const std::vector<CKeyID>* signers = nullptr)
 {
     // Check proof of work matches claimed amount
     if (fCheckPOW && block.IsProofOfWork() && !CheckHeaderPoW(block, consensusParams))
@@ -4109,7 +4333,7 @@ static bool CheckBlockHeader(const CBlockHeader& block, BlockValidationState& st
     }
 
     // Check proof of stake matches claimed amount
-    if (fCheckPOS && !::ChainstateActive().IsInitialBlockDownload() && block.IsProofOfStake() && !CheckHeaderPoS(block, consensusParams))
+    if (fCheckPOS && !::ChainstateActive().IsInitialBlockDownload() && block.IsProofOfStake() && !CheckHeaderPoS(block, consensusParams, signers))
     {
         // May occur if behind on block chain sync
         return state.Invalid(BlockValidationResult::BLOCK_INVALID_HEADER, "bad-cb-header", "proof of stake failed");
@@ -4427,6 +4651,7 @@ static bool ContextualCheckBlock(const CBlock& block, BlockValidationState& stat
 
 bool CChainState::UpdateHashProof(const CBlock& block, BlockValidationState& state, const Consensus::Params& consensusParams, CBlockIndex* pindex, CCoinsViewCache& view)
 {
+    AssertLockHeld(cs_main);
     uint256 hash = block.GetHash();
 
     int nHeight = pindex->nHeight;
@@ -4447,7 +4672,8 @@ bool CChainState::UpdateHashProof(const CBlock& block, BlockValidationState& sta
     if (block.IsProofOfStake())
     {
         uint256 targetProofOfStake;
-        if (!CheckProofOfStake(pindex->pprev, state, *block.vtx[1], block.nBits, block.nTime, hashProof, targetProofOfStake, view))
+        const uint256* pHashProofOfStake = m_blockman.m_local_stake.first == hash ? &m_blockman.m_local_stake.second : nullptr;
+        if (!CheckProofOfStake(pindex->pprev, state, *block.vtx[1], block.nBits, block.nTime, hashProof, targetProofOfStake, view, pHashProofOfStake))
         {
             return error("UpdateHashProof() : check proof-of-stake failed for block %s", hash.ToString());
         }
@@ -4459,8 +4685,9 @@ bool CChainState::UpdateHashProof(const CBlock& block, BlockValidationState& sta
         hashProof = block.GetHash();
     }
     
-    // Record proof hash value
-    pindex->hashProof = hashProof;
+    // Record proof hash value, but not for the dummy index of TestBlockValidity()
+    if (LookupBlockIndex(hash) == pindex && g_block_index_cold.SetHashProof(hash, hashProof))
+        setDirtyBlockIndex.insert(pindex);
     return true;
 }
 
@@ -4492,11 +4719,11 @@ bool CheckPOS(const CBlockHeader& block, CBlockIndex* pindexPrev)
     return false;
 }
 
-bool BlockManager::AcceptBlockHeader(const CBlockHeader& block, BlockValidationState& state, const CChainParams& chainparams, CBlockIndex** ppindex)
+bool BlockManager::AcceptBlockHeader(const CBlockHeader& block, BlockValidationState& state, const CChainParams& chainparams, CBlockIndex** ppindex, const std::vector<CKeyID>* signers, const uint256* phash)
 {
     AssertLockHeld(cs_main);
     // Check for duplicate
-    uint256 hash = block.GetHash();
+    const uint256 hash = phash ? *phash : block.GetHash();
     BlockMap::iterator miSelf = m_block_index.find(hash);
     CBlockIndex *pindex = nullptr;
     if (hash != chainparams.GetConsensus().hashGenesisBlock) {
@@ -4600,11 +4827,13 @@ bool BlockManager::AcceptBlockHeader(const CBlockHeader& block, BlockValidationS
 
         // Check block header
         // if (!CheckBlockHeader(block, state, chainparams.GetConsensus(), true, CheckPOS(block, pindexPrev)))
-        if (!CheckBlockHeader(block, state, chainparams.GetConsensus()))
+        // The stake of a block staked by this node was checked when it was signed
+        const bool fCheckPOS = m_local_stake.first != hash;
+        if (!CheckBlockHeader(block, state, chainparams.GetConsensus(), true, fCheckPOS, signers))
             return error("%s: Consensus::CheckBlockHeader: %s, %s", __func__, hash.ToString(), state.ToString());
     }
     if (pindex == nullptr)
-        pindex = AddToBlockIndex(block);
+        pindex = AddToBlockIndex(block, &hash);
 
     if (ppindex)
         *ppindex = pindex;
@@ -4626,15 +4855,75 @@ bool ChainstateManager::ProcessNewBlockHeaders(const std::vector<CBlockHeader>&
         }
     }
 
+    // The PoS header proofs are only checked after the initial block download.
+    // Recover the block signers of the message in parallel before taking
+    // cs_main for good, which leaves a coin lookup per header for
+    // AcceptBlockHeader(). Only the headers whose signature it will check are
+    // recovered: PoS headers not in the block index yet, whose parent is at or
+    // above nEnableHeaderSignatureHeight. The others get no signers and are
+    // handled by AcceptBlockHeader() alone. The header hashes computed here are
+    // passed on to AcceptBlockHeader() rather than computed again.
+    const bool fRecoverSigners = !::ChainstateActive().IsInitialBlockDownload();
+    std::vector<std::vector<CKeyID>> signers(headers.size());
+    std::vector<bool> recover(headers.size(), false);
+    std::vector<uint256> hashes;
+    if (fRecoverSigners) {
+        hashes.reserve(headers.size());
+        for (const CBlockHeader& header : headers) hashes.push_back(header.GetHash());
+        {
+            LOCK(cs_main);
+            const int nSignatureHeight = chainparams.GetConsensus().nEnableHeaderSignatureHeight;
+            int nHeight = -1; // of the previous header, -1 if unknown
+            for (size_t i = 0; i < headers.size(); ++i) {
+                const CBlockHeader& header = headers[i];
+                int nPrevHeight = -1;
+                if (i > 0 && header.hashPrevBlock == hashes[i - 1]) {
+                    nPrevHeight = nHeight;
+                } else if (const CBlockIndex* pindexPrev = LookupBlockIndex(header.hashPrevBlock)) {
+                    nPrevHeight = pindexPrev->nHeight;
+                }
+                nHeight = nPrevHeight < 0 ? -1 : nPrevHeight + 1;
+                recover[i] = header.IsProofOfStake() && nPrevHeight >= 0 && nPrevHeight >= nSignatureHeight &&
+                             !LookupBlockIndex(hashes[i]);
+            }
+        }
+
+        std::vector<CHeaderSigCheck> vChecks;
+        for (size_t i = 0; i < headers.size(); ++i) {
+            if (recover[i]) vChecks.emplace_back(headers[i], signers[i]);
+        }
+        if (g_parallel_script_checks && vChecks.size() > 1) {
+            CCheckQueueControl<CHeaderSigCheck> control(&headersigcheckqueue);
+            control.Add(vChecks);
+            control.Wait();
+        } else {
+            for (CHeaderSigCheck& check : vChecks) check();
+        }
+    }
+
     {
         LOCK(cs_main);
+
+        if (fRecoverSigners) {
+            // Fetch the staked coins of the same headers into the coins cache in one pass, in key order
+            std::vector<COutPoint> stakes;
+            for (size_t i = 0; i < headers.size(); ++i) {
+                if (recover[i]) stakes.push_back(headers[i].prevoutStake);
+            }
+            std::sort(stakes.begin(), stakes.end());
+            CCoinsViewCache& view = ::ChainstateActive().CoinsTip();
+            for (const COutPoint& prevout : stakes) {
+                view.HaveCoin(prevout);
+            }
+        }
+
         bool bFirst = true;
         bool fInstantBan = false;
         for (size_t i = 0; i < headers.size(); ++i) {
             const CBlockHeader& header = headers[i];
 
             // If the stake has been seen and the header has not yet been seen
-            if (!fReindex && !fImporting && !::ChainstateActive().IsInitialBlockDownload() && header.IsProofOfStake() && ::StakeSeen().count(std::make_pair(header.prevoutStake, header.nTime)) && !::BlockIndex().count(header.GetHash())) {
+            if (!fReindex && !fImporting && !::ChainstateActive().IsInitialBlockDownload() && header.IsProofOfStake() && ::StakeSeen().count(std::make_pair(header.prevoutStake, header.nTime)) && !::BlockIndex().count(fRecoverSigners ? hashes[i] : header.GetHash())) {
                 // if it is the last header of the list
                 if(i+1 == headers.size()) {
                     if (first_invalid) *first_invalid = header;
@@ -4653,7 +4942,7 @@ bool ChainstateManager::ProcessNewBlockHeaders(const std::vector<CBlockHeader>&
 
             CBlockIndex *pindex = nullptr; // Use a temp pindex instead of ppindex to avoid a const_cast
             bool accepted = m_blockman.AcceptBlockHeader(
-                header, state, chainparams, &pindex);
+                header, state, chainparams, &pindex, recover[i] ? &signers[i] : nullptr, fRecoverSigners ? &hashes[i] : nullptr);
             ::ChainstateActive().CheckBlockIndex(chainparams.GetConsensus());
 
             if (!accepted) {
@@ -4688,7 +4977,7 @@ static FlatFilePos SaveBlockToDisk(const CBlock& block, int nHeight, const CChai
     FlatFilePos blockPos;
     if (dbp != nullptr)
         blockPos = *dbp;
-    if (!FindBlockPos(blockPos, nBlockSize+8, nHeight, block.GetBlockTime(), dbp != nullptr)) {
+    if (!FindBlockPos(blockPos, nBlockSize+8+BLOCK_SERIALIZATION_FOOTER_SIZE, nHeight, block.GetBlockTime(), dbp != nullptr)) {
         error("%s: FindBlockPos failed", __func__);
         return FlatFilePos();
     }
@@ -4852,7 +5141,7 @@ bool CheckCanonicalBlockSignature(const CBlockHeader* pblock)
     return ret;
 }
 
-bool ChainstateManager::ProcessNewBlock(const CChainParams& chainparams, const std::shared_ptr<const CBlock> pblock, bool fForceProcessing, bool *fNewBlock)
+bool ChainstateManager::ProcessNewBlock(const CChainParams& chainparams, const std::shared_ptr<const CBlock> pblock, bool fForceProcessing, bool *fNewBlock, const uint256* pHashProofOfStake)
 {
     AssertLockNotHeld(cs_main);
 
@@ -4865,6 +5154,10 @@ bool ChainstateManager::ProcessNewBlock(const CChainParams& chainparams, const s
         // Therefore, the following critical section must include the CheckBlock() call as well.
         LOCK(cs_main);
 
+        if (pHashProofOfStake) {
+            m_blockman.m_local_stake = std::make_pair(pblock->GetHash(), *pHashProofOfStake);
+        }
+
         // Ensure that CheckBlock() passes before calling AcceptBlock, as
         // belt-and-suspenders.
         bool ret = CheckBlock(*pblock, state, chainparams.GetConsensus());
@@ -4969,6 +5262,7 @@ void UnlinkPrunedFiles(const std::set<int>& setFilesToPrune)
         FlatFilePos pos(*it, 0);
         fs::remove(BlockFileSeq().FileName(pos));
         fs::remove(UndoFileSeq().FileName(pos));
+        if (g_txhash_sidecar) g_txhash_sidecar->Remove(*it);
         LogPrintf("Prune: %s deleted blk/rev (%05u)\n", __func__, *it);
     }
 }
@@ -5097,17 +5391,8 @@ CBlockIndex * BlockManager::InsertBlockIndex(const uint256& hash)
     if (hash.IsNull())
         return nullptr;
 
-    // Return existing
-    BlockMap::iterator mi = m_block_index.find(hash);
-    if (mi != m_block_index.end())
-        return (*mi).second;
-
-    // Create new
-    CBlockIndex* pindexNew = new CBlockIndex();
-    mi = m_block_index.insert(std::make_pair(hash, pindexNew)).first;
-    pindexNew->phashBlock = &((*mi).first);
-
-    return pindexNew;
+    // Return existing or create new
+    return m_block_index.emplace(hash).first->second;
 }
 
 bool BlockManager::LoadBlockIndex(
@@ -5115,22 +5400,100 @@ bool BlockManager::LoadBlockIndex(
     CBlockTreeDB& blocktree,
     std::set<CBlockIndex*, CBlockIndexWorkComparator>& block_index_candidates)
 {
-    if (!blocktree.LoadBlockIndexGuts(consensus_params, [this](const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main) { return this->InsertBlockIndex(hash); }))
+    const bool rehash_headers = g_verify_block_index == BlockIndexVerifyMode::STARTUP;
+    const int threads = std::max(GetNumCores(), 1);
+    const int64_t time_start = GetTimeMillis();
+
+    // Each range is inserted as soon as it has been read and is freed right
+    // away, so that only one range is held twice. Within a range the nodes are
+    // allocated in height order, so that parents and children tend to share
+    // the same arena chunk.
+    std::vector<std::pair<CBlockIndex*, uint256>> parents; // entry and hash of its parent
+    auto insert_entries = [&](std::vector<CBlockIndexEntry>& range) {
+        std::vector<const CBlockIndexEntry*> sorted_entries;
+        sorted_entries.reserve(range.size());
+        for (const CBlockIndexEntry& entry : range) {
+            sorted_entries.push_back(&entry);
+        }
+        std::sort(sorted_entries.begin(), sorted_entries.end(), [](const CBlockIndexEntry* a, const CBlockIndexEntry* b) {
+            return a->index.nHeight < b->index.nHeight;
+        });
+        m_block_index.reserve(m_block_index.size() + range.size());
+        for (const CBlockIndexEntry* entry : sorted_entries) {
+            auto inserted = m_block_index.emplace(entry->hash, entry->index);
+            CBlockIndex* pindex = inserted.first->second;
+            if (!inserted.second) {
+                // Keep the address of an entry that is already in memory
+                *pindex = entry->index;
+                pindex->phashBlock = &inserted.first->first;
+            }
+            if (pindex->IsProofOfStake())
+                ::StakeSeen().insert(std::make_pair(pindex->prevoutStake, pindex->nTime));
+            parents.emplace_back(pindex, entry->hashPrev);
+        }
+        std::vector<CBlockIndexEntry>().swap(range);
+    };
+    if (!blocktree.LoadBlockIndexGuts(consensus_params, insert_entries, rehash_headers, threads))
         return false;
-
-    // Calculate nChainWork
-    std::vector<std::pair<int, CBlockIndex*> > vSortedByHeight;
-    vSortedByHeight.reserve(m_block_index.size());
-    for (const std::pair<const uint256, CBlockIndex*>& item : m_block_index)
-    {
-        CBlockIndex* pindex = item.second;
-        vSortedByHeight.push_back(std::make_pair(pindex->nHeight, pindex));
+    const size_t count = parents.size();
+    const int64_t time_insert = GetTimeMillis();
+
+    // Link the entries to their parents in parallel, the block map is only read meanwhile
+    const BlockMap& block_index = m_block_index;
+    std::atomic<size_t> next{0};
+    std::atomic<bool> missing_parent{false};
+    auto link = [&] {
+        static constexpr size_t BATCH = 1024;
+        while (true) {
+            const size_t begin = next.fetch_add(BATCH);
+            if (begin >= parents.size()) break;
+            for (size_t i = begin; i < std::min(begin + BATCH, parents.size()); ++i) {
+                if (parents[i].second.IsNull()) continue;
+                auto it = block_index.find(parents[i].second);
+                if (it != block_index.end()) {
+                    parents[i].first->pprev = it->second;
+                } else {
+                    missing_parent = true;
+                }
+            }
+        }
+    };
+    std::vector<std::thread> linkers;
+    for (int i = 1; i < threads; ++i) {
+        linkers.emplace_back(link);
+    }
+    link();
+    for (std::thread& t : linkers) {
+        t.join();
+    }
+    if (missing_parent) {
+        for (const auto& parent : parents) {
+            if (!parent.second.IsNull() && !parent.first->pprev) parent.first->pprev = InsertBlockIndex(parent.second);
+        }
     }
-    sort(vSortedByHeight.begin(), vSortedByHeight.end());
-    for (const std::pair<int, CBlockIndex*>& item : vSortedByHeight)
+    std::vector<CBlockIndex*> vSortedByHeight;
+    if (m_block_index.size() != parents.size()) {
+        // Entries of unknown blocks, or that were already in memory, have to be ordered too
+        for (const auto& item : m_block_index) {
+            vSortedByHeight.push_back(item.second);
+        }
+    } else {
+        vSortedByHeight.reserve(parents.size());
+        for (const auto& parent : parents) {
+            vSortedByHeight.push_back(parent.first);
+        }
+    }
+    parents.clear();
+    parents.shrink_to_fit();
+    std::stable_sort(vSortedByHeight.begin(), vSortedByHeight.end(), [](const CBlockIndex* a, const CBlockIndex* b) {
+        return a->nHeight < b->nHeight;
+    });
+    const int64_t time_link = GetTimeMillis();
+
+    // Calculate nChainWork, and build the skip list which walks the skip pointers of the ancestors
+    for (CBlockIndex* pindex : vSortedByHeight)
     {
         if (ShutdownRequested()) return false;
-        CBlockIndex* pindex = item.second;
         pindex->nChainWork = (pindex->pprev ? pindex->pprev->nChainWork : 0) + GetBlockProof(*pindex);
         pindex->nTimeMax = (pindex->pprev ? std::max(pindex->pprev->nTimeMax, pindex->nTime) : pindex->nTime);
         // We can link the chain of blocks for which we've received transactions at some point.
@@ -5162,6 +5525,8 @@ bool BlockManager::LoadBlockIndex(
             pindexBestHeader = pindex;
     }
 
+    LogPrintf("Loaded %u block index entries on %d threads: read and insert %dms, link %dms, chain work %dms\n",
+              count, threads, time_insert - time_start, time_link - time_insert, GetTimeMillis() - time_link);
     return true;
 }
 
@@ -5169,11 +5534,10 @@ void BlockManager::Unload() {
     m_failed_blocks.clear();
     m_blocks_unlinked.clear();
 
-    for (const BlockMap::value_type& entry : m_block_index) {
-        delete entry.second;
-    }
-
     m_block_index.clear();
+    g_block_index_cold.Clear();
+    m_stake_seen.clear();
+    m_local_stake = {};
 }
 
 bool static LoadBlockIndexDB(ChainstateManager& chainman, const CChainParams& chainparams) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
@@ -5257,6 +5621,7 @@ bool CChainState::LoadChainTip(const CChainParams& chainparams)
     }
     m_chain.SetTip(pindex);
     PruneBlockIndexCandidates();
+    g_block_index_cold.SetRecentHeight(m_chain.Height() - BLOCK_INDEX_COLD_RECENT_DEPTH);
 
     tip = m_chain.Tip();
     LogPrintf("Loaded best chain: hashBestChain=%s height=%d date=%s progress=%f\n",
@@ -5267,6 +5632,76 @@ bool CChainState::LoadChainTip(const CChainParams& chainparams)
     return true;
 }
 
+void VerifyBlockIndexHashes(int threads)
+{
+    const int64_t start_time = GetTimeMillis();
+    std::vector<uint256> hashes;
+    {
+        LOCK(cs_main);
+        hashes.reserve(::BlockIndex().size());
+        for (const auto& entry : ::BlockIndex()) {
+            hashes.push_back(entry.first);
+        }
+    }
+
+    // Entries may be removed from the block index meanwhile and their nodes reused, so the workers
+    // copy the in-memory header fields of a batch under cs_main. The block signatures are read from
+    // the cold store and the copies rehashed without it. Every entry is read once, so the ones read
+    // from the block tree DB are not cached.
+    struct HotHeader {
+        uint256 hash;
+        int height;
+        CBlockHeader header;
+    };
+    std::atomic<size_t> next{0};
+    std::atomic<bool> mismatch{false};
+    uint256 mismatch_hash;
+    auto worker = [&] {
+        static constexpr size_t BATCH = 256;
+        std::vector<HotHeader> headers;
+        headers.reserve(BATCH);
+        while (!mismatch && !ShutdownRequested()) {
+            const size_t begin = next.fetch_add(BATCH);
+            if (begin >= hashes.size()) break;
+            headers.clear();
+            {
+                LOCK(cs_main);
+                for (size_t i = begin; i < std::min(begin + BATCH, hashes.size()); ++i) {
+                    if (const CBlockIndex* pindex = LookupBlockIndex(hashes[i])) {
+                        headers.push_back({hashes[i], pindex->nHeight, pindex->GetHotBlockHeader()});
+                    }
+                }
+            }
+            for (HotHeader& entry : headers) {
+                entry.header.vchBlockSig = g_block_index_cold.Get(entry.hash, entry.height, false).vchBlockSig;
+                if (entry.header.GetHash() != entry.hash) {
+                    bool expected = false;
+                    if (mismatch.compare_exchange_strong(expected, true)) mismatch_hash = entry.hash;
+                    break;
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int i = 1; i < threads; ++i) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& t : workers) {
+        t.join();
+    }
+
+    if (mismatch) {
+        AbortNode(strprintf("Block index entry %s does not match its header", mismatch_hash.ToString()),
+                  _("Corrupted block database detected. Please restart with -reindex."));
+        return;
+    }
+    if (!ShutdownRequested()) {
+        LogPrintf("Verified the headers of %u block index entries in %dms\n", hashes.size(), GetTimeMillis() - start_time);
+    }
+}
+
 CVerifyDB::CVerifyDB()
 {
     uiInterface.ShowProgress(_("Verifying blocks...").translated, 0, false);
@@ -5417,13 +5852,13 @@ bool CChainState::ReplayBlocks(const CChainParams& params)
     if (m_blockman.m_block_index.count(hashHeads[0]) == 0) {
         return error("ReplayBlocks(): reorganization to unknown block requested");
     }
-    pindexNew = m_blockman.m_block_index[hashHeads[0]];
+    pindexNew = m_blockman.m_block_index.find(hashHeads[0])->second;
 
     if (!hashHeads[1].IsNull()) { // The old tip is allowed to be 0, indicating it's the first flush.
         if (m_blockman.m_block_index.count(hashHeads[1]) == 0) {
             return error("ReplayBlocks(): reorganization from unknown block requested");
         }
-        pindexOld = m_blockman.m_block_index[hashHeads[1]];
+        pindexOld = m_blockman.m_block_index.find(hashHeads[1])->second;
         pindexFork = LastCommonAncestor(pindexOld, pindexNew);
         assert(pindexFork != nullptr);
     }
@@ -5605,6 +6040,7 @@ bool CChainState::RewindBlockIndex(const CChainParams& params)
 void CChainState::UnloadBlockIndex() {
     nBlockSequenceId = 1;
     setBlockIndexCandidates.clear();
+    m_next_block = CPrefetchedBlock();
 }
 
 // May NOT be used after any connections are up as much
@@ -5668,7 +6104,7 @@ bool CChainState::LoadGenesisBlock(const CChainParams& chainparams)
         if (blockPos.IsNull())
             return error("%s: writing genesis block to disk failed", __func__);
         CBlockIndex *pindex = m_blockman.AddToBlockIndex(block);
-        pindex->hashProof = chainparams.GetConsensus().hashGenesisBlock;
+        g_block_index_cold.SetHashProof(pindex->GetBlockHash(), chainparams.GetConsensus().hashGenesisBlock);
         ReceivedBlockTransactions(block, pindex, blockPos, chainparams.GetConsensus());
     } catch (const std::runtime_error& e) {
         return error("%s: failed to write genesis block: %s", __func__, e.what());
@@ -6018,6 +6454,7 @@ bool CChainState::RemoveBlockIndex(CBlockIndex *pindex)
     m_blockman.m_failed_blocks.erase(pindex);
 
     setDirtyBlockIndex.erase(pindex);
+    g_block_index_cold.Erase(pindex->GetBlockHash());
 
     for (int b = 0; b < VERSIONBITS_NUM_BITS; b++) {
         warningcache[b].erase(pindex);
@@ -11,6 +11,7 @@
 #include <primitives/block.h>
 #include <primitives/transaction.h>
 #include <scheduler.h>
+#include <stakerstats.h>
 
 #include <future>
 #include <unordered_map>
@@ -254,3 +255,10 @@ void CMainSignals::NewPoWValidBlock(const CBlockIndex *pindex, const std::shared
     LOG_EVENT("%s: block hash=%s", __func__, block->GetHash().ToString());
     m_internals->Iterate([&](CValidationInterface& callbacks) { callbacks.NewPoWValidBlock(pindex, block); });
 }
+
+void CMainSignals::StakerRoundCompleted(const StakerRound& round) {
+    auto event = [round, this] {
+        m_internals->Iterate([&](CValidationInterface& callbacks) { callbacks.StakerRoundCompleted(round); });
+    };
+    ENQUEUE_AND_LOG_EVENT(event, "%s: hashes=%u kernel=%d", __func__, round.hashes, round.kernel_found);
+}
@@ -21,6 +21,7 @@ class CConnman;
 class CValidationInterface;
 class uint256;
 class CScheduler;
+struct StakerRound;
 enum class MemPoolRemovalReason;
 
 /** Register subscriber */
@@ -173,6 +174,12 @@ protected:
      * Notifies listeners that a block which builds directly on our current tip
      * has been received and connected to the headers tree, though not validated yet */
     virtual void NewPoWValidBlock(const CBlockIndex *pindex, const std::shared_ptr<const CBlock>& block) {};
+    /**
+     * Notifies listeners that the staker finished a kernel search round.
+     *
+     * Called on a background thread.
+     */
+    virtual void StakerRoundCompleted(const StakerRound& round) {}
     friend class CMainSignals;
 };
 
@@ -205,6 +212,7 @@ public:
     void ChainStateFlushed(const CBlockLocator &);
     void BlockChecked(const CBlock&, const BlockValidationState&);
     void NewPoWValidBlock(const CBlockIndex *, const std::shared_ptr<const CBlock>&);
+    void StakerRoundCompleted(const StakerRound&);
 };
 
 CMainSignals& GetMainSignals();
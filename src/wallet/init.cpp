@@ -6,6 +6,7 @@
 #include <init.h>
 #include <interfaces/chain.h>
 #include <interfaces/wallet.h>
+#include <miner.h>
 #include <net.h>
 #include <node/context.h>
 #include <node/ui_interface.h>
@@ -76,7 +77,9 @@ void WalletInit::AddWalletOptions(ArgsManager& argsman) const
     argsman.AddArg("-stepbystepstaking=<n>", "Enable or disable staking with steps, a manual signal start a new staking operation when stake a block stop and wait another signal. 0 = disabled, 1 = enabled (default: disabled)", ArgsManager::ALLOW_ANY, OptionsCategory::WALLET);
     argsman.AddArg("-coldstaking=<n>", "Enable or disable coldstaking. 0 = disabled, 1 = enabled (default: enabled)", ArgsManager::ALLOW_ANY, OptionsCategory::WALLET);
     argsman.AddArg("-stakecache=<n>", "Enables or disables the staking cache; significantly improves staking performance, but can use a lot of memory. 0 = disabled, 1 = enabled (default: enabled)", ArgsManager::ALLOW_ANY, OptionsCategory::WALLET);
+    argsman.AddArg("-stakerthreads=<n>", strprintf("Set the number of threads searching for stake kernels (%u to %d, 0 = auto, <0 = leave that many cores free, default: %d)", -GetNumCores(), MAX_STAKER_THREADS, DEFAULT_STAKER_THREADS), ArgsManager::ALLOW_ANY, OptionsCategory::WALLET);
     argsman.AddArg("-emergencystaking=<n>", "Enable or disable emergecy staking. 0 = disabled, 1 = enabled (default: disabled)", ArgsManager::ALLOW_ANY, OptionsCategory::WALLET);
+    argsman.AddArg("-stakepipeline=<n>", strprintf("Search stake kernels on a block that already has its transactions, so that it is published as soon as a kernel is found. 0 = disabled, 1 = enabled (default: %u)", DEFAULT_STAKE_PIPELINE), ArgsManager::ALLOW_ANY, OptionsCategory::WALLET);
     argsman.AddArg("-aggressivestaking", "Check more often to publish immediately when valid block is found.", ArgsManager::ALLOW_ANY, OptionsCategory::WALLET);
 
     argsman.AddHiddenArgs({"-zapwallettxes"});
@@ -12,6 +12,7 @@
 #include <interfaces/chain.h>
 #include <node/context.h>
 #include <policy/policy.h>
+#include <pos.h>
 #include <rpc/server.h>
 #include <test/util/logging.h>
 #include <test/util/setup_common.h>
@@ -20,6 +21,7 @@
 #include <validation.h>
 #include <wallet/coincontrol.h>
 #include <wallet/test/wallet_test_fixture.h>
+#include <wallet/walletdb.h>
 
 #include <boost/test/unit_test.hpp>
 #include <univalue.h>
@@ -341,6 +343,196 @@ BOOST_FIXTURE_TEST_CASE(coin_mark_dirty_immature_credit, TestChain100Setup)
     BOOST_CHECK_EQUAL(wtx.GetImmatureCredit(), 50*COIN);
 }
 
+// The stakeable output index has to follow maturity, coin locks and spends
+// without a rescan of the whole wallet.
+BOOST_FIXTURE_TEST_CASE(stakeable_coins_follow_wallet_state, TestChain100Setup)
+{
+    NodeContext node;
+    auto chain = interfaces::MakeChain(node);
+
+    CWallet wallet(chain.get(), "", CreateDummyWalletDatabase());
+    AddKey(wallet, coinbaseKey);
+    LOCK(wallet.cs_wallet);
+
+    const CScript script = GetScriptForRawPubKey(coinbaseKey.GetPubKey());
+    auto add_tx = [&](const COutPoint& prevout, const CScript& script_pub_key, CAmount value, const CWalletTx::Confirmation& confirm) {
+        CMutableTransaction mtx;
+        mtx.vin.emplace_back(prevout);
+        mtx.vout.emplace_back(value, script_pub_key);
+        return wallet.AddToWallet(MakeTransactionRef(mtx), confirm)->GetHash();
+    };
+    auto stakeable = [&] {
+        std::vector<COutput> coins;
+        wallet.AvailableCoinsForStaking(coins);
+        return coins.size();
+    };
+
+    const uint256 first = add_tx(COutPoint(InsecureRand256(), 0), script, 10 * COIN, {CWalletTx::Status::CONFIRMED, 500, InsecureRand256(), 0});
+    add_tx(COutPoint(InsecureRand256(), 0), script, 20 * COIN, {CWalletTx::Status::CONFIRMED, 1500, InsecureRand256(), 0});
+
+    wallet.SetLastBlockProcessed(500 + COINBASE_MATURITY - 2, InsecureRand256());
+    BOOST_CHECK_EQUAL(stakeable(), 0U);
+    BOOST_CHECK_EQUAL(wallet.GetStakeWeight(), 0U);
+
+    wallet.SetLastBlockProcessed(500 + COINBASE_MATURITY - 1, InsecureRand256());
+    BOOST_CHECK_EQUAL(stakeable(), 1U);
+    BOOST_CHECK_EQUAL(wallet.GetStakeWeight(), uint64_t(10 * COIN));
+
+    wallet.LockCoin(COutPoint(first, 0));
+    BOOST_CHECK_EQUAL(wallet.GetStakeWeight(), 0U);
+    wallet.UnlockCoin(COutPoint(first, 0));
+    BOOST_CHECK_EQUAL(wallet.GetStakeWeight(), uint64_t(10 * COIN));
+
+    wallet.SetLastBlockProcessed(1500 + COINBASE_MATURITY - 1, InsecureRand256());
+    BOOST_CHECK_EQUAL(stakeable(), 2U);
+    BOOST_CHECK_EQUAL(wallet.GetStakeWeight(), uint64_t(30 * COIN));
+
+    // An unconfirmed spend takes the coin out until it is abandoned
+    const uint256 spend = add_tx(COutPoint(first, 0), CScript() << OP_TRUE, 10 * COIN, CWalletTx::Confirmation());
+    BOOST_CHECK_EQUAL(wallet.GetStakeWeight(), uint64_t(20 * COIN));
+    BOOST_CHECK(wallet.AbandonTransaction(spend));
+    BOOST_CHECK_EQUAL(stakeable(), 2U);
+    BOOST_CHECK_EQUAL(wallet.GetStakeWeight(), uint64_t(30 * COIN));
+
+    // A full rebuild agrees with the incremental updates
+    wallet.MarkDirty();
+    BOOST_CHECK_EQUAL(wallet.GetStakeWeight(), uint64_t(30 * COIN));
+}
+
+// Add a stake cache entry the way CacheStakeKernels() does, in memory and in the wallet database
+static void AddStakeCache(CWallet& wallet, const COutPoint& prevout, const CStakeCache& stake)
+{
+    LOCK(wallet.cs_wallet);
+    BOOST_CHECK(WalletBatch(wallet.GetDatabase()).WriteStakeCache(prevout, stake));
+    wallet.LoadStakeCache(prevout, stake);
+}
+
+static bool HasStakeCache(CWallet& wallet, const COutPoint& prevout)
+{
+    LOCK(wallet.cs_wallet);
+    return wallet.GetStakeCache().count(prevout) > 0;
+}
+
+BOOST_FIXTURE_TEST_CASE(stake_cache_drops_spent_coins, TestChain100Setup)
+{
+    NodeContext node;
+    auto chain = interfaces::MakeChain(node);
+    CWallet wallet(chain.get(), "", CreateMockWalletDatabase());
+    bool first_run;
+    BOOST_CHECK(wallet.LoadWallet(first_run) == DBErrors::LOAD_OK);
+
+    const uint256 block_from = WITH_LOCK(cs_main, return ::ChainActive()[1]->GetBlockHash());
+    const COutPoint spent(InsecureRand256(), 0), unspent(InsecureRand256(), 1);
+    AddStakeCache(wallet, spent, CStakeCache(1, 10 * COIN, block_from));
+    AddStakeCache(wallet, unspent, CStakeCache(1, 20 * COIN, block_from));
+
+    CMutableTransaction mtx;
+    mtx.vin.emplace_back(spent);
+    mtx.vout.emplace_back(10 * COIN, CScript() << OP_TRUE);
+    CBlock block;
+    block.vtx.push_back(MakeTransactionRef(mtx));
+    wallet.blockConnected(block, 101);
+
+    BOOST_CHECK(!HasStakeCache(wallet, spent));
+    BOOST_CHECK(HasStakeCache(wallet, unspent));
+}
+
+BOOST_FIXTURE_TEST_CASE(stake_cache_drops_disconnected_coins, TestChain100Setup)
+{
+    NodeContext node;
+    auto chain = interfaces::MakeChain(node);
+    CWallet wallet(chain.get(), "", CreateMockWalletDatabase());
+    bool first_run;
+    BOOST_CHECK(wallet.LoadWallet(first_run) == DBErrors::LOAD_OK);
+
+    CBlock block;
+    block.nTime = 1;
+    const COutPoint orphaned(InsecureRand256(), 0), kept(InsecureRand256(), 0);
+    AddStakeCache(wallet, orphaned, CStakeCache(block.nTime, 10 * COIN, block.GetHash()));
+    AddStakeCache(wallet, kept, CStakeCache(1, 20 * COIN, InsecureRand256()));
+
+    wallet.blockDisconnected(block, 101);
+
+    BOOST_CHECK(!HasStakeCache(wallet, orphaned));
+    BOOST_CHECK(HasStakeCache(wallet, kept));
+}
+
+BOOST_FIXTURE_TEST_CASE(stake_cache_survives_reload, TestChain100Setup)
+{
+    auto chain = interfaces::MakeChain(m_node);
+    auto wallet = TestLoadWallet(*chain);
+    const COutPoint first(InsecureRand256(), 0), second(InsecureRand256(), 3);
+    const CStakeCache stake(1234, 10 * COIN, InsecureRand256());
+    AddStakeCache(*wallet, first, stake);
+    AddStakeCache(*wallet, second, CStakeCache(5678, 20 * COIN, InsecureRand256()));
+    {
+        // An erased entry stays erased
+        CBlock block;
+        CMutableTransaction mtx;
+        mtx.vin.emplace_back(second);
+        block.vtx.push_back(MakeTransactionRef(mtx));
+        wallet->blockConnected(block, 101);
+    }
+    TestUnloadWallet(std::move(wallet));
+
+    wallet = TestLoadWallet(*chain);
+    {
+        LOCK(wallet->cs_wallet);
+        const StakeCacheMap& cache = wallet->GetStakeCache();
+        BOOST_CHECK_EQUAL(cache.size(), 1U);
+        BOOST_CHECK(cache.count(first));
+        BOOST_CHECK_EQUAL(cache.at(first).blockFromTime, stake.blockFromTime);
+        BOOST_CHECK_EQUAL(cache.at(first).amount, stake.amount);
+        BOOST_CHECK_EQUAL(cache.at(first).blockFrom, stake.blockFrom);
+    }
+    TestUnloadWallet(std::move(wallet));
+}
+
+// Entries loaded from the database are checked against the chain and the
+// wallet spends once, before the stake cache is first used.
+BOOST_FIXTURE_TEST_CASE(stake_cache_checks_loaded_entries, TestChain100Setup)
+{
+    auto chain = interfaces::MakeChain(m_node);
+    auto wallet = TestLoadWallet(*chain);
+    AddKey(*wallet, coinbaseKey);
+
+    const uint256 block_from = WITH_LOCK(cs_main, return ::ChainActive()[10]->GetBlockHash());
+    const CTransactionRef& coinbase = m_coinbase_txns[9];
+    const COutPoint valid(coinbase->GetHash(), 0);
+    const COutPoint reorged(coinbase->GetHash(), 1);
+    const COutPoint unknown(InsecureRand256(), 0);
+    {
+        LOCK(wallet->cs_wallet);
+        wallet->AddToWallet(coinbase, {CWalletTx::Status::CONFIRMED, 10, block_from, 0});
+    }
+    AddStakeCache(*wallet, valid, CStakeCache(1, coinbase->vout[0].nValue, block_from));
+    AddStakeCache(*wallet, reorged, CStakeCache(1, 10 * COIN, InsecureRand256()));
+    AddStakeCache(*wallet, unknown, CStakeCache(1, 10 * COIN, block_from));
+    TestUnloadWallet(std::move(wallet));
+
+    wallet = TestLoadWallet(*chain);
+    {
+        LOCK(wallet->cs_wallet);
+        BOOST_CHECK_EQUAL(wallet->GetStakeCache().size(), 3U);
+        BOOST_CHECK(wallet->mapWallet.count(coinbase->GetHash()));
+    }
+    wallet->CacheStakeKernels({}, WITH_LOCK(cs_main, return ::ChainActive().Tip()));
+    {
+        LOCK(wallet->cs_wallet);
+        BOOST_CHECK_EQUAL(wallet->GetStakeCache().size(), 1U);
+        BOOST_CHECK(wallet->GetStakeCache().count(valid));
+    }
+    TestUnloadWallet(std::move(wallet));
+
+    // The dropped entries were erased from the database as well
+    wallet = TestLoadWallet(*chain);
+    {
+        LOCK(wallet->cs_wallet);
+        BOOST_CHECK_EQUAL(wallet->GetStakeCache().size(), 1U);
+    }
+    TestUnloadWallet(std::move(wallet));
+}
+
 static int64_t AddTx(ChainstateManager& chainman, CWallet& wallet, uint32_t lockTime, int64_t mockTime, int64_t blockTime)
 {
     CMutableTransaction tx;
@@ -350,12 +542,11 @@ static int64_t AddTx(ChainstateManager& chainman, CWallet& wallet, uint32_t lock
     CBlockIndex* block = nullptr;
     if (blockTime > 0) {
         LOCK(cs_main);
-        auto inserted = chainman.BlockIndex().emplace(GetRandHash(), new CBlockIndex);
+        auto inserted = chainman.BlockIndex().emplace(GetRandHash());
         assert(inserted.second);
         const uint256& hash = inserted.first->first;
         block = inserted.first->second;
         block->nTime = blockTime;
-        block->phashBlock = &hash;
         confirm = {CWalletTx::Status::CONFIRMED, block->nHeight, hash, 0};
     }
 
@@ -566,6 +566,8 @@ bool CWallet::IsSpent(const uint256& hash, unsigned int n) const
 
 void CWallet::RemoveFromSpends(const COutPoint& outpoint, const uint256& wtxid)
 {
+    MarkStakeableDirty(outpoint.hash);
+
     std::pair<TxSpends::iterator, TxSpends::iterator> range;
     range = mapTxSpends.equal_range(outpoint);
     TxSpends::iterator it = range.first;
@@ -598,6 +600,7 @@ void CWallet::AddToSpends(const COutPoint& outpoint, const uint256& wtxid)
     mapTxSpends.insert(std::make_pair(outpoint, wtxid));
 
     setLockedCoins.erase(outpoint);
+    MarkStakeableDirty(outpoint.hash);
 
     std::pair<TxSpends::iterator, TxSpends::iterator> range;
     range = mapTxSpends.equal_range(outpoint);
@@ -792,11 +795,18 @@ void CWallet::MarkDirty()
 {
     {
         LOCK(cs_wallet);
+        m_stakeable_rebuild = true;
         for (std::pair<const uint256, CWalletTx>& item : mapWallet)
             item.second.MarkDirty();
     }
 }
 
+void CWallet::MarkStakeableDirty(const uint256& hash) const
+{
+    AssertLockHeld(cs_wallet);
+    if (!m_stakeable_rebuild) m_stakeable_dirty.insert(hash);
+}
+
 bool CWallet::MarkReplaced(const uint256& originalHash, const uint256& newHash)
 {
     LOCK(cs_wallet);
@@ -1291,6 +1301,15 @@ void CWallet::blockConnected(const CBlock& block, int height)
         SyncTransaction(block.vtx[index], {CWalletTx::Status::CONFIRMED, height, block_hash, (int)index});
         transactionRemovedFromMempool(block.vtx[index], MemPoolRemovalReason::BLOCK, 0 /* mempool_sequence */);
     }
+
+    // Spent coins can't stake anymore
+    std::vector<COutPoint> spent;
+    for (const CTransactionRef& ptx : block.vtx) {
+        for (const CTxIn& txin : ptx->vin) {
+            if (stakeCache.count(txin.prevout)) spent.push_back(txin.prevout);
+        }
+    }
+    EraseStakeCache(spent);
 }
 
 void CWallet::blockDisconnected(const CBlock& block, int height)
@@ -1309,6 +1328,49 @@ void CWallet::blockDisconnected(const CBlock& block, int height)
         int posInBlock = ptx->IsCoinStake() ? -1 : 0;
         SyncTransaction(ptx, {CWalletTx::Status::UNCONFIRMED, /* block height */ 0, /* block hash */ {}, /* index */ posInBlock});
     }
+
+    // The coins created by the block are gone, their block time with them
+    std::vector<COutPoint> orphaned;
+    const auto range = stakeCacheByBlock.equal_range(block.GetHash());
+    for (auto it = range.first; it != range.second; ++it) {
+        orphaned.push_back(it->second);
+    }
+    EraseStakeCache(orphaned);
+}
+
+void CWallet::EraseStakeCache(const std::vector<COutPoint>& prevouts)
+{
+    AssertLockHeld(cs_wallet);
+    if (prevouts.empty())
+        return;
+
+    WalletBatch batch(*database);
+    for (const COutPoint& prevout : prevouts) {
+        auto it = stakeCache.find(prevout);
+        if (it != stakeCache.end())
+            EraseStakeCacheEntry(it);
+        batch.EraseStakeCache(prevout);
+    }
+}
+
+StakeCacheMap::iterator CWallet::EraseStakeCacheEntry(StakeCacheMap::iterator it)
+{
+    AssertLockHeld(cs_wallet);
+    const auto range = stakeCacheByBlock.equal_range(it->second.blockFrom);
+    for (auto itBlock = range.first; itBlock != range.second; ++itBlock) {
+        if (itBlock->second == it->first) {
+            stakeCacheByBlock.erase(itBlock);
+            break;
+        }
+    }
+    return stakeCache.erase(it);
+}
+
+void CWallet::LoadStakeCache(const COutPoint& prevout, const CStakeCache& stake)
+{
+    AssertLockHeld(cs_wallet);
+    if (stakeCache.emplace(prevout, stake).second)
+        stakeCacheByBlock.emplace(stake.blockFrom, prevout);
 }
 
 void CWallet::updatedBlockTip()
@@ -1993,6 +2055,20 @@ std::set<uint256> CWalletTx::GetConflicts() const
     return result;
 }
 
+void CWalletTx::MarkDirty()
+{
+    m_amounts[DEBIT].Reset();
+    m_amounts[CREDIT].Reset();
+    m_amounts[IMMATURE_CREDIT].Reset();
+    m_amounts[AVAILABLE_CREDIT].Reset();
+    m_amounts[STAKEABLE_CREDIT].Reset();
+    fChangeCached = false;
+    m_is_cache_empty = true;
+    if (pwallet != nullptr && tx != nullptr) {
+        pwallet->MarkStakeableDirty(GetHash());
+    }
+}
+
 CAmount CWalletTx::GetCachableAmount(AmountType type, const isminefilter& filter, bool recalculate) const
 {
     auto& amount = m_amounts[type];
@@ -2497,55 +2573,96 @@ void CWallet::AvailableCoins(std::vector<COutput>& vCoins, bool fOnlySafe, const
     }
 }
 
-void CWallet::AvailableCoinsForStaking(std::vector<COutput>& vCoins) const
+void CWallet::UpdateStakeable(const uint256& hash, bool includeColdStaking) const
 {
     AssertLockHeld(cs_wallet);
 
-    const bool includeColdStaking = gArgs.GetBoolArg("-coldstaking", DEFAULT_COLDSTAKING);
-    vCoins.clear();
-
-    for (std::map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it)
-    {
-        const uint256& wtxid = it->first;
-        const CWalletTx* pcoin = &(*it).second;
-        int nDepth = pcoin->GetDepthInMainChain();
+    for (auto it = m_stakeable.lower_bound(COutPoint(hash, 0)); it != m_stakeable.end() && it->first.hash == hash;) {
+        auto bucket = m_stakeable_by_height.find(it->second);
+        bucket->second.erase(it->first);
+        if (bucket->second.empty()) m_stakeable_by_height.erase(bucket);
+        it = m_stakeable.erase(it);
+    }
 
-        if (nDepth < 1)
-            continue;
+    auto it = mapWallet.find(hash);
+    if (it == mapWallet.end()) return;
+    const CWalletTx* pcoin = &it->second;
+    if (!pcoin->isConfirmed())
+        return;
 
-        if (nDepth < COINBASE_MATURITY)
-            continue;
+    // First height at which the depth reaches COINBASE_MATURITY and
+    // GetBlocksToMaturity() is zero, see AvailableCoinsForStaking()
+    const int nMatureHeight = pcoin->m_confirm.block_height + COINBASE_MATURITY - 1 + ((pcoin->IsCoinBase() || pcoin->IsCoinStake()) ? 1 : 0);
 
-        if (pcoin->GetBlocksToMaturity() > 0)
+    for (unsigned int i = 0; i < pcoin->tx->vout.size(); i++)
+    {
+        if (IsSpent(hash, i))
             continue;
-
-        for (unsigned int i = 0; i < pcoin->tx->vout.size(); i++)
+        isminetype mine = IsMine(pcoin->tx->vout[i]);
+        if ((mine != ISMINE_NO) && (mine != ISMINE_SPENDABLE_DELEGATED) && !IsLockedCoin(hash, i) && (pcoin->tx->vout[i].nValue > 0))
         {
-            if (!IsSpent(wtxid, i))
+            if (mine == ISMINE_COLD && !includeColdStaking)
+                continue;
+            std::vector<valtype> solutions;
+            auto whichtype = Solver(pcoin->tx->vout[i].scriptPubKey, solutions);
+            if ((TxoutType::PUBKEY ==  whichtype) || (TxoutType::PUBKEYHASH == whichtype) ||
+                    (includeColdStaking && TxoutType::COLDSTAKE == whichtype))
             {
-                isminetype mine = IsMine(pcoin->tx->vout[i]);
-                if ((mine != ISMINE_NO) && (mine != ISMINE_SPENDABLE_DELEGATED) && !IsLockedCoin((*it).first, i) && (pcoin->tx->vout[i].nValue > 0))
-                {
-                    if (mine == ISMINE_COLD && !includeColdStaking)
-                        continue;
-                    std::vector<valtype> solutions;
-                    auto whichtype = Solver(pcoin->tx->vout[i].scriptPubKey, solutions);
-                    if ((TxoutType::PUBKEY ==  whichtype) || (TxoutType::PUBKEYHASH == whichtype) ||
-                            (includeColdStaking && TxoutType::COLDSTAKE == whichtype))
-                    {
-                        std::unique_ptr<SigningProvider> provider = GetSolvingProvider(pcoin->tx->vout[i].scriptPubKey);
-                        bool solvable = IsSolvable(*provider, pcoin->tx->vout[i].scriptPubKey, mine == ISMINE_COLD);
-                        bool spendable = ((mine & ISMINE_SPENDABLE) != ISMINE_NO) ||
-                            (((mine & ISMINE_WATCH_ONLY) != ISMINE_NO) && solvable) ||
-                            ((mine & (includeColdStaking ? ISMINE_COLD : ISMINE_NO)) != ISMINE_NO);
-                        vCoins.push_back(COutput(pcoin, i, nDepth, spendable, solvable, pcoin->IsTrusted()));
-                    }
-                }
+                m_stakeable.emplace(COutPoint(hash, i), nMatureHeight);
+                m_stakeable_by_height[nMatureHeight].insert(COutPoint(hash, i));
             }
         }
     }
 }
 
+void CWallet::SyncStakeable() const
+{
+    AssertLockHeld(cs_wallet);
+
+    const bool includeColdStaking = gArgs.GetBoolArg("-coldstaking", DEFAULT_COLDSTAKING);
+    if (m_stakeable_rebuild) {
+        m_stakeable.clear();
+        m_stakeable_by_height.clear();
+        m_stakeable_dirty.clear();
+        m_stakeable_rebuild = false;
+        for (const auto& entry : mapWallet) {
+            UpdateStakeable(entry.first, includeColdStaking);
+        }
+        return;
+    }
+
+    for (const uint256& hash : m_stakeable_dirty) {
+        UpdateStakeable(hash, includeColdStaking);
+    }
+    m_stakeable_dirty.clear();
+}
+
+void CWallet::AvailableCoinsForStaking(std::vector<COutput>& vCoins) const
+{
+    AssertLockHeld(cs_wallet);
+
+    const bool includeColdStaking = gArgs.GetBoolArg("-coldstaking", DEFAULT_COLDSTAKING);
+    vCoins.clear();
+
+    SyncStakeable();
+    const auto end = m_stakeable_by_height.upper_bound(GetLastBlockHeight());
+    for (auto bucket = m_stakeable_by_height.begin(); bucket != end; ++bucket)
+    {
+        for (const COutPoint& output : bucket->second)
+        {
+            const CWalletTx* pcoin = &mapWallet.at(output.hash);
+            const CTxOut& txout = pcoin->tx->vout[output.n];
+            isminetype mine = IsMine(txout);
+            std::unique_ptr<SigningProvider> provider = GetSolvingProvider(txout.scriptPubKey);
+            bool solvable = IsSolvable(*provider, txout.scriptPubKey, mine == ISMINE_COLD);
+            bool spendable = ((mine & ISMINE_SPENDABLE) != ISMINE_NO) ||
+                (((mine & ISMINE_WATCH_ONLY) != ISMINE_NO) && solvable) ||
+                ((mine & (includeColdStaking ? ISMINE_COLD : ISMINE_NO)) != ISMINE_NO);
+            vCoins.push_back(COutput(pcoin, output.n, pcoin->GetDepthInMainChain(), spendable, solvable, pcoin->IsTrusted()));
+        }
+    }
+}
+
 void CWallet::AvailableP2CSCoins(std::vector<COutput>& vCoins) const 
 {
     AssertLockHeld(cs_wallet);
@@ -2596,6 +2713,87 @@ void CWallet::SelectCoinsForStaking(std::set<std::pair<const CWalletTx*,unsigned
     }
 }
 
+void CWallet::CacheStakeKernels(const std::set<std::pair<const CWalletTx*,unsigned int> >& setCoins, CBlockIndex* pindexPrev)
+{
+    std::vector<COutPoint> vDropped;
+    std::vector<COutPoint> vAdded;
+    {
+        LOCK2(cs_main, cs_wallet);
+        if (!m_stake_cache_checked) {
+            // The coins of the loaded entries may have been spent or reorged out while the wallet was not running
+            for (auto it = stakeCache.begin(); it != stakeCache.end();) {
+                const CBlockIndex* blockFrom = LookupBlockIndex(it->second.blockFrom);
+                if (!blockFrom || !::ChainActive().Contains(blockFrom) || !mapWallet.count(it->first.hash) || IsSpent(it->first.hash, it->first.n)) {
+                    vDropped.push_back(it->first);
+                    it = EraseStakeCacheEntry(it);
+                } else {
+                    ++it;
+                }
+            }
+            m_stake_cache_checked = true;
+        }
+
+        for(const std::pair<const CWalletTx*,unsigned int> &pcoin : setCoins)
+        {
+            COutPoint prevoutStake = COutPoint(pcoin.first->GetHash(), pcoin.second);
+            if (CacheKernel(stakeCache, prevoutStake, pindexPrev, ::ChainstateActive().CoinsTip())) { //a miss does 2 disk loads
+                stakeCacheByBlock.emplace(stakeCache.at(prevoutStake).blockFrom, prevoutStake);
+                vAdded.push_back(prevoutStake);
+            }
+        }
+    }
+    if (vDropped.empty() && vAdded.empty())
+        return;
+
+    // Write the changes in one transaction without holding cs_main
+    LOCK(cs_wallet);
+    WalletBatch batch(*database);
+    batch.TxnBegin();
+    for (const COutPoint& prevout : vDropped)
+        batch.EraseStakeCache(prevout);
+    for (const COutPoint& prevout : vAdded) {
+        // blockConnected() or blockDisconnected() may have dropped it meanwhile
+        auto it = stakeCache.find(prevout);
+        if (it != stakeCache.end())
+            batch.WriteStakeCache(prevout, it->second);
+    }
+    batch.TxnCommit();
+}
+
+size_t CWallet::GetStakeCandidates(const std::set<std::pair<const CWalletTx*,unsigned int> >& setCoins, CBlockIndex* pindexPrev, std::vector<StakeCandidate>& candidates)
+{
+    // Without -stakecache the kernel data is only kept for this round
+    const bool fStakeCache = gArgs.GetBoolArg("-stakecache", DEFAULT_STAKE_CACHE);
+    StakeCacheMap roundCache;
+    size_t nCacheHits = 0;
+    if (fStakeCache) {
+        {
+            LOCK(cs_wallet);
+            for(const std::pair<const CWalletTx*,unsigned int> &pcoin : setCoins)
+                nCacheHits += stakeCache.count(COutPoint(pcoin.first->GetHash(), pcoin.second));
+        }
+        CacheStakeKernels(setCoins, pindexPrev);
+    }
+
+    LOCK2(cs_main, cs_wallet);
+    const StakeCacheMap& cache = fStakeCache ? stakeCache : roundCache;
+
+    candidates.clear();
+    candidates.reserve(setCoins.size());
+    for(const std::pair<const CWalletTx*,unsigned int> &pcoin : setCoins)
+    {
+        COutPoint prevoutStake = COutPoint(pcoin.first->GetHash(), pcoin.second);
+        if (!fStakeCache)
+            CacheKernel(roundCache, prevoutStake, pindexPrev, ::ChainstateActive().CoinsTip());
+        auto it = cache.find(prevoutStake);
+        // Immature or already spent, CheckKernel would reject it
+        if (it == cache.end())
+            continue;
+        candidates.push_back({prevoutStake, it->second.blockFromTime, it->second.amount});
+    }
+    return nCacheHits;
+}
+
 std::map<CTxDestination, std::vector<COutput>> CWallet::ListCoins() const
 {
     AssertLockHeld(cs_wallet);
@@ -3634,19 +3832,16 @@ bool CWallet::CreateTransaction(
 
 uint64_t CWallet::GetStakeWeight() const
 {
-    // Choose coins to use
-    std::set<std::pair<const CWalletTx*,unsigned int> > setCoins;
-    SelectCoinsForStaking(setCoins);
-
-    if (setCoins.empty())
-        return 0;
+    AssertLockHeld(cs_wallet);
 
+    // Sum the mature prefix of the stakeable index
+    SyncStakeable();
     uint64_t nWeight = 0;
-
-    for(std::pair<const CWalletTx*,unsigned int> pcoin : setCoins)
+    const auto end = m_stakeable_by_height.upper_bound(GetLastBlockHeight());
+    for (auto bucket = m_stakeable_by_height.begin(); bucket != end; ++bucket)
     {
-        if (pcoin.first->GetDepthInMainChain() >= COINBASE_MATURITY)
-            nWeight += pcoin.first->tx->vout[pcoin.second].nValue;
+        for (const COutPoint& output : bucket->second)
+            nWeight += mapWallet.at(output.hash).tx->vout[output.n].nValue;
     }
 
     return nWeight;
@@ -3669,8 +3864,9 @@ static CAmount GetPlyRewardAmount(CAmount amount, const Consensus::Params& conse
     return CAmount (amount * GetPlyRewardPercentage(amount, consensus) / 100);
 }
 
-bool CWallet::CreateCoinStake(const CWallet& wallet, unsigned int nBits, const CAmount& nTotalFees, uint32_t nTimeBlock, CMutableTransaction& tx, CKey& key, std::set<std::pair<const CWalletTx*,unsigned int> >& setCoins)
+bool CWallet::CreateCoinStake(const CWallet& wallet, unsigned int nBits, const CAmount& nTotalFees, uint32_t nTimeBlock, CMutableTransaction& tx, CKey& key, std::set<std::pair<const CWalletTx*,unsigned int> >& setCoins, const COutPoint* pkernel)
 {
+    AssertLockHeld(cs_wallet);
     CBlockIndex* pindexPrev = ::ChainActive().Tip();
     arith_uint256 bnTargetPerCoinDay;
     bnTargetPerCoinDay.SetCompact(nBits);
@@ -3696,20 +3892,7 @@ bool CWallet::CreateCoinStake(const CWallet& wallet, unsigned int nBits, const C
     if (setCoins.empty())
         return false;
 
-    if(stakeCache.size() > setCoins.size() + 100){
-        //Determining if the cache is still valid is harder than just clearing it when it gets too big, so instead just clear it
-        //when it has more than 100 entries more than the actual setCoins.
-        stakeCache.clear();
-    }
-    if(gArgs.GetBoolArg("-stakecache", DEFAULT_STAKE_CACHE)) {
-
-        for(const std::pair<const CWalletTx*,unsigned int> &pcoin : setCoins)
-        {
-            boost::this_thread::interruption_point();
-            COutPoint prevoutStake = COutPoint(pcoin.first->GetHash(), pcoin.second);
-            CacheKernel(stakeCache, prevoutStake, pindexPrev, ::ChainstateActive().CoinsTip()); //this will do a 2 disk loads per op
-        }
-    }
+    // GetStakeCandidates() already filled the stake cache for setCoins
 
     CAmount nCredit = 0;
     bool isColdStake = false;
@@ -3731,6 +3914,9 @@ bool CWallet::CreateCoinStake(const CWallet& wallet, unsigned int nBits, const C
         // Search backward in time from the given txNew timestamp
         // Search nSearchInterval seconds back up to nMaxStakeSearchInterval
         COutPoint prevoutStake = COutPoint(pcoin.first->GetHash(), pcoin.second);
+        // The kernel search already picked the coin
+        if (pkernel && prevoutStake != *pkernel)
+            continue;
         if (CheckKernel(pindexPrev, nBits, nTimeBlock, prevoutStake, ::ChainstateActive().CoinsTip(), stakeCache))
         {
             // Found a kernel
@@ -4061,8 +4247,11 @@ DBErrors CWallet::ZapSelectTx(std::vector<uint256>& vHashIn, std::vector<uint256
     for (const uint256& hash : vHashOut) {
         const auto& it = mapWallet.find(hash);
         wtxOrdered.erase(it->second.m_it_wtxOrdered);
-        for (const auto& txin : it->second.tx->vin)
+        for (const auto& txin : it->second.tx->vin) {
             mapTxSpends.erase(txin.prevout);
+            MarkStakeableDirty(txin.prevout.hash);
+        }
+        MarkStakeableDirty(hash);
         mapWallet.erase(it);
         NotifyTransactionChanged(this, hash, CT_DELETED);
     }
@@ -4514,17 +4703,22 @@ void CWallet::LockCoin(const COutPoint& output)
 {
     AssertLockHeld(cs_wallet);
     setLockedCoins.insert(output);
+    MarkStakeableDirty(output.hash);
 }
 
 void CWallet::UnlockCoin(const COutPoint& output)
 {
     AssertLockHeld(cs_wallet);
     setLockedCoins.erase(output);
+    MarkStakeableDirty(output.hash);
 }
 
 void CWallet::UnlockAllCoins()
 {
     AssertLockHeld(cs_wallet);
+    for (const COutPoint& output : setLockedCoins) {
+        MarkStakeableDirty(output.hash);
+    }
     setLockedCoins.clear();
 }
 
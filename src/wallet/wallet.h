@@ -26,6 +26,7 @@
 #include <wallet/walletdb.h>
 #include <wallet/walletutil.h>
 #include <pos.h>
+#include <kernelsearch.h>
 
 #include <algorithm>
 #include <atomic>
@@ -436,17 +437,8 @@ public:
         tx = std::move(arg);
     }
 
-    //! make sure balances are recalculated
-    void MarkDirty()
-    {
-        m_amounts[DEBIT].Reset();
-        m_amounts[CREDIT].Reset();
-        m_amounts[IMMATURE_CREDIT].Reset();
-        m_amounts[AVAILABLE_CREDIT].Reset();
-        m_amounts[STAKEABLE_CREDIT].Reset();
-        fChangeCached = false;
-        m_is_cache_empty = true;
-    }
+    //! make sure balances and the wallet's stakeable outputs are recalculated
+    void MarkDirty() NO_THREAD_SAFETY_ANALYSIS;
 
     //! filter decides which addresses will count towards the debit
     CAmount GetDebit(const isminefilter& filter) const;
@@ -635,7 +627,18 @@ private:
     // Local time that the tip block was received. Used to schedule wallet rebroadcasts.
     std::atomic<int64_t> m_best_block_time {0};
 
-    std::map<COutPoint, CStakeCache> stakeCache;
+    /**
+     * Kernel data of the staking coins, see CacheKernel(). An entry is dropped
+     * when its coin is spent or the block that created it is disconnected, and
+     * the cache is kept in the wallet database across restarts.
+     */
+    StakeCacheMap stakeCache GUARDED_BY(cs_wallet);
+    //! the stake cache entries by the block that created their coin, for blockDisconnected()
+    std::multimap<uint256, COutPoint> stakeCacheByBlock GUARDED_BY(cs_wallet);
+    //! whether the entries loaded from the database were checked against the chain
+    bool m_stake_cache_checked GUARDED_BY(cs_wallet){false};
+    void EraseStakeCache(const std::vector<COutPoint>& prevouts) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    StakeCacheMap::iterator EraseStakeCacheEntry(StakeCacheMap::iterator it) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
 
     /**
      * Used to keep track of spent outpoints, and
@@ -649,6 +652,20 @@ private:
     void RemoveFromSpends(const COutPoint& outpoint, const uint256& wtxid); EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
     void RemoveFromSpends(const uint256& wtxid) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
 
+    /**
+     * Index of the outputs that can stake, keyed by the chain height at which
+     * each becomes mature, so staking only walks the mature prefix instead of
+     * all of mapWallet. Transactions are queued for a recheck whenever their
+     * balance caches are marked dirty; the queue is applied lazily by
+     * SyncStakeable().
+     */
+    mutable std::map<COutPoint, int> m_stakeable GUARDED_BY(cs_wallet);
+    mutable std::map<int, std::set<COutPoint>> m_stakeable_by_height GUARDED_BY(cs_wallet);
+    mutable std::set<uint256> m_stakeable_dirty GUARDED_BY(cs_wallet);
+    mutable bool m_stakeable_rebuild GUARDED_BY(cs_wallet){true};
+    void UpdateStakeable(const uint256& hash, bool includeColdStaking) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    void SyncStakeable() const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+
     /**
      * Add a transaction to the wallet, or update it.  pIndex and posInBlock should
      * be set when the transaction was known to be included in a block.  When
@@ -811,13 +828,23 @@ public:
     bool CanSupportFeature(enum WalletFeature wf) const override EXCLUSIVE_LOCKS_REQUIRED(cs_wallet) { AssertLockHeld(cs_wallet); return IsFeatureSupported(nWalletVersion, wf); }
 
     //! select coins for staking from the available coins for staking.
-    void SelectCoinsForStaking(std::set<std::pair<const CWalletTx*,unsigned int> >& setCoinsRet) const;
+    void SelectCoinsForStaking(std::set<std::pair<const CWalletTx*,unsigned int> >& setCoinsRet) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+
+    //! add the kernel data of the selected staking coins that is missing from the stake cache.
+    //! the new entries are written to the wallet database in one transaction, after cs_main is released.
+    void CacheStakeKernels(const std::set<std::pair<const CWalletTx*,unsigned int> >& setCoins, CBlockIndex* pindexPrev) LOCKS_EXCLUDED(cs_main, cs_wallet);
+    void LoadStakeCache(const COutPoint& prevout, const CStakeCache& stake) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    const StakeCacheMap& GetStakeCache() const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet) { AssertLockHeld(cs_wallet); return stakeCache; }
+
+    //! look up the kernel data of the selected staking coins, in setCoins order, for the kernel search.
+    //! returns how many of them were already in the stake cache.
+    size_t GetStakeCandidates(const std::set<std::pair<const CWalletTx*,unsigned int> >& setCoins, CBlockIndex* pindexPrev, std::vector<StakeCandidate>& candidates) LOCKS_EXCLUDED(cs_main, cs_wallet);
 	
     /**
      * populate vCoins with vector of available COutputs.
      */
     void AvailableCoins(std::vector<COutput>& vCoins, bool fOnlySafe = true, const CCoinControl* coinControl = nullptr, bool fIncludeDelegated = true, bool fIncludeColdStaking = false, const CAmount& nMinimumAmount = 1, const CAmount& nMaximumAmount = MAX_MONEY, const CAmount& nMinimumSumAmount = MAX_MONEY, const uint64_t nMaximumCount = 0) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
-    void AvailableCoinsForStaking(std::vector<COutput>& vCoins) const;
+    void AvailableCoinsForStaking(std::vector<COutput>& vCoins) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
     void AvailableP2CSCoins(std::vector<COutput>& vCoins) const;
 
     /**
@@ -901,6 +928,8 @@ public:
     DBErrors ReorderTransactions();
 
     void MarkDirty();
+    //! queue a transaction for a recheck of its stakeable outputs
+    void MarkStakeableDirty(const uint256& hash) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
 
     //! Callback for updating transaction metadata in mapWallet.
     //!
@@ -1007,8 +1036,8 @@ public:
      */
     void CommitTransaction(CTransactionRef tx, mapValue_t mapValue, std::vector<std::pair<std::string, std::string>> orderForm);
 
-    uint64_t GetStakeWeight() const;
-    bool CreateCoinStake(const CWallet &wallet, unsigned int nBits, const CAmount& nTotalFees, uint32_t nTimeBlock, CMutableTransaction& tx, CKey& key, std::set<std::pair<const CWalletTx*,unsigned int> >& setCoins);
+    uint64_t GetStakeWeight() const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    bool CreateCoinStake(const CWallet &wallet, unsigned int nBits, const CAmount& nTotalFees, uint32_t nTimeBlock, CMutableTransaction& tx, CKey& key, std::set<std::pair<const CWalletTx*,unsigned int> >& setCoins, const COutPoint* pkernel = nullptr);
 
     bool DummySignTx(CMutableTransaction &txNew, const std::set<CTxOut> &txouts, bool use_max_sig = false) const
     {
@@ -45,6 +45,7 @@ const std::string ORDERPOSNEXT{"orderposnext"};
 const std::string POOL{"pool"};
 const std::string PURPOSE{"purpose"};
 const std::string SETTINGS{"settings"};
+const std::string STAKECACHE{"stakecache"};
 const std::string TX{"tx"};
 const std::string VERSION{"version"};
 const std::string WALLETDESCRIPTOR{"walletdescriptor"};
@@ -91,6 +92,16 @@ bool WalletBatch::EraseTx(uint256 hash)
     return EraseIC(std::make_pair(DBKeys::TX, hash));
 }
 
+bool WalletBatch::WriteStakeCache(const COutPoint& prevout, const CStakeCache& stake)
+{
+    return WriteIC(std::make_pair(DBKeys::STAKECACHE, prevout), stake);
+}
+
+bool WalletBatch::EraseStakeCache(const COutPoint& prevout)
+{
+    return EraseIC(std::make_pair(DBKeys::STAKECACHE, prevout));
+}
+
 bool WalletBatch::WriteKeyMetadata(const CKeyMetadata& meta, const CPubKey& pubkey, const bool overwrite)
 {
     return WriteIC(std::make_pair(DBKeys::KEYMETA, pubkey), meta, overwrite);
@@ -539,6 +550,12 @@ ReadKeyValue(CWallet* pwallet, CDataStream& ssKey, CDataStream& ssValue,
             }
         } else if (strType == DBKeys::ORDERPOSNEXT) {
             ssValue >> pwallet->nOrderPosNext;
+        } else if (strType == DBKeys::STAKECACHE) {
+            COutPoint prevout;
+            CStakeCache stake;
+            ssKey >> prevout;
+            ssValue >> stake;
+            pwallet->LoadStakeCache(prevout, stake);
         } else if (strType == DBKeys::DESTDATA) {
             std::string strAddress, strKey, strValue;
             ssKey >> strAddress;
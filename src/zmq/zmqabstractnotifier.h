@@ -13,6 +13,7 @@
 class CBlockIndex;
 class CTransaction;
 class CZMQAbstractNotifier;
+struct StakerRound;
 
 using CZMQNotifierFactory = std::unique_ptr<CZMQAbstractNotifier> (*)();
 
@@ -56,6 +57,8 @@ public:
     virtual bool NotifyTransactionRemoval(const CTransaction &transaction, uint64_t mempool_sequence);
     // Notifies of transactions added to mempool or appearing in blocks
     virtual bool NotifyTransaction(const CTransaction &transaction);
+    // Notifies of every staker round
+    virtual bool NotifyStakerRound(const StakerRound &round);
 
 protected:
     void *psocket;
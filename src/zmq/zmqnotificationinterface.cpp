@@ -37,6 +37,7 @@ CZMQNotificationInterface* CZMQNotificationInterface::Create()
     factories["pubrawblock"] = CZMQAbstractNotifier::Create<CZMQPublishRawBlockNotifier>;
     factories["pubrawtx"] = CZMQAbstractNotifier::Create<CZMQPublishRawTransactionNotifier>;
     factories["pubsequence"] = CZMQAbstractNotifier::Create<CZMQPublishSequenceNotifier>;
+    factories["pubstakerstats"] = CZMQAbstractNotifier::Create<CZMQPublishStakerStatsNotifier>;
 
     std::list<std::unique_ptr<CZMQAbstractNotifier>> notifiers;
     for (const auto& entry : factories)
@@ -188,4 +189,11 @@ void CZMQNotificationInterface::BlockDisconnected(const std::shared_ptr<const CB
     });
 }
 
+void CZMQNotificationInterface::StakerRoundCompleted(const StakerRound& round)
+{
+    TryForEachAndRemoveFailed(notifiers, [&round](CZMQAbstractNotifier* notifier) {
+        return notifier->NotifyStakerRound(round);
+    });
+}
+
 CZMQNotificationInterface* g_zmq_notification_interface = nullptr;
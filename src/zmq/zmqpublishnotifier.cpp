@@ -7,7 +7,9 @@
 #include <chain.h>
 #include <chainparams.h>
 #include <rpc/server.h>
+#include <stakerstats.h>
 #include <streams.h>
+#include <univalue.h>
 #include <util/system.h>
 #include <validation.h>
 #include <zmq/zmqutil.h>
@@ -27,6 +29,7 @@ static const char *MSG_HASHTX    = "hashtx";
 static const char *MSG_RAWBLOCK  = "rawblock";
 static const char *MSG_RAWTX     = "rawtx";
 static const char *MSG_SEQUENCE  = "sequence";
+static const char *MSG_STAKERSTATS = "stakerstats";
 
 // Internal function to send multipart message
 static int zmq_send_multipart(void *sock, const void* data, size_t size, ...)
@@ -227,6 +230,12 @@ bool CZMQPublishRawTransactionNotifier::NotifyTransaction(const CTransaction &tr
     return SendZmqMessage(MSG_RAWTX, &(*ss.begin()), ss.size());
 }
 
+bool CZMQPublishStakerStatsNotifier::NotifyStakerRound(const StakerRound &round)
+{
+    LogPrint(BCLog::ZMQ, "zmq: Publish stakerstats to %s\n", this->address);
+    const std::string json = StakerRoundToJSON(round).write();
+    return SendZmqMessage(MSG_STAKERSTATS, json.data(), json.size());
+}
 
 // TODO: Dedup this code to take label char, log string
 bool CZMQPublishSequenceNotifier::NotifyBlockConnect(const CBlockIndex *pindex)
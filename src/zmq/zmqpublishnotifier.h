@@ -52,6 +52,12 @@ public:
     bool NotifyTransaction(const CTransaction &transaction) override;
 };
 
+class CZMQPublishStakerStatsNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyStakerRound(const StakerRound &round) override;
+};
+
 class CZMQPublishSequenceNotifier : public CZMQAbstractPublishNotifier
 {
 public:
@@ -0,0 +1,35 @@
+#!/usr/bin/env bash
+#
+# Copyright (c) 2024 The NeuralLead developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+#
+# Check that the standard SHA-256 (CSHA256, CHMAC_SHA256), meant for local
+# hashing only, is not used by consensus or P2P code, which must hash with
+# NeuralLeadQHash.
+
+export LC_ALL=C
+
+# cd to root folder of git repo for git ls-files to work properly
+cd "$(dirname $0)/../.." || exit 1
+
+EXIT_CODE=0
+
+# Everything in the consensus library, plus the block, proof and relay code around it
+CONSENSUS_FILES=$(sed -n '/^libbitcoin_consensus_a_SOURCES = /,/^$/p' src/Makefile.am | grep -oE '[a-z0-9_/]+\.(cpp|h)' | sed 's|^|src/|')
+CONSENSUS_FILES+=" src/blockencodings.cpp src/blockencodings.h src/chain.cpp src/chain.h src/consensus/ src/merkleblock.cpp src/merkleblock.h"
+CONSENSUS_FILES+=" src/miner.cpp src/pos.cpp src/pos.h src/pow.cpp src/pow.h src/protocol.cpp src/signet.cpp src/validation.cpp src/validation.h"
+
+# Known local uses inside those files: the salted script execution cache key
+KNOWN_LOCAL_USES="^src/validation.cpp:[0-9]+:.*(g_scriptExecutionCacheHasher|crypto/sha256\.h)"
+
+# shellcheck disable=SC2086
+OUTPUT=$(git grep -nE '\<(CSHA256|CHMAC_SHA256)\>|crypto/(hmac_)?sha256\.h' -- ${CONSENSUS_FILES} | grep -vE "${KNOWN_LOCAL_USES}")
+if [[ ${OUTPUT} != "" ]]; then
+    echo "The standard SHA-256 is for local hashing only, consensus and P2P code must use NeuralLeadQHash_iface:"
+    echo
+    echo "${OUTPUT}"
+    EXIT_CODE=1
+fi
+
+exit ${EXIT_CODE}